@@ -0,0 +1,97 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+//
+//   ac_bench [MB [DICT [PINYIN_DICT]]]
+//
+// Builds AhoCorasick from the idiom dictionary, from the words of the
+// pinyin dictionary and from 5000 idioms, and scans MB megabytes (256 by
+// default) of text made of pinyin dictionary words, as one buffer and as
+// a stream of 64 KB chunks.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "aho_corasick.h"
+#include "bench.h"
+
+#define CHUNK_SIZE  (64 << 10)
+
+// the first word of every line
+static bool load_words(const char* path, std::vector<std::string> & words)
+{
+    std::ifstream file(path);
+    if (!file)
+        return false;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::string word = line.substr(0, line.find_first_of(" \t\r"));
+        if (!word.empty())
+            words.push_back(word);
+    }
+    return true;
+}
+
+static void run(const char* name, const std::vector<std::string> & words,
+                size_t limit, const std::string & text)
+{
+    AhoCorasick ac;
+    for (size_t i = 0; i < words.size() && i < limit; i++)
+        ac.add(words[i]);
+    double start = now_sec();
+    ac.build();
+    printf("%s: %zu patterns, %zu states (%zu dense), %.1f MB, built in "
+           "%.0fms\n", name, ac.patterns(), ac.states(), ac.dense_states(),
+           ac.bytes() / 1e6, (now_sec() - start) * 1e3);
+
+    start = now_sec();
+    size_t whole = ac.count(text.data(), text.size());
+    double sec = now_sec() - start;
+    printf(" buffer %12zu matches %6.2f GB/s\n", whole,
+           text.size() / 1e9 / sec);
+
+    AhoCorasickStream stream(ac);
+    size_t streamed = 0;
+    start = now_sec();
+    for (size_t pos = 0; pos < text.size(); pos += CHUNK_SIZE) {
+        size_t size = std::min((size_t)CHUNK_SIZE, text.size() - pos);
+        stream.feed(text.data() + pos, size,
+                    [&streamed](int, uint64_t) { streamed++; });
+    }
+    sec = now_sec() - start;
+    printf(" stream %12zu matches %6.2f GB/s%s\n", streamed,
+           text.size() / 1e9 / sec,
+           streamed == whole ? "" : "  ERROR: chunks lost matches");
+}
+
+int main(int argc, char* argv[])
+{
+    size_t mb = argc > 1 ? atol(argv[1]) : 256;
+    const char* dictPath = argc > 2 ? argv[2] : "../idiom/dict.txt";
+    const char* pinyinPath = argc > 3 ? argv[3] :
+                             "../pinyin/rawdict_utf8_65105_freq.txt";
+    std::vector<std::string> idioms, words;
+    if (!load_words(dictPath, idioms) || !load_words(pinyinPath, words)) {
+        printf("ERROR: can not read %s or %s\n", dictPath, pinyinPath);
+        return 1;
+    }
+
+    // pinyin words with a comma or a full stop now and then
+    std::string text;
+    text.reserve((mb << 20) + 64);
+    while (text.size() < mb << 20) {
+        text += words[bench_rand() % words.size()];
+        unsigned int r = bench_rand() % 16;
+        if (r == 0)
+            text += "\xef\xbc\x8c";
+        else if (r == 1)
+            text += "\xe3\x80\x82\n";
+    }
+    printf("%zu MB of text\n", mb);
+
+    run("idioms", idioms, idioms.size(), text);
+    run("pinyin words", words, words.size(), text);
+    run("5000 idioms", idioms, 5000, text);
+    return 0;
+}
@@ -0,0 +1,258 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <algorithm>
+
+#include "aho_corasick.h"
+
+#define AC_NONE     0xffffffffU
+#define HUGE_PAGE   (2 << 20)
+
+// The trie while it is built, the children of a state in a list.
+struct AcTrie {
+    std::vector<uint32_t> first;
+    std::vector<uint32_t> next;
+    std::vector<uint8_t> label;
+
+    AcTrie() : first(1, AC_NONE), next(1, AC_NONE), label(1, 0) {}
+
+    uint32_t child(uint32_t s, uint8_t c) const
+    {
+        uint32_t t = first[s];
+        while (t != AC_NONE && label[t] != c)
+            t = next[t];
+        return t;
+    }
+
+    uint32_t add(uint32_t s, uint8_t c)
+    {
+        uint32_t t = first.size();
+        first.push_back(AC_NONE);
+        next.push_back(first[s]);
+        label.push_back(c);
+        first[s] = t;
+        return t;
+    }
+};
+
+AhoCorasick::AhoCorasick()
+  : m_maxSize(0),
+    m_stride(1),
+    m_states(0),
+    m_root(0),
+    m_denseStates(0),
+    m_table(NULL),
+    m_tableSize(0),
+    m_sparse(NULL)
+{
+    memset(m_class, 0, sizeof(m_class));
+}
+
+AhoCorasick::~AhoCorasick()
+{
+    free(m_table);
+}
+
+int AhoCorasick::add(const char* pattern, size_t size)
+{
+    if (size == 0)
+        return -1;
+    m_patterns.push_back(std::string(pattern, size));
+    m_maxSize = std::max(m_maxSize, size);
+    return m_patterns.size() - 1;
+}
+
+void AhoCorasick::build()
+{
+    bool used[256] = {false};
+    for (size_t p = 0; p < m_patterns.size(); p++) {
+        for (size_t i = 0; i < m_patterns[p].size(); i++)
+            used[(unsigned char)m_patterns[p][i]] = true;
+    }
+    m_stride = 1;
+    for (int b = 0; b < 256; b++)
+        m_class[b] = used[b] ? m_stride++ : 0;
+
+    // the trie, 0 the root
+    AcTrie trie;
+    std::vector<uint32_t> own(1, 0);
+    std::vector<int> ownFirst(1, -1);
+    std::vector<int> ownNext(m_patterns.size(), -1);
+    for (size_t p = 0; p < m_patterns.size(); p++) {
+        uint32_t s = 0;
+        for (size_t i = 0; i < m_patterns[p].size(); i++) {
+            uint8_t c = m_class[(unsigned char)m_patterns[p][i]];
+            uint32_t t = trie.child(s, c);
+            if (t == AC_NONE) {
+                t = trie.add(s, c);
+                own.push_back(0);
+                ownFirst.push_back(-1);
+            }
+            s = t;
+        }
+        own[s]++;
+        ownNext[p] = ownFirst[s];
+        ownFirst[s] = p;
+    }
+    m_states = own.size();
+
+    // Breadth first, so a state's failure link, the longest proper suffix
+    // of it in the trie, is done before it.
+    std::vector<uint32_t> fail(m_states, 0);
+    std::vector<uint32_t> order(1, 0);
+    // patterns ending here, counting those that end in a suffix
+    std::vector<uint32_t> outCount(m_states, 0);
+    for (size_t k = 0; k < order.size(); k++) {
+        uint32_t s = order[k];
+        outCount[s] = own[s] + (s ? outCount[fail[s]] : 0);
+        for (uint32_t t = trie.first[s]; t != AC_NONE; t = trie.next[t]) {
+            uint32_t f = fail[s], g = AC_NONE;
+            while (s && (g = trie.child(f, trie.label[t])) == AC_NONE && f)
+                f = fail[f];
+            fail[t] = g == AC_NONE ? 0 : g;
+            order.push_back(t);
+        }
+    }
+
+    // The first states breadth first get dense rows, the rest sparse
+    // nodes. A node's transitions are its children and those of its
+    // failure link's node that it has no child for; where the failure link
+    // is dense, it falls back to that row. A state that would have more
+    // than 16 transitions gets a dense row as well.
+    size_t first = std::max((size_t)1, std::min(m_states,
+        AC_DENSE_BYTES / ((m_stride + 1) * sizeof(uint32_t))));
+    std::vector<bool> dense(m_states, false);
+    for (size_t k = 0; k < first; k++)
+        dense[order[k]] = true;
+    std::vector<uint32_t> fallback(m_states, 0);
+    std::vector<uint32_t> moveStart(m_states, 0);
+    std::vector<uint32_t> moves(m_states, 0);
+    std::vector<uint8_t> moveClass;
+    std::vector<uint32_t> moveTo;
+    for (size_t k = first; k < order.size(); k++) {
+        uint32_t s = order[k], f = fail[s];
+        moveStart[s] = moveTo.size();
+        for (uint32_t t = trie.first[s]; t != AC_NONE; t = trie.next[t]) {
+            moveClass.push_back(trie.label[t]);
+            moveTo.push_back(t);
+        }
+        fallback[s] = f;
+        if (!dense[f]) {
+            fallback[s] = fallback[f];
+            for (uint32_t j = moveStart[f]; j < moveStart[f] + moves[f]; j++) {
+                if (trie.child(s, moveClass[j]) == AC_NONE) {
+                    moveClass.push_back(moveClass[j]);
+                    moveTo.push_back(moveTo[j]);
+                }
+            }
+        }
+        moves[s] = moveTo.size() - moveStart[s];
+        if (moves[s] > 16) {
+            dense[s] = true;
+            moves[s] = 0;
+            moveClass.resize(moveStart[s]);
+            moveTo.resize(moveStart[s]);
+        }
+    }
+
+    // dense rows breadth first, then the sparse nodes depth first, with a
+    // word for the output before those that have any
+    std::vector<uint32_t> state(m_states);
+    uint64_t size = 0;
+    m_denseStates = 0;
+    for (size_t k = 0; k < order.size(); k++) {
+        uint32_t s = order[k];
+        if (!dense[s])
+            continue;
+        size += outCount[s] ? 1 : 0;
+        state[s] = size;
+        size += m_stride;
+        m_denseStates++;
+    }
+    // a node keeps the offset of its row in 24 bits
+    size_t denseSize = size;
+    bool fits = denseSize < (1 << 24);
+    std::vector<uint32_t> stack(1, 0);
+    while (!stack.empty()) {
+        uint32_t s = stack.back();
+        stack.pop_back();
+        if (!dense[s]) {
+            size += (outCount[s] ? 1 : 0) + moves[s];
+            state[s] = size;
+            size += 1 + (moves[s] + 3) / 4;
+        }
+        for (uint32_t t = trie.first[s]; t != AC_NONE; t = trie.next[t])
+            stack.push_back(t);
+    }
+    if ((!fits && size > denseSize) || size >= AC_MATCH) {
+        printf("ERROR: %zu states of %u classes is too many\n", m_states,
+               m_stride);
+        abort();
+    }
+    m_tableSize = size;
+    // m_next() reads up to 16 bytes from the classes of the last node
+    size_t bytes = (m_tableSize * sizeof(uint32_t) + 16 + HUGE_PAGE - 1) &
+                   ~(size_t)(HUGE_PAGE - 1);
+    if (posix_memalign((void**)&m_table, HUGE_PAGE, bytes))
+        abort();
+    madvise(m_table, bytes, MADV_HUGEPAGE);
+    memset(m_table, 0, bytes);
+    m_sparse = m_table + denseSize;
+
+    // outputs of the states with any, walking the failure links
+    m_out.clear();
+    for (size_t k = 0; k < order.size(); k++) {
+        uint32_t s = order[k];
+        if (!outCount[s])
+            continue;
+        m_table[state[s] - 1 - moves[s]] = m_out.size();
+        m_out.push_back(outCount[s]);
+        for (uint32_t f = s; f && outCount[f]; f = fail[f]) {
+            for (int p = ownFirst[f]; p >= 0; p = ownNext[p])
+                m_out.push_back(p);
+        }
+    }
+
+    // Breadth first again, so the failure link is done before its state
+    // and the fallback row before its nodes. A dense row is the failure
+    // link's transitions with the state's own children over them; the
+    // root's misses all go back to the root.
+    std::vector<uint32_t> next(m_states);
+    for (uint32_t s = 0; s < m_states; s++)
+        next[s] = state[s] | (outCount[s] ? AC_MATCH : 0);
+    m_root = next[0];
+    for (size_t k = 0; k < order.size(); k++) {
+        uint32_t s = order[k];
+        uint32_t* node = m_table + state[s];
+        if (dense[s]) {
+            for (uint32_t c = 0; c < m_stride; c++)
+                node[c] = s ? m_next(next[fail[s]], c) : m_root;
+            for (uint32_t t = trie.first[s]; t != AC_NONE; t = trie.next[t])
+                node[trie.label[t]] = next[t];
+            continue;
+        }
+        uint32_t n = moves[s];
+        node[0] = state[fallback[s]] << 8 | n;
+        uint8_t* cls = (uint8_t*)(node + 1);
+        for (uint32_t j = 0; j < n; j++) {
+            cls[j] = moveClass[moveStart[s] + j];
+            node[-1 - (int)j] = next[moveTo[moveStart[s] + j]];
+        }
+    }
+}
+
+size_t AhoCorasick::bytes() const
+{
+    return m_tableSize * sizeof(uint32_t) + sizeof(m_class) +
+           m_out.size() * sizeof(int);
+}
+
+size_t AhoCorasick::count(const char* text, size_t size) const
+{
+    size_t found = 0;
+    scan(text, size, m_root, 0, [&found](int, uint64_t) { found++; });
+    return found;
+}
@@ -0,0 +1,232 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#ifndef __AHO_CORASICK_H__
+#define __AHO_CORASICK_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <emmintrin.h>
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+// bytes scanned as one block of AC_LANES interleaved lanes
+#define AC_BLOCK    (256 << 10)
+#define AC_LANES    16
+// bytes of dense rows for the states nearest the root; by default every
+// state has one, a plain DFA
+#define AC_DENSE_BYTES  ((size_t)-1)
+// top bit of a state: some pattern ends there
+#define AC_MATCH    0x80000000U
+
+// Aho-Corasick automaton over many literal patterns. Bytes are first
+// mapped to classes (bytes no pattern uses all share class 0), so a state
+// has one transition per class rather than 256.
+//
+// Every state, breadth first up to AC_DENSE_BYTES, gets a dense row of next
+// states, one load per byte. For large dictionaries that table is far bigger
+// than the caches, most of it rows of deep states that differ from a
+// shallower one in a transition or two, so a smaller AC_DENSE_BYTES trades
+// speed for size: every state past it is a sparse node that keeps only the
+// transitions differing from those of the first dense state along its
+// failure links, its trie children and those of the sparse states on the way
+// there, and falls back to that row for any other byte; one that would keep
+// more than 16 gets a dense row instead. So no failure links are followed
+// while scanning, and a node's classes are matched in one SSE2 compare. A
+// node with one transition takes 12 bytes, and the nodes are laid out depth
+// first, so a pattern's states mostly share a cache line or two. Rows and
+// nodes share one table and a state is its offset in it, with AC_MATCH set
+// where some pattern ends.
+//
+// Long buffers are cut into blocks scanned as AC_LANES independent lanes
+// in lockstep, which keeps that many misses in flight. A lane starts in
+// the root state the length of the longest pattern before its part of the
+// block, so it is in the right state by the time that part begins.
+class AhoCorasick
+{
+public:
+    AhoCorasick();
+    ~AhoCorasick();
+
+    // returns the id of the pattern, ids count up from 0; empty patterns
+    // are ignored and get -1
+    int add(const char* pattern, size_t size);
+    int add(const std::string & pattern)
+    {
+        return add(pattern.data(), pattern.size());
+    }
+    // no add() after this
+    void build();
+
+    size_t patterns() const { return m_patterns.size(); }
+    size_t pattern_size(int id) const { return m_patterns[id].size(); }
+    size_t states() const { return m_states; }
+    size_t dense_states() const { return m_denseStates; }
+    // bytes of the tables the scan uses
+    size_t bytes() const;
+
+    uint32_t start() const { return m_root; }
+
+    // Scan text from state, calling on_match(id, end) for every pattern id
+    // that ends at text[end - 1], end counted from offset, in order of end.
+    // Returns the state to carry into the next chunk, so input can be
+    // scanned in pieces and matches across the cuts are still found.
+    template <typename Func>
+    uint32_t scan(const char* text, size_t size, uint32_t state,
+                  uint64_t offset, Func on_match) const
+    {
+        size_t pos = 0;
+        for (;;) {
+            // lanes only pay off, and are cheap to start, when they are
+            // much longer than the longest pattern
+            size_t lane = std::min((size_t)AC_BLOCK, size - pos) / AC_LANES;
+            if (lane == 0 || lane < 64 * m_maxSize)
+                break;
+            state = m_scan_lanes(text + pos, lane, state, offset + pos,
+                                 on_match);
+            pos += lane * AC_LANES;
+        }
+        return m_scan(text + pos, size - pos, state, offset + pos, on_match);
+    }
+
+    size_t count(const char* text, size_t size) const;
+
+private:
+    AhoCorasick(const AhoCorasick &);
+    AhoCorasick & operator=(const AhoCorasick &);
+
+    template <typename Func>
+    void m_report(uint32_t state, uint64_t end, Func & on_match) const
+    {
+        const uint32_t* node = m_table + (state & ~AC_MATCH);
+        int n = node < m_sparse ? 0 : node[0] & 0xff;
+        const int* out = &m_out[node[-1 - n]];
+        for (int j = 1; j <= out[0]; j++)
+            on_match(out[j], end);
+    }
+
+    // A node is searched branch free, as whether the byte is one of its
+    // transitions is as good as random. Classes past the n-th are whatever
+    // follows them and never count, and without a match the node's own
+    // word is read, as it is at hand, and thrown away.
+    uint32_t m_next(uint32_t state, unsigned int c) const
+    {
+        const uint32_t* node = m_table + (state & ~AC_MATCH);
+        if (node < m_sparse)
+            return node[c];
+        uint32_t head = node[0];
+        __m128i v = _mm_loadu_si128((const __m128i*)(node + 1));
+        unsigned int i = __builtin_ctz(0x10000 | _mm_movemask_epi8(
+            _mm_cmpeq_epi8(v, _mm_set1_epi8(c))));
+        uint32_t found = -(uint32_t)(i < (head & 0xff));
+        uint32_t hit = node[(int32_t)(~i & found)];
+        uint32_t miss = m_table[(head >> 8) + c];
+        return (hit & found) | (miss & ~found);
+    }
+
+    template <typename Func>
+    uint32_t m_scan(const char* text, size_t size, uint32_t state,
+                    uint64_t offset, Func & on_match) const
+    {
+        const unsigned char* t = (const unsigned char*)text;
+        const uint8_t* cls = m_class;
+        for (size_t i = 0; i < size; i++) {
+            state = m_next(state, cls[t[i]]);
+            if (state & AC_MATCH)
+                m_report(state, offset + i + 1, on_match);
+        }
+        return state;
+    }
+
+    // AC_LANES lanes of lane bytes each; lane 0 reports as it goes, the
+    // others keep their match states and positions until the lanes before
+    // them are done
+    template <typename Func>
+    uint32_t m_scan_lanes(const char* text, size_t lane, uint32_t state,
+                          uint64_t offset, Func & on_match) const
+    {
+        const unsigned char* t = (const unsigned char*)text;
+        const uint8_t* cls = m_class;
+        uint32_t s[AC_LANES];
+        std::vector<std::pair<uint32_t, uint32_t> > pending[AC_LANES];
+        s[0] = state;
+        for (int k = 1; k < AC_LANES; k++) {
+            s[k] = m_root;
+            for (size_t i = k * lane - m_maxSize; i < k * lane; i++)
+                s[k] = m_next(s[k], cls[t[i]]);
+        }
+        for (uint32_t i = 0; i < lane; i++) {
+            for (int k = 0; k < AC_LANES; k++)
+                s[k] = m_next(s[k], cls[t[k * lane + i]]);
+            if (s[0] & AC_MATCH)
+                m_report(s[0], offset + i + 1, on_match);
+            for (int k = 1; k < AC_LANES; k++) {
+                if (s[k] & AC_MATCH)
+                    pending[k].push_back(std::make_pair(s[k], k * lane + i));
+            }
+        }
+        for (int k = 1; k < AC_LANES; k++) {
+            for (size_t j = 0; j < pending[k].size(); j++)
+                m_report(pending[k][j].first,
+                         offset + pending[k][j].second + 1, on_match);
+        }
+        return s[AC_LANES - 1];
+    }
+
+    std::vector<std::string> m_patterns;
+    size_t m_maxSize;
+    uint8_t m_class[256];
+    uint32_t m_stride;
+    size_t m_states;
+    uint32_t m_root;
+    size_t m_denseStates;
+    // On huge pages where the kernel has them. A dense row is the next
+    // state for each class. A sparse node is a word holding the offset of
+    // the row it falls back to, shifted left 8, and its number of
+    // transitions n, at most 16, then the classes of those packed four to
+    // a word; the next state of the i-th is i + 1 words before the node.
+    // For a state with AC_MATCH, the word before its row, or before its
+    // next states, is the index in m_out of its output.
+    uint32_t* m_table;
+    size_t m_tableSize;
+    // where the dense rows end and the sparse nodes begin
+    const uint32_t* m_sparse;
+    // a count and then that many pattern ids, those ending in a state, its
+    // own and those of its suffixes; states without any point at 0
+    std::vector<int> m_out;
+};
+
+// Carries the state and the offset from one chunk of a stream to the next.
+class AhoCorasickStream
+{
+public:
+    explicit AhoCorasickStream(const AhoCorasick & ac)
+      : m_ac(ac),
+        m_state(ac.start()),
+        m_offset(0)
+    {
+    }
+
+    template <typename Func>
+    void feed(const char* chunk, size_t size, Func on_match)
+    {
+        m_state = m_ac.scan(chunk, size, m_state, m_offset, on_match);
+        m_offset += size;
+    }
+
+    void reset()
+    {
+        m_state = m_ac.start();
+        m_offset = 0;
+    }
+
+    uint64_t offset() const { return m_offset; }
+
+private:
+    const AhoCorasick & m_ac;
+    uint32_t m_state;
+    uint64_t m_offset;
+};
+
+#endif // __AHO_CORASICK_H__
@@ -0,0 +1,25 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <time.h>
+
+static inline double now_sec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// xorshift, so the inputs are the same on every run and cheap to make
+static inline unsigned int bench_rand()
+{
+    static unsigned int state = 2463534242U;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+#endif // __BENCH_H__
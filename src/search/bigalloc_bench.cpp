@@ -0,0 +1,140 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+//
+//   bigalloc_bench
+//
+// Counts the heap allocations bigint makes per operation, by counting
+// calls to operator new, and times the operations: arithmetic on one- and
+// two-block numbers, the prime product that boyer_moore used (a BigInteger
+// multiplied and then divided once per character), 1000! by repeated
+// multiplication, and decimal conversion.  Build with
+// -DNUMBERLIKEARRAY_NO_POOL to see the inline blocks without the pool.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+#include <string>
+
+#include "bigint/BigIntegerLibrary.hh"
+#include "bench.h"
+
+static unsigned long allocations = 0;
+
+void *operator new(size_t size)
+{
+    allocations++;
+    void *p = malloc(size ? size : 1);
+    if (p == NULL)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) throw()
+{
+    free(p);
+}
+
+void operator delete[](void *p) throw()
+{
+    free(p);
+}
+
+// one prime per printable character, as in multiset_bench
+static const int primeNum[] = {
+    2,   3,   5,   7,   11,  13,  17,  19,  23,  29,  31,  37,  41,  43,
+    47,  53,  59,  61,  67,  71,  73,  79,  83,  89,  97,  101, 103, 107,
+    109, 113, 127, 131, 137, 139, 149, 151, 157, 163, 167, 173, 179, 181,
+    191, 193, 197, 199, 211, 223, 227, 229, 233, 239, 241, 251, 257, 263,
+    269, 271, 277, 281, 283, 293, 307, 311, 313, 317, 331, 337, 347, 349,
+    353, 359, 367, 373, 379, 383, 389, 397, 401, 409, 419, 421, 431, 433,
+    439, 443, 449, 457, 461, 463, 467, 479, 487, 491};
+
+// a * b + c / d % e on numbers of up to two blocks; returns the number of
+// operations
+static int small_arithmetic(BigUnsigned & sum)
+{
+    const int rounds = 1000;
+    for (int i = 0; i < rounds; i++) {
+        BigUnsigned a(bench_rand()), b(bench_rand()), c = a * b * b;
+        BigUnsigned d(bench_rand() | 1), e(bench_rand() | 1);
+        sum += a * b + c / d % e;
+    }
+    return rounds * 7;
+}
+
+// the product of 256 characters' primes, taken apart again by % and /
+static int prime_product(BigUnsigned & sum)
+{
+    const int length = 256;
+    char text[length];
+    for (int i = 0; i < length; i++)
+        text[i] = '!' + bench_rand() % 94;
+    BigInteger product = 1;
+    for (int i = 0; i < length; i++)
+        product *= primeNum[text[i] - '!'];
+    for (int i = 0; i < length; i++) {
+        int prime = primeNum[text[i] - '!'];
+        if (product % prime != 0)
+            break;
+        product /= prime;
+    }
+    sum += product.getMagnitude();
+    return length * 3;
+}
+
+static int factorial(BigUnsigned & sum)
+{
+    BigUnsigned f = 1;
+    for (unsigned int i = 2; i <= 1000; i++)
+        f *= i;
+    sum += f.getBlock(0);
+    return 999;
+}
+
+static int decimal(BigUnsigned & sum)
+{
+    BigUnsigned x = 1;
+    for (int i = 0; i < 7; i++)
+        x = x * BigUnsigned(bench_rand() | 1u << 31);
+    std::string s = bigUnsignedToString(x);
+    sum += stringToBigUnsigned(s) - x;
+    return 2;
+}
+
+struct Workload {
+    const char *name;
+    int (*run)(BigUnsigned & sum);
+};
+
+int main()
+{
+    const Workload workloads[] = {
+        {"small arithmetic", small_arithmetic},
+        {"prime product", prime_product},
+        {"1000!", factorial},
+        {"decimal round trip", decimal}};
+    BigUnsigned sum;
+
+    printf("%-20s %12s %12s\n", "operation", "allocs/op", "time/op");
+    for (size_t w = 0; w < sizeof(workloads) / sizeof(workloads[0]); w++) {
+        // one warm-up run fills the pool, if there is one
+        workloads[w].run(sum);
+        unsigned long before = allocations;
+        long ops = 0;
+        int runs = 0;
+        double start = now_sec(), elapsed;
+        do {
+            ops += workloads[w].run(sum);
+            runs++;
+            elapsed = now_sec() - start;
+        } while (elapsed < 0.2 || runs < 3);
+        printf("%-20s %12.2f %10.0fns\n", workloads[w].name,
+               double(allocations - before) / ops, elapsed / ops * 1e9);
+    }
+    printf("(checksum %lu)\n", (sum % 1000000007u).toUnsignedLong());
+    return 0;
+}
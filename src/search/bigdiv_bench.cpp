@@ -0,0 +1,296 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+//
+//   bigdiv_bench [tune]
+//
+// Checks BigUnsigned::divideWithRemainder against the bit-by-bit
+// shift-and-subtract it replaced, with and without the recursive division,
+// on random operands and on ones built to hit the rare corrections of the
+// quotient estimates; checks the recursive division against Algorithm D up
+// to 32K blocks; then times the old algorithm, Algorithm D and the
+// defaults on 2n by n blocks and on a one-block divisor.  With "tune" it
+// finds the Burnikel-Ziegler threshold instead, the value to put in
+// bigint/BigUnsigned.cc.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "bigint/BigIntegerLibrary.hh"
+#include "bench.h"
+
+typedef BigUnsigned::Blk Blk;
+typedef BigUnsigned::Index Index;
+
+static const Index NEVER = ~Index(0);
+
+static Blk rand_blk()
+{
+    Blk x = 0;
+    for (unsigned int i = 0; i < sizeof(Blk); i += 4)
+        x = (x << 16 << 16) | bench_rand();
+    return x;
+}
+
+// n random blocks, or n all-ones blocks
+static BigUnsigned rand_big(Index n, bool ones = false)
+{
+    std::vector<Blk> b(n);
+    for (Index i = 0; i < n; i++)
+        b[i] = ones ? ~Blk(0) : rand_blk();
+    if (b[n - 1] == 0)
+        b[n - 1] = 1;
+    return BigUnsigned(&b[0], n);
+}
+
+// n blocks shaped to stress the division: random, all ones, a top block
+// of 1 (the largest normalizing shift), or a top block with its top bit
+// set and the rest of it zero (none, and a top block that is a poor guide)
+static BigUnsigned shaped_big(Index n, int shape)
+{
+    std::vector<Blk> b(n);
+    for (Index i = 0; i < n; i++)
+        b[i] = (shape == 1) ? ~Blk(0) : rand_blk();
+    if (shape == 2)
+        b[n - 1] = 1;
+    else if (shape == 3)
+        b[n - 1] = Blk(1) << (BigUnsigned::N - 1);
+    else if (b[n - 1] == 0)
+        b[n - 1] = 1;
+    return BigUnsigned(&b[0], n);
+}
+
+// the division loop BigUnsigned used to have: for each bit position of
+// the quotient, from the top, try to subtract b shifted left that far
+static void shift_subtract_divide(const BigUnsigned & a,
+                                  const BigUnsigned & b,
+                                  BigUnsigned & q, BigUnsigned & r)
+{
+    Index an = a.getLength(), bn = b.getLength();
+    if (bn == 0 || an < bn) {
+        q = 0;
+        r = a;
+        return;
+    }
+    const unsigned int N = BigUnsigned::N;
+    std::vector<Blk> x(an + 1, 0), y(bn + 1, 0), buf(an + 1);
+    for (Index i = 0; i < an; i++)
+        x[i] = a.getBlock(i);
+    for (Index i = 0; i < bn; i++)
+        y[i] = b.getBlock(i);
+    std::vector<Blk> qb(an - bn + 1, 0);
+    for (Index i = an - bn + 1; i > 0; ) {
+        i--;
+        for (unsigned int i2 = N; i2 > 0; ) {
+            i2--;
+            bool borrowIn = false;
+            Index k = i;
+            for (Index j = 0; j <= bn; j++, k++) {
+                Blk lo = (j == 0 || i2 == 0) ? 0 : y[j - 1] >> (N - i2);
+                Blk shifted = lo | (y[j] << i2);
+                Blk temp = x[k] - shifted;
+                bool borrowOut = temp > x[k];
+                if (borrowIn) {
+                    borrowOut |= (temp == 0);
+                    temp--;
+                }
+                buf[k] = temp;
+                borrowIn = borrowOut;
+            }
+            for (; k < an && borrowIn; k++) {
+                borrowIn = (x[k] == 0);
+                buf[k] = x[k] - 1;
+            }
+            if (!borrowIn) {
+                qb[i] |= Blk(1) << i2;
+                while (k > i) {
+                    k--;
+                    x[k] = buf[k];
+                }
+            }
+        }
+    }
+    q = BigUnsigned(&qb[0], an - bn + 1);
+    r = BigUnsigned(&x[0], an);
+}
+
+static int compare_division(const BigUnsigned & a, const BigUnsigned & b,
+                            const BigUnsigned & wq, const BigUnsigned & wr,
+                            const char * how)
+{
+    BigUnsigned r(a), q;
+    r.divideWithRemainder(b, q);
+    if (q == wq && r == wr)
+        return 0;
+    printf("ERROR: %u / %u blocks wrong %s\n", a.getLength(),
+           b.getLength(), how);
+    return 1;
+}
+
+static int check()
+{
+    // the defaults, Algorithm D only, and the smallest threshold allowed,
+    // which sends every division down the deepest recursion
+    Index bz = BigUnsigned::burnikelZieglerThreshold;
+    const Index settings[] = {bz, NEVER, 4};
+    int bad = 0, count = 0;
+
+    for (int round = 0; round < 600; round++) {
+        Index bn = 1 + bench_rand() % ((round % 4 == 0) ? 3 : 120);
+        BigUnsigned b = shaped_big(bn, round % 4);
+        BigUnsigned a;
+        if (round % 3 == 0) {
+            // b q + r with r just under b and q of all ones, which
+            // leaves the top blocks of each partial remainder equal to
+            // those of b as often as they can be
+            Index qn = 1 + bench_rand() % 120;
+            a = b * shaped_big(qn, 1) + (b - 1);
+        } else {
+            Index an = bn + bench_rand() % 150;
+            a = (round % 5 == 0) ? shaped_big(an, 1) : rand_big(an);
+        }
+        BigUnsigned wq, wr;
+        shift_subtract_divide(a, b, wq, wr);
+        for (size_t s = 0; s < sizeof(settings) / sizeof(settings[0]); s++) {
+            BigUnsigned::burnikelZieglerThreshold = settings[s];
+            count++;
+            if (compare_division(a, b, wq, wr, "against shift-subtract") &&
+                bad++ >= 5)
+                break;
+        }
+    }
+
+    // the recursion against Algorithm D, checked by q b + r == a
+    for (int round = 0; round < 16; round++) {
+        Index bn = 256 + bench_rand() % 16384;
+        Index an = bn + 256 + bench_rand() % 16384;
+        BigUnsigned a = rand_big(an), b = shaped_big(bn, round % 4);
+        BigUnsigned::burnikelZieglerThreshold = NEVER;
+        BigUnsigned wr(a), wq;
+        wr.divideWithRemainder(b, wq);
+        BigUnsigned::burnikelZieglerThreshold = bz;
+        count++;
+        if (wq * b + wr != a || wr >= b) {
+            printf("ERROR: %u / %u blocks wrong by Algorithm D\n", an, bn);
+            bad++;
+        } else
+            bad += compare_division(a, b, wq, wr, "by the recursion");
+    }
+    BigUnsigned::burnikelZieglerThreshold = bz;
+
+    // division by zero keeps Knuth's a / 0 == 0, a % 0 == a, and the
+    // aliased and signed forms go through the same code
+    BigUnsigned a = rand_big(50), b = rand_big(20), zero;
+    bad += compare_division(a, zero, zero, a, "by zero");
+    BigUnsigned r(a);
+    r.divideWithRemainder(r, b);
+    BigInteger neg(a, BigInteger::negative), d(rand_big(20));
+    BigInteger quot = neg / d, rem = neg % d;
+    if (r != 0 || b != 1 || quot * d + rem != neg ||
+        rem.getMagnitude() >= d.getMagnitude()) {
+        printf("ERROR: aliased or signed division wrong\n");
+        bad++;
+    }
+    count += 4;
+    printf("%d divisions checked, %d wrong\n", count, bad);
+    return bad;
+}
+
+// seconds per a / b, repeated for at least a tenth of a second
+static double time_divide(const BigUnsigned & a, const BigUnsigned & b,
+                          bool old = false)
+{
+    BigUnsigned q, r;
+    int reps = 0;
+    double start = now_sec(), elapsed;
+    do {
+        if (old) {
+            shift_subtract_divide(a, b, q, r);
+        } else {
+            r = a;
+            r.divideWithRemainder(b, q);
+        }
+        reps++;
+        elapsed = now_sec() - start;
+    } while (elapsed < 0.1);
+    return elapsed / reps;
+}
+
+static void timings()
+{
+    Index bz = BigUnsigned::burnikelZieglerThreshold;
+    printf("\n%6s %12s %12s %12s %8s\n", "2n / n", "shift-sub",
+           "knuth", "default", "speedup");
+    for (Index n = 8; n <= 8192; n *= 2) {
+        BigUnsigned a = rand_big(2 * n), b = rand_big(n);
+        double old = (n <= 512) ? time_divide(a, b, true) : 0;
+        BigUnsigned::burnikelZieglerThreshold = NEVER;
+        double knuth = time_divide(a, b);
+        BigUnsigned::burnikelZieglerThreshold = bz;
+        double best = time_divide(a, b);
+        if (old > 0)
+            printf("%6u %10.1fus %10.1fus %10.1fus %7.0fx\n", n,
+                   old * 1e6, knuth * 1e6, best * 1e6, old / best);
+        else
+            printf("%6u %12s %10.1fus %10.1fus %8s\n", n, "-",
+                   knuth * 1e6, best * 1e6, "-");
+    }
+
+    printf("\n%6s %12s %12s %8s\n", "n / 1", "shift-sub", "default",
+           "speedup");
+    for (Index n = 8; n <= 8192; n *= 4) {
+        BigUnsigned a = rand_big(n), b = rand_big(1);
+        double old = time_divide(a, b, true), best = time_divide(a, b);
+        printf("%6u %10.1fus %10.1fus %7.0fx\n", n, old * 1e6, best * 1e6,
+               old / best);
+    }
+}
+
+// one level of the recursion costs about as much as Algorithm D, so the
+// threshold is the candidate with the least total time, each size's time
+// taken relative to the fastest candidate, over 2n by n blocks from 256
+// to 16K blocks
+static Index tune()
+{
+    const Index candidates[] = {64, 128, 256, 384, 512, 768, 1024, NEVER};
+    const int count = sizeof(candidates) / sizeof(candidates[0]);
+    double total[count] = {0};
+    printf("%6s", "2n / n");
+    for (int c = 0; c < count - 1; c++)
+        printf(" %8u", candidates[c]);
+    printf(" %8s\n", "knuth");
+    for (Index n = 256; n <= 16384; n *= 2) {
+        BigUnsigned a = rand_big(2 * n), b = rand_big(n);
+        double t[count], fastest = 0;
+        printf("%6u", n);
+        for (int c = 0; c < count; c++) {
+            BigUnsigned::burnikelZieglerThreshold = candidates[c];
+            t[c] = time_divide(a, b);
+            if (c == 0 || t[c] < fastest)
+                fastest = t[c];
+            printf(" %6.0fus", t[c] * 1e6);
+        }
+        printf("\n");
+        for (int c = 0; c < count; c++)
+            total[c] += t[c] / fastest;
+    }
+    int best = 0;
+    for (int c = 1; c < count; c++)
+        if (total[c] < total[best])
+            best = c;
+    return candidates[best];
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "tune") == 0) {
+        Index bz = tune();
+        printf("burnikelZieglerThreshold = %u\n", bz);
+        BigUnsigned::burnikelZieglerThreshold = bz;
+        return 0;
+    }
+    if (check() != 0)
+        return 1;
+    timings();
+    return 0;
+}
@@ -0,0 +1,322 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+//
+//   bigexpr_bench
+//
+// Checks the operators that reuse operands about to die, the aliased
+// in-place add, subtract and multiply, and addmul against the copy-less
+// operations on fresh variables; then counts heap allocations (calls to
+// operator new) and times polynomial evaluation, by Horner's rule written
+// with operators and with compound assignments and by addmul, and 3000!
+// written as an expression and as *=.  The pool hides most allocations;
+// build with -DNUMBERLIKEARRAY_NO_POOL to count every array the operators
+// create, copies included.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "bigint/BigIntegerLibrary.hh"
+#include "bench.h"
+
+typedef BigUnsigned::Blk Blk;
+typedef BigUnsigned::Index Index;
+
+static unsigned long allocations = 0;
+
+void *operator new(size_t size)
+{
+    allocations++;
+    void *p = malloc(size ? size : 1);
+    if (p == NULL)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) throw()
+{
+    free(p);
+}
+
+void operator delete[](void *p) throw()
+{
+    free(p);
+}
+
+static Blk rand_blk()
+{
+    Blk x = 0;
+    for (unsigned int i = 0; i < sizeof(Blk); i += 4)
+        x = (x << 16 << 16) | bench_rand();
+    return x;
+}
+
+static BigUnsigned rand_big(Index n)
+{
+    std::vector<Blk> b(n);
+    for (Index i = 0; i < n; i++)
+        b[i] = rand_blk();
+    if (b[n - 1] == 0)
+        b[n - 1] = 1;
+    return BigUnsigned(&b[0], n);
+}
+
+static BigInteger rand_signed(Index n)
+{
+    int s = bench_rand() % 3;
+    if (s == 0)
+        return BigInteger();
+    return BigInteger(rand_big(n), s == 1 ? BigInteger::positive
+                                          : BigInteger::negative);
+}
+
+static int check()
+{
+    int bad = 0, count = 0;
+    for (int round = 0; round < 2000; round++) {
+        BigUnsigned a = rand_big(1 + bench_rand() % 12);
+        BigUnsigned b = rand_big(1 + bench_rand() % (round % 2 ? 1 : 12));
+        BigUnsigned big = (a > b) ? a : b, small = (a > b) ? b : a;
+        BigUnsigned sum, diff, prod, quot, rem(big), fused(a);
+        sum.add(a, b);
+        diff.subtract(big, small);
+        prod.multiply(a, b);
+        rem.divideWithRemainder(small, quot);
+        fused.add(a, prod);
+        BigUnsigned twice, square;
+        twice.add(a, a);
+        square.multiply(a, a);
+
+        // temporaries on either side
+        BigUnsigned t1 = BigUnsigned(a) + b, t2 = a + BigUnsigned(b);
+        BigUnsigned t3 = BigUnsigned(a) + BigUnsigned(b);
+        BigUnsigned t4 = BigUnsigned(big) - small;
+        BigUnsigned t5 = big - BigUnsigned(small);
+        BigUnsigned t6 = BigUnsigned(big) / small;
+        BigUnsigned t7 = BigUnsigned(big) % small;
+        BigUnsigned t8 = a * b + a;
+        // aliased in-place forms
+        BigUnsigned x1(a), x2(b), x3(big), x4(small), x5(a), x6(b), x7(a);
+        x1 += b;
+        x2.add(a, x2);
+        x3 -= small;
+        x4.subtract(big, x4);
+        x5 *= b;
+        x6 *= a;
+        x7 += x7;
+        BigUnsigned x8(a), x9(a), x10(b), x11(a);
+        x8 *= x8;
+        x9.addmul(a, b);
+        x10.addmul(x10, a);
+        x11.addmul(x11, x11);
+        BigUnsigned x12(a);
+        x12.addmul(b, x12);
+
+        const BigUnsigned got[] = {t1, t2, t3, t4, t5, t6, t7, t8, x1, x2,
+                                   x3, x4, x5, x6, x7, x8, x9, x10, x11,
+                                   x12};
+        BigUnsigned x10want(b), x11want(a), x12want(a);
+        x10want.add(b, prod);
+        x11want.add(a, square);
+        x12want.add(a, prod);
+        const BigUnsigned want[] = {sum, sum, sum, diff, diff, quot, rem,
+                                    fused, sum, sum, diff, diff, prod,
+                                    prod, twice, square, fused, x10want,
+                                    x11want, x12want};
+        for (size_t i = 0; i < sizeof(got) / sizeof(got[0]); i++) {
+            count++;
+            if (got[i] != want[i] && bad++ < 5)
+                printf("ERROR: case %u wrong for %u x %u blocks\n",
+                       (unsigned int)i, a.getLength(), b.getLength());
+        }
+
+        // a negative result leaves an aliased operand as it was
+        if (small != big) {
+            BigUnsigned keep(small);
+            try {
+                keep -= big;
+            } catch (const char *) {
+            }
+            count++;
+            if (keep != small && bad++ < 5)
+                printf("ERROR: failed subtraction changed its operand\n");
+        }
+
+        // the signed forms against the copy-less operations
+        BigInteger p = rand_signed(1 + bench_rand() % 6);
+        BigInteger q = rand_signed(1 + bench_rand() % 6);
+        BigInteger ssum, sdiff, sprod, sfused(p);
+        ssum.add(p, q);
+        sdiff.subtract(p, q);
+        sprod.multiply(p, q);
+        sfused.add(p, sprod);
+        BigInteger y1(p), y2(q), y3(p), y4(p);
+        y1 += q;
+        y2.subtract(p, y2);
+        y3.addmul(p, q);
+        y4 -= y4;
+        BigInteger sneg;
+        sneg.negate(p);
+        const BigInteger sgot[] = {BigInteger(p) + q, p + BigInteger(q),
+                                   BigInteger(p) - q, p - BigInteger(q),
+                                   -BigInteger(p), y1, y2, y3, y4};
+        const BigInteger swant[] = {ssum, ssum, sdiff, sdiff, sneg, ssum,
+                                    sdiff, sfused, BigInteger()};
+        for (size_t i = 0; i < sizeof(sgot) / sizeof(sgot[0]); i++) {
+            count++;
+            if (sgot[i] != swant[i] && bad++ < 5)
+                printf("ERROR: signed case %u wrong\n", (unsigned int)i);
+        }
+        if (!q.isZero()) {
+            BigInteger sq, sr(p);
+            sr.divideWithRemainder(q, sq);
+            count += 2;
+            if ((BigInteger(p) / q != sq || BigInteger(p) % q != sr) &&
+                bad++ < 5)
+                printf("ERROR: signed division of a temporary wrong\n");
+        }
+    }
+
+    // a moved-from value is zero and can be used again
+    BigUnsigned from = rand_big(20), to(std::move(from));
+    from += 1;
+    count++;
+    if (from != 1 || to.getLength() != 20) {
+        printf("ERROR: moved-from value not zero\n");
+        bad++;
+    }
+    printf("%d results checked, %d wrong\n", count, bad);
+    return bad;
+}
+
+// p(x) = sum of coef[i] x^i by Horner's rule, as the operators write it
+static BigUnsigned horner(const std::vector<BigUnsigned> & coef,
+                          const BigUnsigned & x)
+{
+    BigUnsigned acc = coef.back();
+    for (size_t i = coef.size() - 1; i > 0; i--)
+        acc = acc * x + coef[i - 1];
+    return acc;
+}
+
+// the same with compound assignments, which work in place
+static BigUnsigned horner_inplace(const std::vector<BigUnsigned> & coef,
+                                  const BigUnsigned & x)
+{
+    BigUnsigned acc = coef.back();
+    for (size_t i = coef.size() - 1; i > 0; i--) {
+        acc *= x;
+        acc += coef[i - 1];
+    }
+    return acc;
+}
+
+// the same sum with the powers of x kept and added up by addmul
+static BigUnsigned power_sum(const std::vector<BigUnsigned> & coef,
+                             const BigUnsigned & x)
+{
+    BigUnsigned sum = coef[0], power = x;
+    for (size_t i = 1; i < coef.size(); i++) {
+        sum.addmul(coef[i], power);
+        power *= x;
+    }
+    return sum;
+}
+
+static BigUnsigned factorial_expr(unsigned int n)
+{
+    BigUnsigned f = 1;
+    for (unsigned int i = 2; i <= n; i++)
+        f = f * BigUnsigned(i);
+    return f;
+}
+
+static BigUnsigned factorial_inplace(unsigned int n)
+{
+    BigUnsigned f = 1;
+    for (unsigned int i = 2; i <= n; i++)
+        f *= i;
+    return f;
+}
+
+// allocations and seconds per call of f, over at least 0.2 seconds
+template <class F>
+static void measure(const char * name, F f, BigUnsigned & out)
+{
+    out = f();
+    unsigned long before = allocations;
+    int runs = 0;
+    double start = now_sec(), elapsed;
+    do {
+        out = f();
+        runs++;
+        elapsed = now_sec() - start;
+    } while (elapsed < 0.2);
+    printf("%-30s %10.1f %10.1fus\n", name,
+           double(allocations - before) / runs, elapsed / runs * 1e6);
+}
+
+struct Horner {
+    const std::vector<BigUnsigned> *coef;
+    const BigUnsigned *x;
+    bool inplace;
+    BigUnsigned operator()() const {
+        return inplace ? horner_inplace(*coef, *x) : horner(*coef, *x);
+    }
+};
+
+struct PowerSum {
+    const std::vector<BigUnsigned> *coef;
+    const BigUnsigned *x;
+    BigUnsigned operator()() const { return power_sum(*coef, *x); }
+};
+
+struct Factorial {
+    bool inplace;
+    BigUnsigned operator()() const {
+        return inplace ? factorial_inplace(3000) : factorial_expr(3000);
+    }
+};
+
+int main()
+{
+    if (check() != 0)
+        return 1;
+
+    printf("\n%-30s %10s %12s\n", "", "allocs", "time");
+    const Index xsizes[] = {1, 8};
+    for (size_t s = 0; s < sizeof(xsizes) / sizeof(xsizes[0]); s++) {
+        // degree 64, 4-block coefficients
+        std::vector<BigUnsigned> coef;
+        for (int i = 0; i <= 64; i++)
+            coef.push_back(rand_big(4));
+        BigUnsigned x = rand_big(xsizes[s]), a, b, c;
+        char name[3][64];
+        snprintf(name[0], sizeof(name[0]), "acc = acc * x + c, %u-block",
+                 xsizes[s]);
+        snprintf(name[1], sizeof(name[1]), "acc *= x, acc += c, %u-block",
+                 xsizes[s]);
+        snprintf(name[2], sizeof(name[2]), "sum.addmul(c, x^i), %u-block",
+                 xsizes[s]);
+        Horner h = {&coef, &x, false}, hi = {&coef, &x, true};
+        PowerSum p = {&coef, &x};
+        measure(name[0], h, a);
+        measure(name[1], hi, b);
+        measure(name[2], p, c);
+        if (a != b || a != c)
+            printf("ERROR: polynomial values differ\n");
+    }
+    BigUnsigned a, b;
+    Factorial expr = {false}, inplace = {true};
+    measure("3000!, f = f * i", expr, a);
+    measure("3000!, f *= i", inplace, b);
+    if (a != b)
+        printf("ERROR: factorials differ\n");
+    return 0;
+}
@@ -10,6 +10,16 @@ void BigInteger::operator =(const BigInteger &x) {
 	mag = x.mag;
 }
 
+#if __cplusplus >= 201103L
+void BigInteger::operator =(BigInteger &&x) {
+	if (this == &x)
+		return;
+	sign = x.sign;
+	mag = std::move(x.mag);
+	x.sign = zero;
+}
+#endif
+
 BigInteger::BigInteger(const Blk *b, Index blen, Sign s) : mag(b, blen) {
 	switch (s) {
 	case zero:
@@ -162,12 +172,14 @@ BigInteger::CmpRes BigInteger::compareTo(const BigInteger &x) const {
 	if (cond) { \
 		BigInteger tmpThis; \
 		tmpThis.op; \
-		*this = tmpThis; \
+		*this = BIGINT_MOVE(tmpThis); \
 		return; \
 	}
 
+/* `add' and `subtract' need no copy for aliased calls: they read the
+ * operands' signs before setting ours, and BigUnsigned's `add' and
+ * `subtract' handle aliased calls themselves. */
 void BigInteger::add(const BigInteger &a, const BigInteger &b) {
-	DTRT_ALIASED(this == &a || this == &b, add(a, b));
 	// If one argument is zero, copy the other.
 	if (a.sign == zero)
 		operator =(b);
@@ -203,7 +215,6 @@ void BigInteger::add(const BigInteger &a, const BigInteger &b) {
 void BigInteger::subtract(const BigInteger &a, const BigInteger &b) {
 	// Notice that this routine is identical to BigInteger::add,
 	// if one replaces b.sign by its opposite.
-	DTRT_ALIASED(this == &a || this == &b, subtract(a, b));
 	// If a is zero, copy b and flip its sign.  If b is zero, copy a.
 	if (a.sign == zero) {
 		mag = b.mag;
@@ -367,6 +378,21 @@ void BigInteger::negate(const BigInteger &a) {
 	sign = Sign(-a.sign);
 }
 
+void BigInteger::addmul(const BigInteger &a, const BigInteger &b) {
+	if (a.sign == zero || b.sign == zero)
+		return;
+	Sign s = (a.sign == b.sign) ? positive : negative;
+	// If we are zero or the product has our sign, the magnitudes add.
+	if (sign == zero || sign == s) {
+		mag.addmul(a.mag, b.mag);
+		sign = s;
+	} else {
+		BigInteger p;
+		p.multiply(a, b);
+		add(*this, p);
+	}
+}
+
 // INCREMENT/DECREMENT OPERATORS
 
 // Prefix increment
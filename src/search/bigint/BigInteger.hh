@@ -37,6 +37,14 @@ public:
 	// Assignment operator
 	void operator=(const BigInteger &x);
 
+#if __cplusplus >= 201103L
+	// Move constructor and assignment; `x' is left zero.
+	BigInteger(BigInteger &&x) : sign(x.sign), mag(std::move(x.mag)) {
+		x.sign = zero;
+	}
+	void operator=(BigInteger &&x);
+#endif
+
 	// Constructor that copies from a given array of blocks with a sign.
 	BigInteger(const Blk *b, Index blen, Sign s);
 
@@ -112,16 +120,30 @@ public:
 	 * are involved. */
 	void divideWithRemainder(const BigInteger &b, BigInteger &q);
 	void negate(const BigInteger &a);
+	// Like `*this += a * b', as BigUnsigned::addmul
+	void addmul(const BigInteger &a, const BigInteger &b);
 	
 	/* Bitwise operators are not provided for BigIntegers.  Use
 	 * getMagnitude to get the magnitude and operate on that instead. */
 
-	BigInteger operator +(const BigInteger &x) const;
-	BigInteger operator -(const BigInteger &x) const;
+	BigInteger operator +(const BigInteger &x) BIGINT_CONST_LVALUE;
+	BigInteger operator -(const BigInteger &x) BIGINT_CONST_LVALUE;
 	BigInteger operator *(const BigInteger &x) const;
-	BigInteger operator /(const BigInteger &x) const;
-	BigInteger operator %(const BigInteger &x) const;
-	BigInteger operator -() const;
+	BigInteger operator /(const BigInteger &x) BIGINT_CONST_LVALUE;
+	BigInteger operator %(const BigInteger &x) BIGINT_CONST_LVALUE;
+	BigInteger operator -() BIGINT_CONST_LVALUE;
+#if __cplusplus >= 201103L
+	// The overloads for operands about to die, as in BigUnsigned
+	BigInteger operator +(const BigInteger &x) &&;
+	BigInteger operator +(BigInteger &&x) const &;
+	BigInteger operator +(BigInteger &&x) &&;
+	BigInteger operator -(const BigInteger &x) &&;
+	BigInteger operator -(BigInteger &&x) const &;
+	BigInteger operator -(BigInteger &&x) &&;
+	BigInteger operator /(const BigInteger &x) &&;
+	BigInteger operator %(const BigInteger &x) &&;
+	BigInteger operator -() &&;
+#endif
 
 	void operator +=(const BigInteger &x);
 	void operator -=(const BigInteger &x);
@@ -141,12 +163,12 @@ public:
 /* These create an object to hold the result and invoke
  * the appropriate put-here operation on it, passing
  * this and x.  The new object is then returned. */
-inline BigInteger BigInteger::operator +(const BigInteger &x) const {
+inline BigInteger BigInteger::operator +(const BigInteger &x) BIGINT_CONST_LVALUE {
 	BigInteger ans;
 	ans.add(*this, x);
 	return ans;
 }
-inline BigInteger BigInteger::operator -(const BigInteger &x) const {
+inline BigInteger BigInteger::operator -(const BigInteger &x) BIGINT_CONST_LVALUE {
 	BigInteger ans;
 	ans.subtract(*this, x);
 	return ans;
@@ -156,26 +178,71 @@ inline BigInteger BigInteger::operator *(const BigInteger &x) const {
 	ans.multiply(*this, x);
 	return ans;
 }
-inline BigInteger BigInteger::operator /(const BigInteger &x) const {
+inline BigInteger BigInteger::operator /(const BigInteger &x) BIGINT_CONST_LVALUE {
 	if (x.isZero()) throw "BigInteger::operator /: division by zero";
 	BigInteger q, r;
 	r = *this;
 	r.divideWithRemainder(x, q);
 	return q;
 }
-inline BigInteger BigInteger::operator %(const BigInteger &x) const {
+inline BigInteger BigInteger::operator %(const BigInteger &x) BIGINT_CONST_LVALUE {
 	if (x.isZero()) throw "BigInteger::operator %: division by zero";
 	BigInteger q, r;
 	r = *this;
 	r.divideWithRemainder(x, q);
 	return r;
 }
-inline BigInteger BigInteger::operator -() const {
+inline BigInteger BigInteger::operator -() BIGINT_CONST_LVALUE {
 	BigInteger ans;
 	ans.negate(*this);
 	return ans;
 }
 
+#if __cplusplus >= 201103L
+/* An operand about to die receives the result itself; see the same
+ * operators in BigUnsigned.hh. */
+inline BigInteger BigInteger::operator +(const BigInteger &x) && {
+	add(*this, x);
+	return std::move(*this);
+}
+inline BigInteger BigInteger::operator +(BigInteger &&x) const & {
+	x.add(*this, x);
+	return std::move(x);
+}
+inline BigInteger BigInteger::operator +(BigInteger &&x) && {
+	add(*this, x);
+	return std::move(*this);
+}
+inline BigInteger BigInteger::operator -(const BigInteger &x) && {
+	subtract(*this, x);
+	return std::move(*this);
+}
+inline BigInteger BigInteger::operator -(BigInteger &&x) const & {
+	x.subtract(*this, x);
+	return std::move(x);
+}
+inline BigInteger BigInteger::operator -(BigInteger &&x) && {
+	subtract(*this, x);
+	return std::move(*this);
+}
+inline BigInteger BigInteger::operator /(const BigInteger &x) && {
+	if (x.isZero()) throw "BigInteger::operator /: division by zero";
+	BigInteger q;
+	divideWithRemainder(x, q);
+	return q;
+}
+inline BigInteger BigInteger::operator %(const BigInteger &x) && {
+	if (x.isZero()) throw "BigInteger::operator %: division by zero";
+	BigInteger q;
+	divideWithRemainder(x, q);
+	return std::move(*this);
+}
+inline BigInteger BigInteger::operator -() && {
+	flipSign();
+	return std::move(*this);
+}
+#endif
+
 /*
  * ASSIGNMENT OPERATORS
  * 
@@ -199,7 +266,7 @@ inline void BigInteger::operator /=(const BigInteger &x) {
 	BigInteger q;
 	divideWithRemainder(x, q);
 	// *this contains the remainder, but we overwrite it with the quotient.
-	*this = q;
+	*this = BIGINT_MOVE(q);
 }
 inline void BigInteger::operator %=(const BigInteger &x) {
 	if (x.isZero()) throw "BigInteger::operator %=: division by zero";
@@ -50,21 +50,456 @@ BigUnsigned modinv(const BigInteger &x, const BigUnsigned &n) {
 		throw "BigInteger modinv: x and n have a common factor";
 }
 
+/*
+ * Modular exponentiation.
+ *
+ * `modexp' used to square and multiply with a full `%' after every step,
+ * which costs a long division per bit of the exponent.  It now works on
+ * bare block arrays as long as the modulus `m', n blocks of base B = 2^N,
+ * and reduces each product without dividing:
+ *
+ * - An odd modulus uses Montgomery's representation (``Modular
+ *   multiplication without trial division'', 1985): x is held as x R mod m
+ *   with R = B^n, and a double-length product is brought back by adding
+ *   the multiple of m that clears its low n blocks and dropping them.
+ *
+ * - An even modulus has no inverse modulo B, so it uses Barrett's reduction
+ *   (Handbook of Applied Cryptography, 14.42): the quotient by m is
+ *   estimated from the top blocks of the product and the precomputed
+ *   floor(B^2n / m), and is at most three too small.
+ *
+ * The two provide the same operations, so one template drives both through
+ * left-to-right sliding-window exponentiation (HAC 14.85): with a table of
+ * the odd powers up to x^(2^k - 1), each run of up to k bits ending in a 1
+ * costs one multiplication, and runs of zeros cost none.
+ *
+ * `modexpConstantTime' uses fixed windows over a zero-padded exponent
+ * instead, reads every table entry to fetch one, and reduces without
+ * branching, so nothing it does depends on the bits of the exponent.
+ */
+
+namespace {
+	typedef BigUnsigned::Blk Blk;
+	typedef BigUnsigned::Index Index;
+
+	// The two-block product of two blocks, as in BigUnsigned.cc.
+#ifdef __SIZEOF_INT128__
+	__extension__ typedef unsigned __int128 DoubleBlk;
+#else
+	typedef unsigned long long DoubleBlk;
+#endif
+
+	// r[0..n) = the low n blocks of x
+	void loadBlocks(Blk *r, Index n, const BigUnsigned &x) {
+		for (Index i = 0; i < n; i++)
+			r[i] = x.getBlock(i);
+	}
+
+	/* The products here are formed a column at a time (``product
+	 * scanning''): all the block products of one weight go into a
+	 * three-block accumulator before that column's block comes out.
+	 * Unlike a row at a time, no carry has to go through memory, and
+	 * consecutive products are independent of each other. */
+	struct Accumulator {
+		DoubleBlk low;
+		Blk high;
+
+		Accumulator() : low(0), high(0) {}
+		void add(Blk x, Blk y) {
+			DoubleBlk p = DoubleBlk(x) * y;
+			low += p;
+			high += Blk(low < p);
+		}
+		void add(const Accumulator &x) {
+			low += x.low;
+			high += x.high + Blk(low < x.low);
+		}
+		void twice() {
+			high = (high << 1) | Blk(low >> (2 * BigUnsigned::N - 1));
+			low <<= 1;
+		}
+		// Takes out the lowest block, moving the others down.
+		Blk shift() {
+			Blk b = Blk(low);
+			low = (low >> BigUnsigned::N)
+				| (DoubleBlk(high) << BigUnsigned::N);
+			high = 0;
+			return b;
+		}
+	};
+
+	/* Adds to `c' column k of a[0..n)^2: the products a[j] a[k-j] with
+	 * j < k - j, doubled, and a[k/2]^2 for even k. */
+	void addSquareColumn(Accumulator &c, const Blk *a, Index n, Index k) {
+		Accumulator cross;
+		for (Index j = (k >= n) ? k - n + 1 : 0; 2 * j < k; j++)
+			cross.add(a[j], a[k - j]);
+		cross.twice();
+		if (k % 2 == 0)
+			cross.add(a[k / 2], a[k / 2]);
+		c.add(cross);
+	}
+
+	/* r[0..to-from) = columns `from' up to `to' of a[0..an) * b[0..bn),
+	 * without the carries out of the columns below `from'; that is, the
+	 * whole product for 0 and an + bn.  `r' may not overlap `a' or `b'. */
+	void multiplyBlocks(Blk *r, const Blk *a, Index an,
+			const Blk *b, Index bn, Index from, Index to) {
+		Accumulator c;
+		for (Index k = from; k < to; k++) {
+			Index last = (k < an) ? k : an - 1;
+			for (Index j = (k >= bn) ? k - bn + 1 : 0; j <= last; j++)
+				c.add(a[j], b[k - j]);
+			r[k - from] = c.shift();
+		}
+	}
+
+	// r[0..2n) = a[0..n)^2; `r' may not overlap `a'.
+	void squareBlocks(Blk *r, const Blk *a, Index n) {
+		Accumulator c;
+		for (Index k = 0; k < 2 * n; k++) {
+			addSquareColumn(c, a, n, k);
+			r[k] = c.shift();
+		}
+	}
+
+	/* Montgomery arithmetic modulo an odd n-block `m'.  Values are kept
+	 * below m.  Nothing branches on the values, so the constant-time
+	 * exponentiation can use this too.
+	 *
+	 * The reduction is interleaved with the product column by column
+	 * (Koc, Acar and Kaliski's ``finely integrated product scanning''):
+	 * once column i of a b + u m is complete below block n, the u[i]
+	 * that clears it is known, and its products join the later columns.
+	 * The u[i] are kept in `t', and the top half of the sum, below 2m,
+	 * lands in the upper half of `t'. */
+	struct Montgomery {
+		Index n;
+		Blk mInv; // -1/m modulo B
+		NumberlikeArray<Blk> m, oneR, r2, unit; // m, R, R^2 mod m, and 1
+		mutable NumberlikeArray<Blk> t;
+
+		Montgomery(const BigUnsigned &modulus) : n(modulus.getLength()),
+				m(n), oneR(n), r2(n), unit(n), t(2 * n) {
+			loadBlocks(m.blk, n, modulus);
+			// Each Newton step doubles the correct low bits of 1/m, from 3.
+			Blk inv = m.blk[0];
+			for (int i = 0; i < 5; i++)
+				inv *= 2 - m.blk[0] * inv;
+			mInv = 0 - inv;
+			BigUnsigned rModM = (BigUnsigned(1) << int(n * BigUnsigned::N))
+				% modulus;
+			loadBlocks(oneR.blk, n, rModM);
+			loadBlocks(r2.blk, n, rModM * rModM % modulus);
+			loadBlocks(unit.blk, n, 1);
+		}
+
+		Index length() const { return n; }
+
+		// Column i < n is complete: pick u[i] to clear it and shift.
+		void clearColumn(Accumulator &c, Index i) const {
+			const Blk *mb = m.blk;
+			Blk *u = t.blk;
+			for (Index j = 0; j < i; j++)
+				c.add(u[j], mb[i - j]);
+			u[i] = Blk(c.low) * mInv;
+			c.add(u[i], mb[0]);
+			c.shift();
+		}
+		// Column i >= n: add the u products and take the block out.
+		void finishColumn(Accumulator &c, Index i) const {
+			const Blk *mb = m.blk;
+			Blk *u = t.blk;
+			for (Index j = i - n + 1; j < n; j++)
+				c.add(u[j], mb[i - j]);
+			u[i] = c.shift();
+		}
+		/* r[0..n) = t[n..2n) plus the block `extra' above it, which is
+		 * below 2m, less m if that is not negative.  The subtraction is
+		 * always done and then kept or dropped by a mask. */
+		void subtractModulus(Blk *r, Blk extra) const {
+			const Blk *tb = t.blk + n, *mb = m.blk;
+			Blk borrow = 0;
+			for (Index j = 0; j < n; j++) {
+				Blk x = tb[j], y = mb[j];
+				r[j] = x - y - borrow;
+				borrow = Blk(x < y) | (Blk(x == y) & borrow);
+			}
+			Blk keep = 0 - (extra | (borrow ^ 1));
+			for (Index j = 0; j < n; j++)
+				r[j] = (r[j] & keep) | (tb[j] & ~keep);
+		}
+
+		// r[0..n) = a b / R mod m; `r' may be `a' or `b'.
+		void multiply(Blk *r, const Blk *a, const Blk *b) const {
+			Accumulator c;
+			for (Index i = 0; i < n; i++) {
+				for (Index j = 0; j <= i; j++)
+					c.add(a[j], b[i - j]);
+				clearColumn(c, i);
+			}
+			for (Index i = n; i < 2 * n; i++) {
+				for (Index j = i - n + 1; j < n; j++)
+					c.add(a[j], b[i - j]);
+				finishColumn(c, i);
+			}
+			subtractModulus(r, Blk(c.low));
+		}
+		// r[0..n) = a^2 / R mod m; `r' may be `a'.
+		void square(Blk *r, const Blk *a) const {
+			Accumulator c;
+			for (Index i = 0; i < n; i++) {
+				addSquareColumn(c, a, n, i);
+				clearColumn(c, i);
+			}
+			for (Index i = n; i < 2 * n; i++) {
+				addSquareColumn(c, a, n, i);
+				finishColumn(c, i);
+			}
+			subtractModulus(r, Blk(c.low));
+		}
+		// Into Montgomery form, x < m: x R = x R^2 / R.
+		void enter(Blk *r, const BigUnsigned &x) const {
+			loadBlocks(r, n, x);
+			multiply(r, r, r2.blk);
+		}
+		void one(Blk *r) const {
+			for (Index i = 0; i < n; i++)
+				r[i] = oneR.blk[i];
+		}
+		// Out of Montgomery form: a R / R.
+		BigUnsigned leave(const Blk *a) const {
+			NumberlikeArray<Blk> r(n);
+			multiply(r.blk, a, unit.blk);
+			return BigUnsigned(r.blk, n);
+		}
+	};
+
+	// Barrett arithmetic modulo an n-block `m', on values below m.
+	struct Barrett {
+		Index n, muLen;
+		NumberlikeArray<Blk> m, mu; // m and floor(B^2n / m)
+		mutable NumberlikeArray<Blk> t, q;
+
+		Barrett(const BigUnsigned &modulus) : n(modulus.getLength()),
+				m(n) {
+			loadBlocks(m.blk, n, modulus);
+			// Between B^n and B^(n+1) inclusive: n + 1 or n + 2 blocks.
+			BigUnsigned mu0 = (BigUnsigned(1) << int(2 * n * BigUnsigned::N))
+				/ modulus;
+			muLen = mu0.getLength();
+			mu.allocate(muLen);
+			loadBlocks(mu.blk, muLen, mu0);
+			t.allocate(2 * n);
+			// The top of q1 mu, then the low blocks of q3 m
+			q.allocate(muLen + 2 + n + 1);
+		}
+
+		Index length() const { return n; }
+
+		/* r[0..n) = t[0..2n) mod m, for t < m^2.  q3, the top blocks of
+		 * (t / B^(n-1)) mu / B^(n+1), is at most two below t / m, and
+		 * at most three when, as here, the columns of that product below
+		 * block n - 1 are left out (HAC 14.44).  So t - q3 m is below 4m
+		 * and fits in n + 1 blocks: it can be computed modulo B^(n+1),
+		 * from the low blocks alone. */
+		void reduce(Blk *r) const {
+			Blk *tb = t.blk, *qb = q.blk;
+			const Blk *mb = m.blk;
+			multiplyBlocks(qb, tb + n - 1, n + 1, mu.blk, muLen, n - 1,
+				n + 1 + muLen);
+			Blk *q3 = qb + 2;
+			// The low blocks of q3 m go after q3.
+			Blk *p = q3 + n + 1;
+			multiplyBlocks(p, q3, n + 1, mb, n, 0, n + 1);
+			Blk borrow = 0;
+			for (Index i = 0; i <= n; i++) {
+				Blk x = tb[i], y = p[i];
+				tb[i] = x - y - borrow;
+				borrow = (x < y || (x == y && borrow)) ? 1 : 0;
+			}
+			// At most three subtractions of m.
+			for (;;) {
+				if (tb[n] == 0) {
+					Index i = n;
+					while (i > 0 && tb[i - 1] == mb[i - 1])
+						i--;
+					if (i > 0 && tb[i - 1] < mb[i - 1])
+						break;
+				}
+				borrow = 0;
+				for (Index i = 0; i < n; i++) {
+					Blk x = tb[i], y = mb[i];
+					tb[i] = x - y - borrow;
+					borrow = (x < y || (x == y && borrow)) ? 1 : 0;
+				}
+				tb[n] -= borrow;
+			}
+			for (Index i = 0; i < n; i++)
+				r[i] = tb[i];
+		}
+
+		void multiply(Blk *r, const Blk *a, const Blk *b) const {
+			multiplyBlocks(t.blk, a, n, b, n, 0, 2 * n);
+			reduce(r);
+		}
+		void square(Blk *r, const Blk *a) const {
+			squareBlocks(t.blk, a, n);
+			reduce(r);
+		}
+		void enter(Blk *r, const BigUnsigned &x) const {
+			loadBlocks(r, n, x);
+		}
+		void one(Blk *r) const {
+			// 1 mod m, which is 0 for m == 1
+			r[0] = (n == 1 && m.blk[0] == 1) ? 0 : 1;
+			for (Index i = 1; i < n; i++)
+				r[i] = 0;
+		}
+		BigUnsigned leave(const Blk *a) const {
+			return BigUnsigned(a, n);
+		}
+	};
+
+	/* The window width for a `bits'-bit exponent.  A table of 2^(k-1) odd
+	 * powers plus about bits / (k + 1) multiplications is least for k up
+	 * to these sizes. */
+	unsigned int windowBits(Index bits) {
+		return bits > 671 ? 6 : bits > 239 ? 5 : bits > 79 ? 4
+			: bits > 23 ? 3 : bits > 6 ? 2 : 1;
+	}
+
+	// x^e in the domain `d', x below the modulus
+	template <class Domain>
+	BigUnsigned slidingWindowPower(const Domain &d, const BigUnsigned &x,
+			const BigUnsigned &e) {
+		Index n = d.length(), bits = e.bitLength();
+		unsigned int k = windowBits(bits);
+		Index odd = Index(1) << (k - 1);
+		// x, x^3, ..., x^(2^k - 1), then x^2 and the running power
+		NumberlikeArray<Blk> table((odd + 2) * n);
+		Blk *x2 = table.blk + odd * n, *acc = x2 + n;
+		d.enter(table.blk, x);
+		d.square(x2, table.blk);
+		for (Index i = 1; i < odd; i++)
+			d.multiply(table.blk + i * n, table.blk + (i - 1) * n, x2);
+
+		d.one(acc);
+		bool started = false;
+		for (Index i = bits; i > 0; ) {
+			i--;
+			if (!e.getBit(i)) {
+				if (started)
+					d.square(acc, acc);
+				continue;
+			}
+			// The longest run of up to k bits from bit i down ending in a 1
+			Index low = (i + 1 >= k) ? i + 1 - k : 0;
+			while (!e.getBit(low))
+				low++;
+			Index w = 0;
+			for (Index j = i + 1; j > low; ) {
+				j--;
+				w = (w << 1) | (e.getBit(j) ? 1 : 0);
+			}
+			const Blk *power = table.blk + (w >> 1) * n;
+			if (started) {
+				for (Index j = low; j <= i; j++)
+					d.square(acc, acc);
+				d.multiply(acc, acc, power);
+			} else {
+				for (Index j = 0; j < n; j++)
+					acc[j] = power[j];
+				started = true;
+			}
+			i = low;
+		}
+		return d.leave(acc);
+	}
+
+	// Bits [pos, pos + k) of e[], k < N; the test depends on pos only.
+	Blk windowAt(const Blk *e, Index pos, unsigned int k) {
+		const unsigned int N = BigUnsigned::N;
+		Index i = pos / N;
+		unsigned int s = pos % N;
+		Blk w = e[i] >> s;
+		if (s + k > N)
+			w |= e[i + 1] << (N - s);
+		return w & ((Blk(1) << k) - 1);
+	}
+
+	/* r[0..n) = entry w of the `count' entries of `table', read through
+	 * masks from every entry so that the memory touched is the same for
+	 * every w. */
+	void selectEntry(Blk *r, const Blk *table, Index count, Index n, Blk w) {
+		for (Index j = 0; j < n; j++)
+			r[j] = 0;
+		for (Index i = 0; i < count; i++) {
+			// All ones if i == w, else zero
+			Blk diff = Blk(i) ^ w;
+			Blk mask = ((diff | (0 - diff)) >> (BigUnsigned::N - 1)) - 1;
+			for (Index j = 0; j < n; j++)
+				r[j] |= table[i * n + j] & mask;
+		}
+	}
+}
+
 BigUnsigned modexp(const BigInteger &base, const BigUnsigned &exponent,
 		const BigUnsigned &modulus) {
-	BigUnsigned ans = 1, base2 = (base % modulus).getMagnitude();
-	BigUnsigned::Index i = exponent.bitLength();
-	// For each bit of the exponent, most to least significant...
-	while (i > 0) {
-		i--;
-		// Square.
-		ans *= ans;
-		ans %= modulus;
-		// And multiply if the bit is a 1.
-		if (exponent.getBit(i)) {
-			ans *= base2;
-			ans %= modulus;
+	BigUnsigned x = (base % modulus).getMagnitude();
+	if (modulus.isZero()) {
+		// Nothing to reduce by: the plain power, as x % 0 == x.
+		BigUnsigned ans = 1;
+		for (Index i = exponent.bitLength(); i > 0; ) {
+			i--;
+			ans *= ans;
+			if (exponent.getBit(i))
+				ans *= x;
 		}
+		return ans;
+	}
+	if (modulus.getBit(0))
+		return slidingWindowPower(Montgomery(modulus), x, exponent);
+	else
+		return slidingWindowPower(Barrett(modulus), x, exponent);
+}
+
+BigUnsigned modexpConstantTime(const BigInteger &base,
+		const BigUnsigned &exponent, const BigUnsigned &modulus) {
+	if (!modulus.getBit(0))
+		throw "BigInteger modexpConstantTime: The modulus must be odd";
+	const unsigned int N = BigUnsigned::N;
+	Montgomery d(modulus);
+	Index n = d.length();
+
+	/* The exponent, zero-padded to at least the modulus's length and to
+	 * a whole number of windows, plus a block for `windowAt'. */
+	Index eLen = exponent.getLength();
+	Index bits = ((eLen > n) ? eLen : n) * N;
+	unsigned int k = windowBits(bits);
+	bits = (bits + k - 1) / k * k;
+	Index eBlocks = (bits + N - 1) / N + 1;
+	NumberlikeArray<Blk> e(eBlocks);
+	loadBlocks(e.blk, eBlocks, exponent);
+
+	// x^0 through x^(2^k - 1), then the running power and a fetched entry
+	Index count = Index(1) << k;
+	NumberlikeArray<Blk> table((count + 2) * n);
+	Blk *acc = table.blk + count * n, *power = acc + n;
+	d.one(table.blk);
+	d.enter(table.blk + n, (base % modulus).getMagnitude());
+	for (Index i = 2; i < count; i++)
+		d.multiply(table.blk + i * n, table.blk + (i - 1) * n,
+			table.blk + n);
+
+	Index pos = bits - k;
+	selectEntry(acc, table.blk, count, n, windowAt(e.blk, pos, k));
+	while (pos > 0) {
+		pos -= k;
+		for (unsigned int j = 0; j < k; j++)
+			d.square(acc, acc);
+		selectEntry(power, table.blk, count, n, windowAt(e.blk, pos, k));
+		d.multiply(acc, acc, power);
 	}
-	return ans;
+	return d.leave(acc);
 }
@@ -18,8 +18,18 @@ void extendedEuclidean(BigInteger m, BigInteger n,
  * they have a common factor. */
 BigUnsigned modinv(const BigInteger &x, const BigUnsigned &n);
 
-// Returns (base ^ exponent) % modulus.
+/* Returns (base ^ exponent) % modulus.  An odd modulus works in Montgomery
+ * form and an even one with Barrett reduction; either way the exponent is
+ * scanned in sliding windows.  See BigIntegerAlgorithms.cc. */
 BigUnsigned modexp(const BigInteger &base, const BigUnsigned &exponent,
 		const BigUnsigned &modulus);
 
+/* The same for an odd modulus, throwing an exception for an even one, in
+ * time and with memory accesses that depend only on the lengths in blocks
+ * of the exponent and modulus, not on their bits: use it for secret
+ * exponents.  The base is reduced by an ordinary division, so it is not
+ * protected. */
+BigUnsigned modexpConstantTime(const BigInteger &base,
+		const BigUnsigned &exponent, const BigUnsigned &modulus);
+
 #endif
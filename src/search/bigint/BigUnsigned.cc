@@ -115,14 +115,17 @@ BigUnsigned::CmpRes BigUnsigned::compareTo(const BigUnsigned &x) const {
 	if (cond) { \
 		BigUnsigned tmpThis; \
 		tmpThis.op; \
-		*this = tmpThis; \
+		*this = BIGINT_MOVE(tmpThis); \
 		return; \
 	}
 
 
 
+/* `add' and `subtract' handle aliased calls without a copy: each block of
+ * the result is written after the same blocks of the operands are read, so
+ * all they need is to keep the blocks of an operand that is *this when
+ * they make room. */
 void BigUnsigned::add(const BigUnsigned &a, const BigUnsigned &b) {
-	DTRT_ALIASED(this == &a || this == &b, add(a, b));
 	// If one argument is zero, copy the other.
 	if (a.len == 0) {
 		operator =(b);
@@ -145,11 +148,16 @@ void BigUnsigned::add(const BigUnsigned &a, const BigUnsigned &b) {
 		a2 = &b;
 		b2 = &a;
 	}
-	// Set prelimiary length and make room in this BigUnsigned
-	len = a2->len + 1;
-	allocate(len);
+	// The input lengths, which setting ours may change
+	Index an = a2->len, bn = b2->len;
+	// Make room in this BigUnsigned and set prelimiary length
+	if (this == a2 || this == b2)
+		allocateAndCopy(an + 1);
+	else
+		allocate(an + 1);
+	len = an + 1;
 	// For each block index that is present in both inputs...
-	for (i = 0, carryIn = false; i < b2->len; i++) {
+	for (i = 0, carryIn = false; i < bn; i++) {
 		// Add input blocks
 		temp = a2->blk[i] + b2->blk[i];
 		// If a rollover occurred, the result is less than either input.
@@ -165,15 +173,16 @@ void BigUnsigned::add(const BigUnsigned &a, const BigUnsigned &b) {
 	}
 	// If there is a carry left over, increase blocks until
 	// one does not roll over.
-	for (; i < a2->len && carryIn; i++) {
+	for (; i < an && carryIn; i++) {
 		temp = a2->blk[i] + 1;
 		carryIn = (temp == 0);
 		blk[i] = temp;
 	}
 	// If the carry was resolved but the larger number
-	// still has blocks, copy them over.
-	for (; i < a2->len; i++)
-		blk[i] = a2->blk[i];
+	// still has blocks, copy them over (unless they are already here).
+	if (this != a2)
+		for (; i < an; i++)
+			blk[i] = a2->blk[i];
 	// Set the extra block if there's still a carry, decrease length otherwise
 	if (carryIn)
 		blk[i] = 1;
@@ -182,7 +191,6 @@ void BigUnsigned::add(const BigUnsigned &a, const BigUnsigned &b) {
 }
 
 void BigUnsigned::subtract(const BigUnsigned &a, const BigUnsigned &b) {
-	DTRT_ALIASED(this == &a || this == &b, subtract(a, b));
 	if (b.len == 0) {
 		// If b is zero, copy a.
 		operator =(a);
@@ -191,15 +199,24 @@ void BigUnsigned::subtract(const BigUnsigned &a, const BigUnsigned &b) {
 		// If a is shorter than b, the result is negative.
 		throw "BigUnsigned::subtract: "
 			"Negative result in unsigned calculation";
+	/* An aliased call must not lose its operand to the exception below,
+	 * so it checks first; a negative result needs a.len == b.len. */
+	if ((this == &a || this == &b) && a.len == b.len && a.compareTo(b) == less)
+		throw "BigUnsigned::subtract: Negative result in unsigned calculation";
 	// Some variables...
 	bool borrowIn, borrowOut;
 	Blk temp;
 	Index i;
-	// Set preliminary length and make room
-	len = a.len;
-	allocate(len);
+	// The input lengths, which setting ours may change
+	Index an = a.len, bn = b.len;
+	// Make room and set preliminary length
+	if (this == &b)
+		allocateAndCopy(an);
+	else
+		allocate(an);
+	len = an;
 	// For each block index that is present in both inputs...
-	for (i = 0, borrowIn = false; i < b.len; i++) {
+	for (i = 0, borrowIn = false; i < bn; i++) {
 		temp = a.blk[i] - b.blk[i];
 		// If a reverse rollover occurred,
 		// the result is greater than the block from a.
@@ -214,7 +231,7 @@ void BigUnsigned::subtract(const BigUnsigned &a, const BigUnsigned &b) {
 	}
 	// If there is a borrow left over, decrease blocks until
 	// one does not reverse rollover.
-	for (; i < a.len && borrowIn; i++) {
+	for (; i < an && borrowIn; i++) {
 		borrowIn = (a.blk[i] == 0);
 		blk[i] = a.blk[i] - 1;
 	}
@@ -224,9 +241,9 @@ void BigUnsigned::subtract(const BigUnsigned &a, const BigUnsigned &b) {
 	if (borrowIn) {
 		len = 0;
 		throw "BigUnsigned::subtract: Negative result in unsigned calculation";
-	} else
+	} else if (this != &a)
 		// Copy over the rest of the blocks
-		for (; i < a.len; i++)
+		for (; i < an; i++)
 			blk[i] = a.blk[i];
 	// Zap leading zeros
 	zapLeadingZeros();
@@ -265,11 +282,25 @@ void BigUnsigned::subtract(const BigUnsigned &a, const BigUnsigned &b) {
  * and subtraction rather than single-block multiplication and division,
  * the innermost loops of all four routines are very similar.  Study one
  * of them and all will become clear.
+ *
+ * Multiplication has since moved to Knuth's word-level algorithm: GCC and
+ * Clang expose `b_0' on 64-bit targets as `unsigned __int128', and a
+ * 32-bit Blk gets it from `unsigned long long'.  One block of `a' times
+ * all of `b' is a single pass instead of up to N shifted additions.  Large
+ * products use Karatsuba's and Toom's divide-and-conquer algorithms on top
+ * of that, and the largest a number-theoretic transform; see the
+ * multiplication engine below.
+ *
+ * Division has followed, as Knuth's Algorithm D; `c_0' comes from
+ * multiplying by a precomputed reciprocal, since dividing a `DoubleBlk'
+ * is a library call.  Long divisions recurse in the manner of Burnikel
+ * and Ziegler so that they ride on the fast multiplication; see the
+ * division engine below.
  */
 
 /*
- * This is a little inline function used by both the multiplication
- * routine and the division routine.
+ * This is a little inline function used by the shifts.  (The old
+ * multiplication and division routines used it too.)
  *
  * `getShiftedBlock' returns the `x'th block of `num << y'.
  * `y' may be anything from 0 to N - 1, and `x' may be anything from
@@ -297,84 +328,1016 @@ inline BigUnsigned::Blk getShiftedBlock(const BigUnsigned &num,
 	return part1 | part2;
 }
 
+/*
+ * The multiplication engine.
+ *
+ * These routines work on bare block arrays rather than on BigUnsigneds so
+ * that the recursive algorithms can multiply pieces of numbers in place.
+ * Each one stores the full `an + bn'-block product of an `an'-block number
+ * and a `bn'-block number, leading zeros and all.  Temporary blocks come from
+ * a single `scratch' array that `multiply' allocates up front; the
+ * `...Scratch' functions give the number of blocks each routine needs and
+ * must mirror the routines' choices of algorithm exactly.
+ */
+
+typedef BigUnsigned::Blk Blk;
+typedef BigUnsigned::Index Index;
+
+/* A type that holds the two-block product of two blocks: Knuth's `b_0'.
+ * GCC and Clang provide a 128-bit type on 64-bit targets; `__extension__'
+ * keeps -pedantic quiet about it.  Elsewhere Blk is 32 bits wide and
+ * `unsigned long long' is big enough, which the array size checks. */
+#ifdef __SIZEOF_INT128__
+__extension__ typedef unsigned __int128 DoubleBlk;
+#else
+typedef unsigned long long DoubleBlk;
+#endif
+typedef char DoubleBlkIsBigEnough[
+	(sizeof(DoubleBlk) >= 2 * sizeof(Blk)) ? 1 : -1];
+
+// The transform multiplication needs 64-bit blocks and 128-bit products.
+#if defined(__SIZEOF_INT128__) && __SIZEOF_LONG__ == 8
+#define BIGUNSIGNED_NTT
+#endif
+
+/* The thresholds, in blocks of the shorter operand.  The defaults come from
+ * the tuning mode of bigmul_bench on an x86-64 machine, where three runs
+ * put the crossovers at 20 to 34, 108 to 134 and 1536 to 1792 blocks. */
+Index BigUnsigned::karatsubaThreshold = 24;
+Index BigUnsigned::toom3Threshold = 128;
+Index BigUnsigned::nttThreshold = 1536;
+
+/* From the tuning mode of bigdiv_bench on the same machine, whose sweeps
+ * favoured 64 or 128 blocks; from 2K blocks on it hardly matters. */
+Index BigUnsigned::burnikelZieglerThreshold = 128;
+
+// Karatsuba needs two halves; Toom-3 needs three nonempty thirds.
+static bool belowKaratsuba(Index n) {
+	return n < 2 || n < BigUnsigned::karatsubaThreshold;
+}
+static bool belowToom3(Index n) {
+	return n < 5 || n < BigUnsigned::toom3Threshold;
+}
+
+// r[0..n) = a[0..n) + b[0..n); returns the carry.  `r' may be `a' or `b'.
+static Blk addBlocks(Blk *r, const Blk *a, const Blk *b, Index n) {
+	Blk carry = 0;
+	for (Index i = 0; i < n; i++) {
+		Blk s = a[i] + carry;
+		carry = (s < carry);
+		Blk t = s + b[i];
+		carry += (t < s);
+		r[i] = t;
+	}
+	return carry;
+}
+
+// r[0..n) = a[0..n) - b[0..n); returns the borrow.  `r' may be `a' or `b'.
+static Blk subtractBlocks(Blk *r, const Blk *a, const Blk *b, Index n) {
+	Blk borrow = 0;
+	for (Index i = 0; i < n; i++) {
+		Blk d = a[i] - b[i];
+		Blk borrowOut = (a[i] < b[i]);
+		borrowOut |= (d < borrow);
+		r[i] = d - borrow;
+		borrow = borrowOut;
+	}
+	return borrow;
+}
+
+/* r[0..xn) = x[0..xn) + y[0..yn), where yn <= xn; returns the carry.
+ * `r' may be `x'. */
+static Blk addUnequal(Blk *r, const Blk *x, Index xn,
+		const Blk *y, Index yn) {
+	Blk carry = addBlocks(r, x, y, yn);
+	for (Index i = yn; i < xn; i++) {
+		r[i] = x[i] + carry;
+		carry = (r[i] < carry);
+	}
+	return carry;
+}
+
+/* r[0..xn) = x[0..xn) - y[0..yn), where yn <= xn; returns the borrow.
+ * `r' may be `x'. */
+static Blk subtractUnequal(Blk *r, const Blk *x, Index xn,
+		const Blk *y, Index yn) {
+	Blk borrow = subtractBlocks(r, x, y, yn);
+	for (Index i = yn; i < xn; i++) {
+		Blk t = x[i];
+		r[i] = t - borrow;
+		borrow = (t < borrow);
+	}
+	return borrow;
+}
+
+// Adds the small value `x' to r[0..n), carrying as far as necessary.
+static void addBlockAt(Blk *r, Index n, Blk x) {
+	for (Index i = 0; x != 0 && i < n; i++) {
+		r[i] += x;
+		x = (r[i] < x);
+	}
+}
+
+// Subtracts the small value `x' from r[0..n), borrowing as necessary.
+static void subtractBlockAt(Blk *r, Index n, Blk x) {
+	for (Index i = 0; x != 0 && i < n; i++) {
+		Blk t = r[i];
+		r[i] = t - x;
+		x = (t < x);
+	}
+}
+
+/* Adds x[0..xn) into r[0..rn).  Blocks of `x' past `rn', and any carry out
+ * of `r', must be zero, as they are when the sum is known to fit. */
+static void addInto(Blk *r, Index rn, const Blk *x, Index xn) {
+	if (xn > rn)
+		xn = rn;
+	addBlockAt(r + xn, rn - xn, addBlocks(r, r, x, xn));
+}
+
+// Replaces r[0..n) by its two's complement negation.
+static void negateBlocks(Blk *r, Index n) {
+	Blk carry = 1;
+	for (Index i = 0; i < n; i++) {
+		r[i] = ~r[i] + carry;
+		carry = (carry != 0 && r[i] == 0);
+	}
+}
+
+/* r[0..xn) = |x[0..xn) - y[0..yn)|, where yn <= xn; returns whether
+ * y > x.  `r' may be `x'. */
+static bool subtractAbsolute(Blk *r, const Blk *x, Index xn,
+		const Blk *y, Index yn) {
+	if (subtractUnequal(r, x, xn, y, yn) == 0)
+		return false;
+	negateBlocks(r, xn);
+	return true;
+}
+
+// Shifts the nonnegative r[0..n) right by one bit.
+static void shiftRightOne(Blk *r, Index n) {
+	for (Index i = 0; i + 1 < n; i++)
+		r[i] = (r[i] >> 1) | (r[i + 1] << (BigUnsigned::N - 1));
+	r[n - 1] >>= 1;
+}
+
+/* Divides r[0..n) by 3, which must divide it exactly, by multiplying each
+ * block by the inverse of 3 modulo 2^N and carrying the high part of the
+ * quotient block times 3 into the next block.  Working modulo 2^(N*n), it
+ * also divides two's complement negative numbers correctly. */
+static void divideExactBy3(Blk *r, Index n) {
+	const Blk inverse = (~Blk(0) / 3) * 2 + 1;
+	Blk borrow = 0;
+	for (Index i = 0; i < n; i++) {
+		Blk x = r[i];
+		Blk s = x - borrow;
+		Blk borrowOut = (x < borrow);
+		Blk q = s * inverse;
+		r[i] = q;
+		borrow = Blk((DoubleBlk(q) * 3) >> BigUnsigned::N) + borrowOut;
+	}
+}
+
+// r[0..n) = a[0..n) * m; returns the high block.
+static Blk multiplyBlock(Blk *r, const Blk *a, Index n, Blk m) {
+	Blk carry = 0;
+	for (Index i = 0; i < n; i++) {
+		DoubleBlk t = DoubleBlk(a[i]) * m + carry;
+		r[i] = Blk(t);
+		carry = Blk(t >> BigUnsigned::N);
+	}
+	return carry;
+}
+
+/* r[0..n) += a[0..n) * m; returns the high block.  The sum in `t' cannot
+ * overflow: (2^N - 1)^2 + 2 (2^N - 1) = 2^(2N) - 1. */
+static Blk multiplyAddBlock(Blk *r, const Blk *a, Index n, Blk m) {
+	Blk carry = 0;
+	for (Index i = 0; i < n; i++) {
+		DoubleBlk t = DoubleBlk(a[i]) * m + r[i] + carry;
+		r[i] = Blk(t);
+		carry = Blk(t >> BigUnsigned::N);
+	}
+	return carry;
+}
+
+// r[0..n) -= a[0..n) * m; returns the block to borrow from r[n].
+static Blk multiplySubtractBlock(Blk *r, const Blk *a, Index n, Blk m) {
+	Blk borrow = 0;
+	for (Index i = 0; i < n; i++) {
+		DoubleBlk t = DoubleBlk(a[i]) * m + borrow;
+		Blk low = Blk(t);
+		borrow = Blk(t >> BigUnsigned::N) + (r[i] < low);
+		r[i] -= low;
+	}
+	return borrow;
+}
+
+/* Schoolbook multiplication, an >= bn >= 1.  Each block of `b' costs one
+ * pass of `multiplyAddBlock' over `a'. */
+static void multiplySchoolbook(Blk *r, const Blk *a, Index an,
+		const Blk *b, Index bn) {
+	r[an] = multiplyBlock(r, a, an, b[0]);
+	for (Index j = 1; j < bn; j++)
+		r[an + j] = multiplyAddBlock(r + j, a, an, b[j]);
+}
+
+static void multiplyBalanced(Blk *r, const Blk *a, const Blk *b, Index n,
+		Blk *scratch);
+
+static Index balancedScratch(Index n) {
+	if (belowKaratsuba(n))
+		return 0;
+	if (belowToom3(n)) {
+		Index h = n - n / 2;
+		return 2 * h + balancedScratch(h);
+	}
+	Index m = (n + 2) / 3 + 1;
+	return 10 * m + balancedScratch(m);
+}
+
+/*
+ * Karatsuba multiplication of two n-block numbers.  With h = ceil(n/2),
+ * a = a0 + a1 B^h and b = b0 + b1 B^h, where B = 2^N, the product is
+ *
+ *    a0 b0 + (a0 b0 + a1 b1 - (a0 - a1)(b0 - b1)) B^h + a1 b1 B^(2h),
+ *
+ * three half-size products instead of four.  The differences are taken as
+ * absolute values with separate signs so that all three products are of
+ * nonnegative numbers.
+ */
+static void multiplyKaratsuba(Blk *r, const Blk *a, const Blk *b, Index n,
+		Blk *scratch) {
+	Index h = n - n / 2, l = n / 2;
+	const Blk *a1 = a + h, *b1 = b + h;
+	Blk *middle = scratch, *rest = scratch + 2 * h;
+	// The differences borrow the low half of r until z0 lands there.
+	bool negative = subtractAbsolute(r, a, h, a1, l)
+		!= subtractAbsolute(r + h, b, h, b1, l);
+	multiplyBalanced(middle, r, r + h, h, rest);
+	multiplyBalanced(r, a, b, h, rest);
+	multiplyBalanced(r + 2 * h, a1, b1, l, rest);
+	// middle = z0 + z2 -/+ |a0 - a1| |b0 - b1|, tracking its top block.
+	Blk carry = 0, borrow = 0;
+	if (negative)
+		carry = addBlocks(middle, r, middle, 2 * h);
+	else
+		borrow = subtractBlocks(middle, r, middle, 2 * h);
+	carry += addUnequal(middle, middle, 2 * h, r + 2 * h, 2 * l);
+	carry += addBlocks(r + h, r + h, middle, 2 * h);
+	// The true middle term is nonnegative, so this settles in range.
+	if (carry >= borrow)
+		addBlockAt(r + 3 * h, 2 * n - 3 * h, carry - borrow);
+	else
+		subtractBlockAt(r + 3 * h, 2 * n - 3 * h, borrow - carry);
+}
+
+/*
+ * Toom-3 multiplication of two n-block numbers.  With k = ceil(n/3), each
+ * operand is split into thirds, a = a0 + a1 X + a2 X^2 with X = B^k and a2
+ * of s = n - 2k blocks, and the degree-4 product polynomial
+ * c0 + c1 X + c2 X^2 + c3 X^3 + c4 X^4 is recovered from its values at
+ * 0, 1, -1, 2 and infinity:
+ *
+ *    c0 = v0,  c4 = vinf,
+ *    c1 + c3 = (v1 - vm1) / 2,
+ *    c2 = (v1 + vm1) / 2 - v0 - vinf,
+ *    3 c3 = (v2 - v0 - 4 c2 - 16 vinf) / 2 - (c1 + c3).
+ *
+ * The evaluations at 1, -1 and 2 fit in m = k + 1 blocks, so five
+ * products of about n/3 blocks replace nine.  The interpolation runs on
+ * L = 2m-block numbers modulo B^L, which holds vm1's two's complement and
+ * lets the exact division by 3 ignore signs.
+ */
+static void multiplyToom3(Blk *r, const Blk *a, const Blk *b, Index n,
+		Blk *scratch) {
+	Index k = (n + 2) / 3, s = n - 2 * k, m = k + 1, L = 2 * m;
+	const Blk *a1 = a + k, *a2 = a + 2 * k;
+	const Blk *b1 = b + k, *b2 = b + 2 * k;
+	Blk *p = scratch, *q = p + m;
+	Blk *v1 = q + m, *vm1 = v1 + L, *v2 = vm1 + L, *t = v2 + L;
+	Blk *rest = t + L;
+	Index i;
+
+	// v1 and vm1 from a0 + a2 +/- a1
+	p[k] = addUnequal(p, a, k, a2, s);
+	q[k] = addUnequal(q, b, k, b2, s);
+	bool negative = subtractAbsolute(t, p, m, a1, k)
+		!= subtractAbsolute(t + m, q, m, b1, k);
+	p[k] += addBlocks(p, p, a1, k);
+	q[k] += addBlocks(q, q, b1, k);
+	multiplyBalanced(v1, p, q, m, rest);
+	multiplyBalanced(vm1, t, t + m, m, rest);
+	if (negative)
+		negateBlocks(vm1, L);
+
+	// v2 from a0 + 2 a1 + 4 a2
+	for (i = 0; i < k; i++) {
+		p[i] = a[i];
+		q[i] = b[i];
+	}
+	p[k] = multiplyAddBlock(p, a1, k, 2);
+	q[k] = multiplyAddBlock(q, b1, k, 2);
+	addBlockAt(p + s, m - s, multiplyAddBlock(p, a2, s, 4));
+	addBlockAt(q + s, m - s, multiplyAddBlock(q, b2, s, 4));
+	multiplyBalanced(v2, p, q, m, rest);
+
+	// v0 and vinf go straight to their places in r.
+	multiplyBalanced(r, a, b, k, rest);
+	for (i = 2 * k; i < 4 * k; i++)
+		r[i] = 0;
+	multiplyBalanced(r + 4 * k, a2, b2, s, rest);
+	const Blk *v0 = r, *vinf = r + 4 * k;
+
+	// t = c1 + c3
+	subtractBlocks(t, v1, vm1, L);
+	shiftRightOne(t, L);
+	// v1 = c2
+	addBlocks(v1, v1, vm1, L);
+	shiftRightOne(v1, L);
+	subtractUnequal(v1, v1, L, v0, 2 * k);
+	subtractUnequal(v1, v1, L, vinf, 2 * s);
+	// v2 = c3
+	subtractUnequal(v2, v2, L, v0, 2 * k);
+	subtractBlockAt(v2 + 2 * s, L - 2 * s,
+		multiplySubtractBlock(v2, vinf, 2 * s, 16));
+	multiplySubtractBlock(v2, v1, L, 4);
+	shiftRightOne(v2, L);
+	subtractBlocks(v2, v2, t, L);
+	divideExactBy3(v2, L);
+	// t = c1
+	subtractBlocks(t, t, v2, L);
+
+	addInto(r + k, 2 * n - k, t, L);
+	addInto(r + 2 * k, 2 * n - 2 * k, v1, L);
+	addInto(r + 3 * k, 2 * n - 3 * k, v2, L);
+}
+
+static void multiplyBalanced(Blk *r, const Blk *a, const Blk *b, Index n,
+		Blk *scratch) {
+	if (belowKaratsuba(n))
+		multiplySchoolbook(r, a, n, b, n);
+	else if (belowToom3(n))
+		multiplyKaratsuba(r, a, b, n, scratch);
+	else
+		multiplyToom3(r, a, b, n, scratch);
+}
+
+#ifdef BIGUNSIGNED_NTT
+/*
+ * Number-theoretic transform multiplication for very large operands.
+ *
+ * The blocks of each operand are the coefficients of a polynomial, and each
+ * coefficient of the product polynomial is a sum of at most bn products of
+ * two blocks, less than 2^128 * 2^30.  The product polynomial is computed
+ * exactly modulo three primes just under 2^62 by a cyclic convolution of
+ * length n >= an + bn - 1 under each prime's radix-2 transform.  The three
+ * primes multiply to about 2^186, so Garner's form of the Chinese remainder
+ * theorem recovers every coefficient from its residues, and carrying the
+ * three-block coefficients into place gives the product.
+ *
+ * Each prime is c 2^k + 1 with k >= 41, so it has the n-th roots of unity
+ * for every n up to the 2^30 blocks the transforms allow.  The forward
+ * transform runs decimation in frequency and leaves its output in
+ * bit-reversed order, which the pointwise products do not mind and the
+ * decimation-in-time inverse takes as input, so no bit reversal is done.
+ *
+ * Pointwise products use Montgomery multiplication with R = 2^64, which
+ * replaces the division by the prime with two multiplications.  The
+ * butterflies multiply by a known root w, so they use Shoup's method
+ * instead: with w' = floor(w 2^64 / p), x w - floor(x w' / 2^64) p is x w
+ * modulo p give or take one p, for one high and two low multiplications.
+ * Following Harvey, butterflies leave their results below 2p or 4p and
+ * reduce them no more than the next step needs; 4p still fits in a block.
+ */
+
+/* The scratch space takes 3n blocks, which must not wrap around an Index.
+ * Longer products go to Toom-3. */
+static const Index nttMaxLength = Index(1) << 30;
+
+static const struct {
+	Blk prime, generator;
+} nttPrimes[3] = {
+	{ 0x3fffc00000000001UL, 11 }, // 65535 2^46 + 1
+	{ 0x3fffbe0000000001UL, 3 },  // 2097119 2^41 + 1
+	{ 0x3fff840000000001UL, 19 }, // 1048545 2^42 + 1
+};
+
+// Arithmetic modulo one of the primes.
+struct NttField {
+	Blk p;
+	Blk pInv; // -1/p modulo 2^64
+	Blk r2;   // R^2 modulo p, to convert into Montgomery form
+
+	NttField(Blk prime) : p(prime) {
+		// Each Newton step doubles the correct low bits of 1/p, from 3.
+		Blk inv = p;
+		for (int i = 0; i < 5; i++)
+			inv *= 2 - p * inv;
+		pInv = 0 - inv;
+		r2 = Blk((~DoubleBlk(0) % p + 1) % p);
+	}
+
+	/* x + m if x went negative, i.e. below 0 modulo 2^64 by less than
+	 * 2^63.  Masking the correction in rather than branching on it
+	 * matters: the branch would go either way at random. */
+	static Blk fix(Blk x, Blk m) { return x + (m & (0 - (x >> 63))); }
+	// From below 2p, 4p or 2^64 respectively to below p.
+	Blk reduce(Blk x) const { return fix(x - p, p); }
+	Blk reduce4(Blk x) const { return reduce(fix(x - 2 * p, 2 * p)); }
+	Blk subtract(Blk a, Blk b) const { return fix(a - b, p); }
+	/* a b / R modulo p, below p.  It only needs a b < p R, so one operand
+	 * may be any block when the other is below p, or both below 2p. */
+	Blk multiply(Blk a, Blk b) const {
+		DoubleBlk t = DoubleBlk(a) * b;
+		Blk m = Blk(t) * pInv;
+		return reduce(Blk((t + DoubleBlk(m) * p) >> 64));
+	}
+	Blk toMontgomery(Blk a) const { return multiply(a, r2); }
+	// x^e for `x' in Montgomery form, and the result in Montgomery form
+	Blk power(Blk x, Blk e) const {
+		Blk y = toMontgomery(1);
+		for (; e != 0; e >>= 1) {
+			if (e & 1)
+				y = multiply(y, x);
+			x = multiply(x, x);
+		}
+		return y;
+	}
+	// 1/a modulo p, both in normal form
+	Blk inverse(Blk a) const {
+		return multiply(power(toMontgomery(a), p - 2), 1);
+	}
+	// x w modulo p, below 2p, for any block `x'
+	Blk multiplyShoup(Blk x, Blk w, Blk wShoup) const {
+		Blk q = Blk((DoubleBlk(x) * wShoup) >> 64);
+		return x * w - q * p;
+	}
+};
+
+/*
+ * The roots of unity for a transform of length n: roots[h + j], for
+ * 1 <= h < n a power of 2 and 0 <= j < h, is w_2h^j, where w_2h is the
+ * primitive 2h-th root, and shoup[h + j] is its w'.  Each level of
+ * butterflies reads its roots one after another, which matters once the
+ * transform outgrows the cache.
+ *
+ * Transforms of more than `nttCacheBlocks' blocks do one level of
+ * butterflies and then each half in turn, depth first, so that the rest of
+ * a half's levels run while it is in cache; smaller ones go level by
+ * level.  2^13 to 2^17 blocks did about as well on a machine with a 2 MB
+ * L2 cache, and 2^15 blocks (256 KB) leaves room on smaller caches.
+ */
+static const Index nttCacheBlocks = 1 << 15;
+
+/* One level of forward butterflies over x[0..2h), each below 2p, leaving
+ * them below 2p. */
+static inline void nttForwardLevel(Blk *x, Index h, const Blk *roots,
+		const Blk *shoup, const NttField &f) {
+	Blk p2 = 2 * f.p;
+	for (Index j = 0; j < h; j++) {
+		Blk u = x[j], v = x[j + h];
+		x[j] = NttField::fix(u + v - p2, p2);
+		x[j + h] = f.multiplyShoup(u - v + p2, roots[h + j], shoup[h + j]);
+	}
+}
+
+// Forward transform of x[0..n), leaving it in bit-reversed order.
+static void nttForward(Blk *x, Index n, const Blk *roots, const Blk *shoup,
+		const NttField &f) {
+	if (n > nttCacheBlocks) {
+		nttForwardLevel(x, n / 2, roots, shoup, f);
+		nttForward(x, n / 2, roots, shoup, f);
+		nttForward(x + n / 2, n / 2, roots, shoup, f);
+		return;
+	}
+	for (Index h = n / 2; h >= 1; h /= 2)
+		for (Index s = 0; s < n; s += 2 * h)
+			nttForwardLevel(x + s, h, roots, shoup, f);
+}
+
+/* One level of inverse butterflies over x[0..2h), each below 4p, leaving
+ * them below 4p.  It needs w_2h^-j, which is -w_2h^(h - j); the w' of
+ * p - w is ~w'.  w^0 = 1 comes first, on its own. */
+static inline void nttInverseLevel(Blk *x, Index h, const Blk *roots,
+		const Blk *shoup, const NttField &f) {
+	Blk p2 = 2 * f.p;
+	Blk u = NttField::fix(x[0] - p2, p2);
+	Blk v = NttField::fix(x[h] - p2, p2);
+	x[0] = u + v;
+	x[h] = u - v + p2;
+	for (Index j = 1; j < h; j++) {
+		u = NttField::fix(x[j] - p2, p2);
+		v = f.multiplyShoup(x[j + h], f.p - roots[2 * h - j],
+			~shoup[2 * h - j]);
+		x[j] = u + v;
+		x[j + h] = u - v + p2;
+	}
+}
+
+// Inverse of `nttForward' up to a factor of n.
+static void nttInverse(Blk *x, Index n, const Blk *roots, const Blk *shoup,
+		const NttField &f) {
+	if (n > nttCacheBlocks) {
+		nttInverse(x, n / 2, roots, shoup, f);
+		nttInverse(x + n / 2, n / 2, roots, shoup, f);
+		nttInverseLevel(x, n / 2, roots, shoup, f);
+		return;
+	}
+	for (Index h = 1; h < n; h *= 2)
+		for (Index s = 0; s < n; s += 2 * h)
+			nttInverseLevel(x + s, h, roots, shoup, f);
+}
+
+// x[0..n) = a[0..an) modulo f.p, padded with zeros
+static void nttLoad(Blk *x, Index n, const Blk *a, Index an,
+		const NttField &f) {
+	Blk one = f.toMontgomery(1);
+	Index i;
+	for (i = 0; i < an; i++)
+		x[i] = f.multiply(a[i], one);
+	for (; i < n; i++)
+		x[i] = 0;
+}
+
+static bool useNtt(Index an, Index bn) {
+	return bn >= BigUnsigned::nttThreshold && an + bn - 1 <= nttMaxLength;
+}
+
+// r[0..an+bn) = a * b, an >= bn >= 1; `a' and `b' may be the same.
+static void multiplyNtt(Blk *r, const Blk *a, Index an,
+		const Blk *b, Index bn) {
+	Index rn = an + bn, n = 1, i;
+	while (n < rn - 1)
+		n *= 2;
+	bool square = (a == b && an == bn);
+	Blk *residues = new Blk[3 * n];
+	Blk *t = square ? NULL : new Blk[n];
+	Blk *roots = new Blk[2 * n], *shoup = roots + n;
+
+	for (int k = 0; k < 3; k++) {
+		NttField f(nttPrimes[k].prime);
+		Blk *x = residues + k * n;
+		/* With the powers of w in Montgomery form, M = w R modulo p, w' is
+		 * (w R - M) / p, an exact division that multiplication by 1/p
+		 * modulo 2^64 does: -M / p = M pInv.  The lower levels take every
+		 * other root of the level above. */
+		Blk w = f.power(f.toMontgomery(nttPrimes[k].generator),
+			(f.p - 1) / n);
+		Blk m = f.toMontgomery(1);
+		for (i = n / 2; i < n; i++) {
+			roots[i] = f.multiply(m, 1);
+			shoup[i] = m * f.pInv;
+			m = f.multiply(m, w);
+		}
+		for (i = n / 2; i > 1; ) {
+			i--;
+			roots[i] = roots[2 * i];
+			shoup[i] = shoup[2 * i];
+		}
+		/* Each pointwise product comes out divided by R; multiplying by
+		 * R^2 / n in Montgomery form also removes the inverse's factor of
+		 * n.  1/n is p - (p - 1)/n since n divides p - 1. */
+		Blk scale = f.multiply(f.multiply(f.p - (f.p - 1) / n, f.r2), f.r2);
+
+		nttLoad(x, n, a, an, f);
+		nttForward(x, n, roots, shoup, f);
+		if (square) {
+			for (i = 0; i < n; i++)
+				x[i] = f.multiply(f.multiply(x[i], x[i]), scale);
+		} else {
+			nttLoad(t, n, b, bn, f);
+			nttForward(t, n, roots, shoup, f);
+			for (i = 0; i < n; i++)
+				x[i] = f.multiply(f.multiply(x[i], t[i]), scale);
+		}
+		nttInverse(x, n, roots, shoup, f);
+		for (i = 0; i < n; i++)
+			x[i] = f.reduce4(x[i]);
+	}
+	delete [] roots;
+	delete [] t;
+
+	/*
+	 * Garner: with residues x1, x2, x3, the coefficient is
+	 * v1 + v2 p1 + v3 p1 p2, where v1 = x1,
+	 * v2 = (x2 - v1) / p1 modulo p2 and
+	 * v3 = (x3 - v1 - v2 p1) / (p1 p2) modulo p3.
+	 * Each prime is less than twice the next, so v1 and v2 reduce modulo
+	 * the later primes with one subtraction.  The sum of the coefficients,
+	 * each shifted one block further, is carried in acc0..acc2.
+	 */
+	NttField f2(nttPrimes[1].prime), f3(nttPrimes[2].prime);
+	Blk p1 = nttPrimes[0].prime;
+	Blk inv12 = f2.toMontgomery(f2.inverse(p1 - f2.p));
+	Blk inv123 = f3.toMontgomery(f3.inverse(
+		f3.multiply(p1 - f3.p, f3.toMontgomery(f2.p - f3.p))));
+	Blk p1In3 = f3.toMontgomery(p1 - f3.p);
+	DoubleBlk p12 = DoubleBlk(p1) * f2.p;
+	Blk p12Low = Blk(p12), p12High = Blk(p12 >> 64);
+	Blk acc0 = 0, acc1 = 0, acc2 = 0;
+	for (i = 0; i < rn; i++) {
+		Blk v1 = 0, v2 = 0, v3 = 0;
+		if (i < rn - 1) {
+			v1 = residues[i];
+			Blk x2 = residues[n + i], x3 = residues[2 * n + i];
+			v2 = f2.multiply(f2.subtract(x2, f2.reduce(v1)), inv12);
+			v3 = f3.multiply(f3.subtract(f3.subtract(x3, f3.reduce(v1)),
+				f3.multiply(f3.reduce(v2), p1In3)), inv123);
+		}
+		DoubleBlk v2p1 = DoubleBlk(v2) * p1;
+		DoubleBlk low = DoubleBlk(v3) * p12Low;
+		DoubleBlk high = DoubleBlk(v3) * p12High;
+		DoubleBlk sum = DoubleBlk(acc0) + v1 + Blk(v2p1) + Blk(low);
+		r[i] = Blk(sum);
+		sum = (sum >> 64) + acc1 + Blk(v2p1 >> 64) + Blk(low >> 64)
+			+ Blk(high);
+		acc0 = Blk(sum);
+		sum = (sum >> 64) + acc2 + Blk(high >> 64);
+		acc1 = Blk(sum);
+		acc2 = Blk(sum >> 64);
+	}
+	delete [] residues;
+}
+#endif
+
+static Index multiplyScratch(Index an, Index bn) {
+	if (belowKaratsuba(bn))
+		return 0;
+#ifdef BIGUNSIGNED_NTT
+	if (useNtt(an, bn))
+		return 0;
+#endif
+	if (an == bn)
+		return balancedScratch(bn);
+	Index s = balancedScratch(bn), left = an % bn;
+	if (left != 0 && multiplyScratch(bn, left) > s)
+		s = multiplyScratch(bn, left);
+	return 2 * bn + s;
+}
+
+/* r[0..an+bn) = a * b, an >= bn >= 1.  Below the transform's threshold, a
+ * longer `a' is cut into `bn'-block pieces whose balanced products are
+ * added up. */
+static void multiplyBlocks(Blk *r, const Blk *a, Index an,
+		const Blk *b, Index bn, Blk *scratch) {
+	if (belowKaratsuba(bn)) {
+		multiplySchoolbook(r, a, an, b, bn);
+		return;
+	}
+#ifdef BIGUNSIGNED_NTT
+	if (useNtt(an, bn)) {
+		multiplyNtt(r, a, an, b, bn);
+		return;
+	}
+#endif
+	if (an == bn) {
+		multiplyBalanced(r, a, b, bn, scratch);
+		return;
+	}
+	Blk *t = scratch, *rest = scratch + 2 * bn;
+	Index i;
+	for (i = 0; i < an + bn; i++)
+		r[i] = 0;
+	for (i = 0; i < an; i += bn) {
+		Index pn = (an - i < bn) ? an - i : bn;
+		if (pn == bn)
+			multiplyBalanced(t, a + i, b, bn, rest);
+		else
+			multiplyBlocks(t, b, bn, a + i, pn, rest);
+		addInto(r + i, an + bn - i, t, pn + bn);
+	}
+}
+
+/* r[0..an+bn) = a * b for any an, bn >= 1, with its own scratch space. */
+static void multiplyArrays(Blk *r, const Blk *a, Index an,
+		const Blk *b, Index bn) {
+	if (an < bn) {
+		multiplyArrays(r, b, bn, a, an);
+		return;
+	}
+	Index scratchLen = multiplyScratch(an, bn);
+	Blk *scratch = (scratchLen > 0) ? new Blk[scratchLen] : NULL;
+	multiplyBlocks(r, a, an, b, bn, scratch);
+	delete [] scratch;
+}
+
 void BigUnsigned::multiply(const BigUnsigned &a, const BigUnsigned &b) {
-	DTRT_ALIASED(this == &a || this == &b, multiply(a, b));
 	// If either a or b is zero, set to zero.
 	if (a.len == 0 || b.len == 0) {
 		len = 0;
 		return;
 	}
-	/*
-	 * Overall method:
-	 *
-	 * Set this = 0.
-	 * For each 1-bit of `a' (say the `i2'th bit of block `i'):
-	 *    Add `b << (i blocks and i2 bits)' to *this.
-	 */
-	// Variables for the calculation
-	Index i, j, k;
-	unsigned int i2;
-	Blk temp;
-	bool carryIn, carryOut;
-	// Set preliminary length and make room
+	// *this times one block goes block by block in place, like `add'.
+	if ((this == &a && b.len == 1) || (this == &b && a.len == 1)) {
+		Blk m = (this == &a) ? b.blk[0] : a.blk[0];
+		allocateAndCopy(len + 1);
+		blk[len] = multiplyBlock(blk, blk, len, m);
+		len++;
+		if (blk[len - 1] == 0)
+			len--;
+		return;
+	}
+	DTRT_ALIASED(this == &a || this == &b, multiply(a, b));
 	len = a.len + b.len;
 	allocate(len);
-	// Zero out this object
-	for (i = 0; i < len; i++)
-		blk[i] = 0;
-	// For each block of the first number...
-	for (i = 0; i < a.len; i++) {
-		// For each 1-bit of that block...
-		for (i2 = 0; i2 < N; i2++) {
-			if ((a.blk[i] & (Blk(1) << i2)) == 0)
-				continue;
-			/*
-			 * Add b to this, shifted left i blocks and i2 bits.
-			 * j is the index in b, and k = i + j is the index in this.
-			 *
-			 * `getShiftedBlock', a short inline function defined above,
-			 * is now used for the bit handling.  It replaces the more
-			 * complex `bHigh' code, in which each run of the loop dealt
-			 * immediately with the low bits and saved the high bits to
-			 * be picked up next time.  The last run of the loop used to
-			 * leave leftover high bits, which were handled separately.
-			 * Instead, this loop runs an additional time with j == b.len.
-			 * These changes were made on 2005.01.11.
-			 */
-			for (j = 0, k = i, carryIn = false; j <= b.len; j++, k++) {
-				/*
-				 * The body of this loop is very similar to the body of the first loop
-				 * in `add', except that this loop does a `+=' instead of a `+'.
-				 */
-				temp = blk[k] + getShiftedBlock(b, j, i2);
-				carryOut = (temp < blk[k]);
-				if (carryIn) {
-					temp++;
-					carryOut |= (temp == 0);
-				}
-				blk[k] = temp;
-				carryIn = carryOut;
-			}
-			// No more extra iteration to deal with `bHigh'.
-			// Roll-over a carry as necessary.
-			for (; carryIn; k++) {
-				blk[k]++;
-				carryIn = (blk[k] == 0);
-			}
-		}
-	}
+	multiplyArrays(blk, a.blk, a.len, b.blk, b.len);
 	// Zap possible leading zero
 	if (blk[len - 1] == 0)
 		len--;
 }
 
+void BigUnsigned::addmul(const BigUnsigned &a, const BigUnsigned &b) {
+	if (a.len == 0 || b.len == 0)
+		return;
+	// x is the longer operand, y the shorter
+	const BigUnsigned &x = (a.len >= b.len) ? a : b;
+	const BigUnsigned &y = (a.len >= b.len) ? b : a;
+	if (y.len > 1) {
+		BigUnsigned p;
+		p.multiply(a, b);
+		add(*this, p);
+		return;
+	}
+	/* One pass of blk[0..x.len) += x * m and then the carry.  Like `add',
+	 * it works even if x is *this. */
+	Blk m = y.blk[0];
+	Index n = ((len > x.len) ? len : x.len) + 1;
+	allocateAndCopy(n);
+	for (Index i = len; i < n; i++)
+		blk[i] = 0;
+	Blk carry = multiplyAddBlock(blk, x.blk, x.len, m);
+	addBlockAt(blk + x.len, n - x.len, carry);
+	len = n;
+	zapLeadingZeros();
+}
+
+/*
+ * The division engine.
+ *
+ * Like the multiplication engine, it works on bare block arrays.  Knuth's
+ * Algorithm D needs a normalized divisor, one whose top block has its top
+ * bit set, so `divideWithRemainder' shifts both operands left until the
+ * divisor is normalized and shifts the remainder back at the end; a
+ * single-block divisor instead goes through `divideBlock', which shifts
+ * the dividend on the fly.
+ */
+
+// The number of leading zero bits of a nonzero block
+static unsigned int leadingZeros(Blk x) {
+	unsigned int s = 0;
+	for (; (x & (Blk(1) << (BigUnsigned::N - 1))) == 0; x <<= 1)
+		s++;
+	return s;
+}
+
+// r[0..n) = a[0..n) << s, 0 <= s < N; returns the bits shifted out.
+static Blk shiftBlocksLeft(Blk *r, const Blk *a, Index n, unsigned int s) {
+	Blk carry = 0;
+	for (Index i = 0; i < n; i++) {
+		Blk x = a[i];
+		r[i] = (s == 0) ? x : (x << s) | carry;
+		carry = (s == 0) ? 0 : x >> (BigUnsigned::N - s);
+	}
+	return carry;
+}
+
+// r[0..n) = a[0..n) >> s, 0 <= s < N.  `r' may be `a'.
+static void shiftBlocksRight(Blk *r, const Blk *a, Index n, unsigned int s) {
+	for (Index i = 0; i < n; i++) {
+		Blk high = (s == 0 || i + 1 == n) ? 0
+			: a[i + 1] << (BigUnsigned::N - s);
+		r[i] = (a[i] >> s) | high;
+	}
+}
+
+// Compares a[0..n) with b[0..n) like Perl's <=>.
+static int compareBlocks(const Blk *a, const Blk *b, Index n) {
+	for (Index i = n; i > 0; ) {
+		i--;
+		if (a[i] != b[i])
+			return (a[i] < b[i]) ? -1 : 1;
+	}
+	return 0;
+}
+
+/* The reciprocal floor((B^2 - 1) / d) - B of a normalized block `d'.  The
+ * quotient is between B and 2B, so its low block is the reciprocal. */
+static Blk reciprocalBlock(Blk d) {
+	return Blk(~DoubleBlk(0) / d);
+}
+
+/* Divides <u1, u0> = u1 B + u0 by the normalized block `d', where u1 < d
+ * and `v' is d's reciprocal; returns the quotient and sets `r' to the
+ * remainder.  This is Algorithm 4 of Moller and Granlund, ``Improved
+ * division by invariant integers'' (2011): one multiplication by the
+ * reciprocal and at most two corrections replace a division, which C++ can
+ * only do as a call to a double-block division routine. */
+static inline Blk divideTwoBlocks(Blk u1, Blk u0, Blk d, Blk v, Blk &r) {
+	DoubleBlk p = DoubleBlk(v) * u1
+		+ ((DoubleBlk(u1) << BigUnsigned::N) | u0);
+	Blk q1 = Blk(p >> BigUnsigned::N) + 1, q0 = Blk(p);
+	Blk rem = u0 - q1 * d;
+	if (rem > q0) {
+		q1--;
+		rem += d;
+	}
+	if (rem >= d) {
+		q1++;
+		rem -= d;
+	}
+	r = rem;
+	return q1;
+}
+
+/* q[0..n) = a[0..n) / d for a nonzero block `d'; returns the remainder.
+ * `q' may be `a'. */
+static Blk divideBlock(Blk *q, const Blk *a, Index n, Blk d) {
+	const unsigned int N = BigUnsigned::N;
+	unsigned int s = leadingZeros(d);
+	d <<= s;
+	Blk v = reciprocalBlock(d);
+	// The running remainder starts as the bits shifted out of the top.
+	Blk r = (s == 0) ? 0 : a[n - 1] >> (N - s);
+	for (Index i = n; i > 0; ) {
+		i--;
+		Blk u0 = (s == 0) ? a[i]
+			: (a[i] << s) | ((i == 0) ? 0 : a[i - 1] >> (N - s));
+		q[i] = divideTwoBlocks(r, u0, d, v, r);
+	}
+	return r >> s;
+}
+
+/* Knuth's Algorithm D: divides u[0..un) by the normalized v[0..vn),
+ * vn >= 2, where the top vn blocks of `u' are less than `v'.  Stores the
+ * un - vn quotient blocks in `q' and leaves the remainder in u[0..vn).
+ *
+ * Each quotient block is estimated by dividing the top two blocks of the
+ * current remainder by the top block of `v' and refined with the next
+ * block of each (step D3), after which it is at most one too large; the
+ * rare case that the multiply-and-subtract then borrows adds `v' back. */
+static void divideKnuth(Blk *q, Blk *u, Index un, const Blk *v, Index vn) {
+	const unsigned int N = BigUnsigned::N;
+	Blk d1 = v[vn - 1], d0 = v[vn - 2];
+	Blk recip = reciprocalBlock(d1);
+	for (Index j = un - vn; j > 0; ) {
+		j--;
+		Blk *w = u + j;
+		Blk u2 = w[vn], u1 = w[vn - 1], u0 = w[vn - 2];
+		Blk qhat, rhat;
+		bool refine = true;
+		if (u2 >= d1) {
+			// Then u2 == d1 and the estimate B - 1 leaves u1 + d1.
+			qhat = ~Blk(0);
+			rhat = u1 + d1;
+			refine = (rhat >= d1);
+		} else
+			qhat = divideTwoBlocks(u2, u1, d1, recip, rhat);
+		// Once rhat passes B, qhat d0 < B^2 <= <rhat, u0>.
+		while (refine && DoubleBlk(qhat) * d0 > ((DoubleBlk(rhat) << N) | u0)) {
+			qhat--;
+			rhat += d1;
+			refine = (rhat >= d1);
+		}
+		Blk borrow = multiplySubtractBlock(w, v, vn, qhat);
+		Blk top = w[vn];
+		w[vn] = top - borrow;
+		if (top < borrow) {
+			qhat--;
+			w[vn] += addBlocks(w, w, v, vn);
+		}
+		q[j] = qhat;
+	}
+}
+
+/*
+ * Burnikel and Ziegler's recursive division (``Fast Recursive Division'',
+ * 1998).  Dividing 2n blocks by n comes down to two divisions of 3n/2
+ * blocks by n, and each of those to one division of n blocks by n/2 and
+ * one n/2 by n/2 multiplication; with a subquadratic multiplication the
+ * whole costs about twice a multiplication of the same size.  Odd and
+ * small sizes go to Algorithm D.  As there, divisors are normalized, and
+ * the top half of each dividend is less than the divisor.
+ */
+
+static void divideThreeByTwo(Blk *q, Blk *r, const Blk *a, const Blk *b,
+		Index h);
+
+static bool belowBurnikelZiegler(Index n) {
+	return n < 4 || n < BigUnsigned::burnikelZieglerThreshold;
+}
+
+// q[0..n) = a[0..2n) / b[0..n), r[0..n) = the remainder
+static void divideTwoByOne(Blk *q, Blk *r, const Blk *a, const Blk *b,
+		Index n) {
+	Index i;
+	if (n % 2 != 0 || belowBurnikelZiegler(n)) {
+		Blk *u = new Blk[2 * n];
+		for (i = 0; i < 2 * n; i++)
+			u[i] = a[i];
+		divideKnuth(q, u, 2 * n, b, n);
+		for (i = 0; i < n; i++)
+			r[i] = u[i];
+		delete [] u;
+		return;
+	}
+	// The top 3h blocks of a, then the remainder and the last h blocks
+	Index h = n / 2;
+	Blk *t = new Blk[3 * h];
+	divideThreeByTwo(q + h, t + h, a + h, b, h);
+	for (i = 0; i < h; i++)
+		t[i] = a[i];
+	divideThreeByTwo(q, r, t, b, h);
+	delete [] t;
+}
+
+/* q[0..h) = a[0..3h) / b[0..2h), r[0..2h) = the remainder.  The quotient
+ * is first estimated from the top 2h blocks of `a' and top h of `b', which
+ * can only make it too large, by at most 2 (Burnikel and Ziegler's
+ * Lemma 2). */
+static void divideThreeByTwo(Blk *q, Blk *r, const Blk *a, const Blk *b,
+		Index h) {
+	const Blk *b1 = b + h;
+	Blk carry = 0;
+	Index i;
+	if (compareBlocks(a + 2 * h, b1, h) < 0)
+		divideTwoByOne(q, r + h, a + h, b1, h);
+	else {
+		// The top blocks are equal, so q = B^h - 1 and r1 = a2 + b1.
+		for (i = 0; i < h; i++)
+			q[i] = ~Blk(0);
+		carry = addBlocks(r + h, a + h, b1, h);
+	}
+	for (i = 0; i < h; i++)
+		r[i] = a[i];
+	Blk *d = new Blk[2 * h];
+	multiplyArrays(d, q, h, b, h);
+	// While <carry - borrow, r> is negative, the quotient is too large.
+	Blk borrow = subtractBlocks(r, r, d, 2 * h);
+	while (carry < borrow) {
+		carry += addBlocks(r, r, b, 2 * h);
+		subtractBlockAt(q, h, 1);
+	}
+	delete [] d;
+}
+
+/* Divides u[0..un) by v[0..vn), as `divideKnuth' does, recursively when the
+ * divisor and quotient are both long enough.  For the recursion the
+ * divisor is padded with zero blocks at the bottom to m 2^k blocks, m small,
+ * so that it halves evenly all the way down to Algorithm D; the dividend is
+ * padded to match and split into divisor-sized chunks that are divided
+ * from the top, each remainder joining the next chunk. */
+static void divideBlocks(Blk *q, Blk *u, Index un, const Blk *v, Index vn) {
+	if (belowBurnikelZiegler(vn) || belowBurnikelZiegler(un - vn)) {
+		divideKnuth(q, u, un, v, vn);
+		return;
+	}
+	Index m = vn, k = 0, i;
+	while (!belowBurnikelZiegler(m)) {
+		m = (m + 1) / 2;
+		k++;
+	}
+	Index n = m << k, pad = n - vn;
+	Index chunks = (un + pad + n - 1) / n;
+	Blk *vp = new Blk[n], *up = new Blk[chunks * n];
+	Blk *qp = new Blk[(chunks - 1) * n], *r = new Blk[n];
+	for (i = 0; i < pad; i++)
+		vp[i] = up[i] = 0;
+	for (i = 0; i < vn; i++)
+		vp[pad + i] = v[i];
+	for (i = 0; i < un; i++)
+		up[pad + i] = u[i];
+	for (i = pad + un; i < chunks * n; i++)
+		up[i] = 0;
+	// The top chunk is less than the divisor, so it starts as remainder.
+	for (i = 0; i < n; i++)
+		r[i] = up[(chunks - 1) * n + i];
+	for (Index c = chunks - 1; c > 0; ) {
+		c--;
+		// The remainder so far over chunk c; up's chunk c + 1 is free.
+		Blk *z = up + c * n;
+		for (i = 0; i < n; i++)
+			z[n + i] = r[i];
+		divideTwoByOne(qp + c * n, r, z, vp, n);
+	}
+	for (i = 0; i < un - vn; i++)
+		q[i] = qp[i];
+	// The padding blocks of the remainder are zero.
+	for (i = 0; i < vn; i++)
+		u[i] = r[pad + i];
+	delete [] vp;
+	delete [] up;
+	delete [] qp;
+	delete [] r;
+}
+
 /*
  * DIVISION WITH REMAINDER
  * This monstrous function mods *this by the given divisor b while storing the
  * quotient in the given object q; at the end, *this contains the remainder.
  * The seemingly bizarre pattern of inputs and outputs was chosen so that the
- * function copies as little as possible (since it is implemented by repeated
- * subtraction of multiples of b from *this).
+ * function copies as little as possible (since the remainder is what is left
+ * after subtracting multiples of b from *this).
  * 
  * "modWithQuotient" might be a better name for this function, but I would
  * rather not change the name now.
@@ -382,7 +1345,7 @@ void BigUnsigned::multiply(const BigUnsigned &a, const BigUnsigned &b) {
 void BigUnsigned::divideWithRemainder(const BigUnsigned &b, BigUnsigned &q) {
 	/* Defending against aliased calls is more complex than usual because we
 	 * are writing to both *this and q.
-	 * 
+	 *
 	 * It would be silly to try to write quotient and remainder to the
 	 * same variable.  Rule that out right away. */
 	if (this == &q)
@@ -420,121 +1383,36 @@ void BigUnsigned::divideWithRemainder(const BigUnsigned &b, BigUnsigned &q) {
 
 	// At this point we know (*this).len >= b.len > 0.  (Whew!)
 
-	/*
-	 * Overall method:
-	 *
-	 * For each appropriate i and i2, decreasing:
-	 *    Subtract (b << (i blocks and i2 bits)) from *this, storing the
-	 *      result in subtractBuf.
-	 *    If the subtraction succeeds with a nonnegative result:
-	 *        Turn on bit i2 of block i of the quotient q.
-	 *        Copy subtractBuf back into *this.
-	 *    Otherwise bit i2 of block i remains off, and *this is unchanged.
-	 * 
-	 * Eventually q will contain the entire quotient, and *this will
-	 * be left with the remainder.
-	 *
-	 * subtractBuf[x] corresponds to blk[x], not blk[x+i], since 2005.01.11.
-	 * But on a single iteration, we don't touch the i lowest blocks of blk
-	 * (and don't use those of subtractBuf) because these blocks are
-	 * unaffected by the subtraction: we are subtracting
-	 * (b << (i blocks and i2 bits)), which ends in at least `i' zero
-	 * blocks. */
-	// Variables for the calculation
-	Index i, j, k;
-	unsigned int i2;
-	Blk temp;
-	bool borrowIn, borrowOut;
+	if (b.len == 1) {
+		q.len = len;
+		q.allocate(q.len);
+		Blk r = divideBlock(q.blk, blk, len, b.blk[0]);
+		q.zapLeadingZeros();
+		blk[0] = r;
+		len = (r == 0) ? 0 : 1;
+		return;
+	}
 
 	/*
-	 * Make sure we have an extra zero block just past the value.
-	 *
-	 * When we attempt a subtraction, we might shift `b' so
-	 * its first block begins a few bits left of the dividend,
-	 * and then we'll try to compare these extra bits with
-	 * a nonexistent block to the left of the dividend.  The
-	 * extra zero block ensures sensible behavior; we need
-	 * an extra block in `subtractBuf' for exactly the same reason.
+	 * Normalize: shift both operands left by the number of leading zero
+	 * bits of the divisor's top block.  The dividend gains a top block for
+	 * the bits shifted out of it, and since those are fewer than the
+	 * divisor's top block, its top b.len blocks are less than the divisor,
+	 * as the division routines require.
 	 */
-	Index origLen = len; // Save real length.
-	/* To avoid an out-of-bounds access in case of reallocation, allocate
-	 * first and then increment the logical length. */
-	allocateAndCopy(len + 1);
-	len++;
-	blk[origLen] = 0; // Zero the added block.
-
-	// subtractBuf holds part of the result of a subtraction; see above.
-	Blk *subtractBuf = new Blk[len];
-
-	// Set preliminary length for quotient and make room
-	q.len = origLen - b.len + 1;
+	unsigned int s = leadingZeros(b.blk[b.len - 1]);
+	Blk *v = new Blk[b.len], *u = new Blk[len + 1];
+	shiftBlocksLeft(v, b.blk, b.len, s);
+	u[len] = shiftBlocksLeft(u, blk, len, s);
+	q.len = len + 1 - b.len;
 	q.allocate(q.len);
-	// Zero out the quotient
-	for (i = 0; i < q.len; i++)
-		q.blk[i] = 0;
-
-	// For each possible left-shift of b in blocks...
-	i = q.len;
-	while (i > 0) {
-		i--;
-		// For each possible left-shift of b in bits...
-		// (Remember, N is the number of bits in a Blk.)
-		q.blk[i] = 0;
-		i2 = N;
-		while (i2 > 0) {
-			i2--;
-			/*
-			 * Subtract b, shifted left i blocks and i2 bits, from *this,
-			 * and store the answer in subtractBuf.  In the for loop, `k == i + j'.
-			 *
-			 * Compare this to the middle section of `multiply'.  They
-			 * are in many ways analogous.  See especially the discussion
-			 * of `getShiftedBlock'.
-			 */
-			for (j = 0, k = i, borrowIn = false; j <= b.len; j++, k++) {
-				temp = blk[k] - getShiftedBlock(b, j, i2);
-				borrowOut = (temp > blk[k]);
-				if (borrowIn) {
-					borrowOut |= (temp == 0);
-					temp--;
-				}
-				// Since 2005.01.11, indices of `subtractBuf' directly match those of `blk', so use `k'.
-				subtractBuf[k] = temp; 
-				borrowIn = borrowOut;
-			}
-			// No more extra iteration to deal with `bHigh'.
-			// Roll-over a borrow as necessary.
-			for (; k < origLen && borrowIn; k++) {
-				borrowIn = (blk[k] == 0);
-				subtractBuf[k] = blk[k] - 1;
-			}
-			/*
-			 * If the subtraction was performed successfully (!borrowIn),
-			 * set bit i2 in block i of the quotient.
-			 *
-			 * Then, copy the portion of subtractBuf filled by the subtraction
-			 * back to *this.  This portion starts with block i and ends--
-			 * where?  Not necessarily at block `i + b.len'!  Well, we
-			 * increased k every time we saved a block into subtractBuf, so
-			 * the region of subtractBuf we copy is just [i, k).
-			 */
-			if (!borrowIn) {
-				q.blk[i] |= (Blk(1) << i2);
-				while (k > i) {
-					k--;
-					blk[k] = subtractBuf[k];
-				}
-			} 
-		}
-	}
-	// Zap possible leading zero in quotient
-	if (q.blk[q.len - 1] == 0)
-		q.len--;
-	// Zap any/all leading zeros in remainder
+	divideBlocks(q.blk, u, len + 1, v, b.len);
+	q.zapLeadingZeros();
+	shiftBlocksRight(blk, u, b.len, s);
+	len = b.len;
 	zapLeadingZeros();
-	// Deallocate subtractBuf.
-	// (Thanks to Brad Spencer for noticing my accidental omission of this!)
-	delete [] subtractBuf;
+	delete [] u;
+	delete [] v;
 }
 
 /* BITWISE OPERATORS
@@ -44,6 +44,14 @@ public:
 		NumberlikeArray<Blk>::operator =(x);
 	}
 
+#if __cplusplus >= 201103L
+	// Move constructor and assignment; `x' is left zero.
+	BigUnsigned(BigUnsigned &&x) : NumberlikeArray<Blk>(std::move(x)) {}
+	void operator=(BigUnsigned &&x) {
+		NumberlikeArray<Blk>::operator =(std::move(x));
+	}
+#endif
+
 	// Constructor that copies from a given array of blocks.
 	BigUnsigned(const Blk *b, Index blen) : NumberlikeArray<Blk>(b, blen) {
 		// Eliminate any leading zeros we may have been passed.
@@ -170,6 +178,13 @@ public:
 	 *     // ``Aliased'' calls now do the right thing using a temporary
 	 *     // copy, but see note on `divideWithRemainder'.
 	 *     a.add(a, b); 
+	 *
+	 * With C++11, the return-by-value operators +, -, / and % also take
+	 * operands that are about to die (temporaries, or values passed
+	 * through std::move) and build the result in their blocks, so
+	 * `a * b + c' allocates only for the product.  `add', `subtract' and
+	 * `multiply' by a one-block number work in place when the receiver is
+	 * an operand, which makes `a += b' and `a *= 7' free of copies.
 	 */
 
 	// COPY-LESS OPERATIONS
@@ -186,6 +201,11 @@ public:
 	void bitShiftLeft(const BigUnsigned &a, int b);
 	void bitShiftRight(const BigUnsigned &a, int b);
 
+	/* `x.addmul(a, b)' is like `x += a * b', but a one-block factor is
+	 * multiplied and added in a single pass over the other, with no
+	 * product in between. */
+	void addmul(const BigUnsigned &a, const BigUnsigned &b);
+
 	/* `a.divideWithRemainder(b, q)' is like `q = a / b, a %= b'.
 	 * / and % use semantics similar to Knuth's, which differ from the
 	 * primitive integer semantics under division by zero.  See the
@@ -197,12 +217,39 @@ public:
 	/* `divide' and `modulo' are no longer offered.  Use
 	 * `divideWithRemainder' instead. */
 
+	/* `multiply' uses schoolbook multiplication while the shorter operand
+	 * has fewer than `karatsubaThreshold' blocks, Karatsuba's algorithm
+	 * below `toom3Threshold' blocks, Toom-3 below `nttThreshold' blocks,
+	 * and a number-theoretic transform from there on.  (The transform
+	 * needs 64-bit blocks; elsewhere Toom-3 goes on.)  The best values
+	 * depend on the machine; they are variables so that a program can
+	 * tune them. */
+	static Index karatsubaThreshold;
+	static Index toom3Threshold;
+	static Index nttThreshold;
+
+	/* `divideWithRemainder' uses Knuth's Algorithm D, recursing in the
+	 * manner of Burnikel and Ziegler once both the divisor and the quotient
+	 * have `burnikelZieglerThreshold' blocks. */
+	static Index burnikelZieglerThreshold;
+
 	// OVERLOADED RETURN-BY-VALUE OPERATORS
-	BigUnsigned operator +(const BigUnsigned &x) const;
-	BigUnsigned operator -(const BigUnsigned &x) const;
+	BigUnsigned operator +(const BigUnsigned &x) BIGINT_CONST_LVALUE;
+	BigUnsigned operator -(const BigUnsigned &x) BIGINT_CONST_LVALUE;
 	BigUnsigned operator *(const BigUnsigned &x) const;
-	BigUnsigned operator /(const BigUnsigned &x) const;
-	BigUnsigned operator %(const BigUnsigned &x) const;
+	BigUnsigned operator /(const BigUnsigned &x) BIGINT_CONST_LVALUE;
+	BigUnsigned operator %(const BigUnsigned &x) BIGINT_CONST_LVALUE;
+#if __cplusplus >= 201103L
+	// The overloads for operands about to die
+	BigUnsigned operator +(const BigUnsigned &x) &&;
+	BigUnsigned operator +(BigUnsigned &&x) const &;
+	BigUnsigned operator +(BigUnsigned &&x) &&;
+	BigUnsigned operator -(const BigUnsigned &x) &&;
+	BigUnsigned operator -(BigUnsigned &&x) const &;
+	BigUnsigned operator -(BigUnsigned &&x) &&;
+	BigUnsigned operator /(const BigUnsigned &x) &&;
+	BigUnsigned operator %(const BigUnsigned &x) &&;
+#endif
 	/* OK, maybe unary minus could succeed in one case, but it really
 	 * shouldn't be used, so it isn't provided. */
 	BigUnsigned operator &(const BigUnsigned &x) const;
@@ -244,12 +291,12 @@ public:
  * copy-less operations.  The copy-less operations are responsible for making
  * any necessary temporary copies to work around aliasing. */
 
-inline BigUnsigned BigUnsigned::operator +(const BigUnsigned &x) const {
+inline BigUnsigned BigUnsigned::operator +(const BigUnsigned &x) BIGINT_CONST_LVALUE {
 	BigUnsigned ans;
 	ans.add(*this, x);
 	return ans;
 }
-inline BigUnsigned BigUnsigned::operator -(const BigUnsigned &x) const {
+inline BigUnsigned BigUnsigned::operator -(const BigUnsigned &x) BIGINT_CONST_LVALUE {
 	BigUnsigned ans;
 	ans.subtract(*this, x);
 	return ans;
@@ -259,14 +306,14 @@ inline BigUnsigned BigUnsigned::operator *(const BigUnsigned &x) const {
 	ans.multiply(*this, x);
 	return ans;
 }
-inline BigUnsigned BigUnsigned::operator /(const BigUnsigned &x) const {
+inline BigUnsigned BigUnsigned::operator /(const BigUnsigned &x) BIGINT_CONST_LVALUE {
 	if (x.isZero()) throw "BigUnsigned::operator /: division by zero";
 	BigUnsigned q, r;
 	r = *this;
 	r.divideWithRemainder(x, q);
 	return q;
 }
-inline BigUnsigned BigUnsigned::operator %(const BigUnsigned &x) const {
+inline BigUnsigned BigUnsigned::operator %(const BigUnsigned &x) BIGINT_CONST_LVALUE {
 	if (x.isZero()) throw "BigUnsigned::operator %: division by zero";
 	BigUnsigned q, r;
 	r = *this;
@@ -299,6 +346,47 @@ inline BigUnsigned BigUnsigned::operator >>(int b) const {
 	return ans;
 }
 
+#if __cplusplus >= 201103L
+/* An operand about to die receives the result itself; the dividend of /
+ * and % becomes the remainder without being copied first. */
+inline BigUnsigned BigUnsigned::operator +(const BigUnsigned &x) && {
+	add(*this, x);
+	return std::move(*this);
+}
+inline BigUnsigned BigUnsigned::operator +(BigUnsigned &&x) const & {
+	x.add(*this, x);
+	return std::move(x);
+}
+inline BigUnsigned BigUnsigned::operator +(BigUnsigned &&x) && {
+	add(*this, x);
+	return std::move(*this);
+}
+inline BigUnsigned BigUnsigned::operator -(const BigUnsigned &x) && {
+	subtract(*this, x);
+	return std::move(*this);
+}
+inline BigUnsigned BigUnsigned::operator -(BigUnsigned &&x) const & {
+	x.subtract(*this, x);
+	return std::move(x);
+}
+inline BigUnsigned BigUnsigned::operator -(BigUnsigned &&x) && {
+	subtract(*this, x);
+	return std::move(*this);
+}
+inline BigUnsigned BigUnsigned::operator /(const BigUnsigned &x) && {
+	if (x.isZero()) throw "BigUnsigned::operator /: division by zero";
+	BigUnsigned q;
+	divideWithRemainder(x, q);
+	return q;
+}
+inline BigUnsigned BigUnsigned::operator %(const BigUnsigned &x) && {
+	if (x.isZero()) throw "BigUnsigned::operator %: division by zero";
+	BigUnsigned q;
+	divideWithRemainder(x, q);
+	return std::move(*this);
+}
+#endif
+
 inline void BigUnsigned::operator +=(const BigUnsigned &x) {
 	add(*this, x);
 }
@@ -315,7 +403,7 @@ inline void BigUnsigned::operator /=(const BigUnsigned &x) {
 	BigUnsigned q;
 	divideWithRemainder(x, q);
 	// *this contains the remainder, but we overwrite it with the quotient.
-	*this = q;
+	*this = BIGINT_MOVE(q);
 }
 inline void BigUnsigned::operator %=(const BigUnsigned &x) {
 	if (x.isZero()) throw "BigUnsigned::operator %=: division by zero";
@@ -357,9 +445,7 @@ void BigUnsigned::initFromPrimitive(X x) {
 	if (x == 0)
 		; // NumberlikeArray already initialized us to zero.
 	else {
-		// Create a single block.  blk is NULL; no need to delete it.
-		cap = 1;
-		blk = new Blk[1];
+		// A single block fits in the inline storage.
 		len = 1;
 		blk[0] = Blk(x);
 	}
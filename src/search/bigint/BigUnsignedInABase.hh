@@ -63,6 +63,16 @@ public:
 		base = x.base;
 	}
 
+#if __cplusplus >= 201103L
+	// Move constructor and assignment; `x' is left zero in its base.
+	BigUnsignedInABase(BigUnsignedInABase &&x)
+		: NumberlikeArray<Digit>(std::move(x)), base(x.base) {}
+	void operator =(BigUnsignedInABase &&x) {
+		NumberlikeArray<Digit>::operator =(std::move(x));
+		base = x.base;
+	}
+#endif
+
 	// Constructor that copies from a given array of digits.
 	BigUnsignedInABase(const Digit *d, Index l, Base base);
 
@@ -6,9 +6,32 @@
 #define NULL 0
 #endif
 
-/* A NumberlikeArray<Blk> object holds a heap-allocated array of Blk with a
- * length and a capacity and provides basic memory management features.
- * BigUnsigned and BigUnsignedInABase both subclass it.
+/* With C++11, heap arrays come from a per-thread pool unless
+ * NUMBERLIKEARRAY_NO_POOL is defined; see `acquire' below. */
+#if __cplusplus >= 201103L && !defined(NUMBERLIKEARRAY_NO_POOL)
+#define NUMBERLIKEARRAY_POOL
+#endif
+
+/* The classes built on NumberlikeArray move values that are about to die
+ * under C++11 and still compile as C++98: `BIGINT_MOVE(x)' is std::move(x)
+ * or plain `x', and `BIGINT_CONST_LVALUE' qualifies member operators that
+ * have rvalue overloads as `const &' or plain `const'. */
+#if __cplusplus >= 201103L
+#include <utility>
+#define BIGINT_MOVE(x) std::move(x)
+#define BIGINT_CONST_LVALUE const &
+#else
+#define BIGINT_MOVE(x) (x)
+#define BIGINT_CONST_LVALUE const
+#endif
+
+/* A NumberlikeArray<Blk> object holds an array of Blk with a length and a
+ * capacity and provides basic memory management features.  BigUnsigned and
+ * BigUnsignedInABase both subclass it.
+ *
+ * Values of up to `inlineCap' blocks live in an array inside the object, so
+ * small numbers and the temporaries of arithmetic on them never touch the
+ * heap; only longer values get a heap-allocated array.
  *
  * NumberlikeArray provides no information hiding.  Subclasses should use
  * nonpublic inheritance and manually expose members as desired using
@@ -26,31 +49,49 @@ public:
 	// The number of bits in a block, defined below.
 	static const unsigned int N;
 
+	/* The number of blocks held inside the object: 32 bytes' worth, which
+	 * is four 64-bit blocks. */
+	enum { inlineCap = 32 / sizeof(Blk) };
+
 	// The current allocated capacity of this NumberlikeArray (in blocks)
 	Index cap;
 	// The actual length of the value stored in this NumberlikeArray (in blocks)
 	Index len;
-	// Heap-allocated array of the blocks (can be NULL if len == 0)
+	// The array of the blocks: `inlineBlk' or a heap-allocated array
 	Blk *blk;
+	// Storage for values of up to `inlineCap' blocks
+	Blk inlineBlk[inlineCap];
 
 	// Constructs a ``zero'' NumberlikeArray with the given capacity.
-	NumberlikeArray(Index c) : cap(c), len(0) { 
-		blk = (cap > 0) ? (new Blk[cap]) : NULL;
+	NumberlikeArray(Index c) : cap(inlineCap), len(0), blk(inlineBlk) {
+		allocate(c);
 	}
 
-	/* Constructs a zero NumberlikeArray without allocating a backing array.
-	 * A subclass that doesn't know the needed capacity at initialization
-	 * time can use this constructor and then overwrite blk without first
-	 * deleting it. */
-	NumberlikeArray() : cap(0), len(0) {
-		blk = NULL;
-	}
+	/* Constructs a zero NumberlikeArray without allocating a heap array.
+	 * Its capacity is `inlineCap', so a subclass can store up to that many
+	 * blocks right away. */
+	NumberlikeArray() : cap(inlineCap), len(0), blk(inlineBlk) {}
 
-	// Destructor.  Note that `delete NULL' is a no-op.
+	// Destructor.  Only a heap array needs to be given back.
 	~NumberlikeArray() {
-		delete [] blk;
+		if (!isInline())
+			release(blk, cap);
 	}
 
+	// Whether the blocks are in `inlineBlk'
+	bool isInline() const { return blk == inlineBlk; }
+
+	/* Returns a heap array of at least `c' blocks, c > inlineCap, and sets
+	 * `c' to its actual capacity.  With the pool, capacities are rounded
+	 * up to powers of two, and each thread keeps a few arrays of each size
+	 * up to `inlineCap << poolClasses' blocks that `release' has given
+	 * back, so a loop that keeps creating and dropping temporaries of
+	 * similar sizes stops calling `new' after the first round. */
+	static Blk *acquire(Index &c);
+
+	// Gives back an array that `acquire' returned with capacity `c'.
+	static void release(Blk *b, Index c);
+
 	/* Ensures that the array has at least the requested capacity; may
 	 * destroy the contents. */
 	void allocate(Index c);
@@ -65,6 +106,13 @@ public:
 	// Assignment operator
 	void operator=(const NumberlikeArray<Blk> &x);
 
+#if __cplusplus >= 201103L
+	/* Move constructor and assignment: a heap array changes hands, and `x'
+	 * is left zero with its inline storage. */
+	NumberlikeArray(NumberlikeArray<Blk> &&x);
+	void operator=(NumberlikeArray<Blk> &&x);
+#endif
+
 	// Constructor that copies from a given array of blocks
 	NumberlikeArray(const Blk *b, Index blen);
 
@@ -82,6 +130,33 @@ public:
 	bool operator !=(const NumberlikeArray<Blk> &x) const {
 		return !operator ==(x);
 	}
+
+#ifdef NUMBERLIKEARRAY_POOL
+	/* The pool's size classes are inlineCap << 1 to inlineCap << poolClasses
+	 * blocks (64 bytes to 32K for 64-bit blocks), and it keeps up to
+	 * `poolDepth' arrays of each. */
+	enum { poolClasses = 10, poolDepth = 8 };
+
+	/* A thread's pool.  It is trivially destructible so that it stays
+	 * usable until the thread is gone; a `PoolCloser' empties it when the
+	 * thread exits, after which arrays go straight back to the heap. */
+	struct Pool {
+		Blk *free[poolClasses][poolDepth];
+		Index count[poolClasses];
+		bool closed;
+	};
+	struct PoolCloser {
+		~PoolCloser();
+	};
+	static thread_local Pool threadPool;
+	static thread_local PoolCloser threadPoolCloser;
+
+	// The size class of capacity `c', or poolClasses if it has none
+	static unsigned int poolClass(Index c);
+
+	// This thread's pool, or NULL once it has been closed
+	static Pool *pool();
+#endif
 };
 
 /* BEGIN TEMPLATE DEFINITIONS.  They are present here so that source files that
@@ -90,15 +165,83 @@ public:
 template <class Blk>
 const unsigned int NumberlikeArray<Blk>::N = 8 * sizeof(Blk);
 
+#ifdef NUMBERLIKEARRAY_POOL
+template <class Blk>
+thread_local typename NumberlikeArray<Blk>::Pool
+	NumberlikeArray<Blk>::threadPool;
+
+template <class Blk>
+thread_local typename NumberlikeArray<Blk>::PoolCloser
+	NumberlikeArray<Blk>::threadPoolCloser;
+
+template <class Blk>
+NumberlikeArray<Blk>::PoolCloser::~PoolCloser() {
+	Pool &p = threadPool;
+	for (unsigned int k = 0; k < poolClasses; k++)
+		while (p.count[k] > 0)
+			delete [] p.free[k][--p.count[k]];
+	p.closed = true;
+}
+
+template <class Blk>
+unsigned int NumberlikeArray<Blk>::poolClass(Index c) {
+	unsigned int k = 0;
+	for (Index size = inlineCap * 2; size < c; size *= 2)
+		if (++k == poolClasses)
+			break;
+	return k;
+}
+
+template <class Blk>
+typename NumberlikeArray<Blk>::Pool *NumberlikeArray<Blk>::pool() {
+	// Touching the closer makes sure it is constructed, and so destroyed.
+	(void) &threadPoolCloser;
+	return threadPool.closed ? NULL : &threadPool;
+}
+#endif
+
+template <class Blk>
+Blk *NumberlikeArray<Blk>::acquire(Index &c) {
+#ifdef NUMBERLIKEARRAY_POOL
+	unsigned int k = poolClass(c);
+	if (k < poolClasses) {
+		c = Index(inlineCap) << (k + 1);
+		Pool *p = pool();
+		if (p != NULL && p->count[k] > 0)
+			return p->free[k][--p->count[k]];
+	}
+#endif
+	return new Blk[c];
+}
+
+template <class Blk>
+void NumberlikeArray<Blk>::release(Blk *b, Index c) {
+#ifdef NUMBERLIKEARRAY_POOL
+	// Only the pool's own sizes are exact powers of two times inlineCap.
+	unsigned int k = poolClass(c);
+	if (k < poolClasses && c == Index(inlineCap) << (k + 1)) {
+		Pool *p = pool();
+		if (p != NULL && p->count[k] < poolDepth) {
+			p->free[k][p->count[k]++] = b;
+			return;
+		}
+	}
+#else
+	(void) c;
+#endif
+	delete [] b;
+}
+
 template <class Blk>
 void NumberlikeArray<Blk>::allocate(Index c) {
 	// If the requested capacity is more than the current capacity...
 	if (c > cap) {
-		// Delete the old number array
-		delete [] blk;
+		// Give back the old heap array, if any
+		if (!isInline())
+			release(blk, cap);
 		// Allocate the new array
+		blk = acquire(c);
 		cap = c;
-		blk = new Blk[cap];
 	}
 }
 
@@ -107,24 +250,26 @@ void NumberlikeArray<Blk>::allocateAndCopy(Index c) {
 	// If the requested capacity is more than the current capacity...
 	if (c > cap) {
 		Blk *oldBlk = blk;
+		bool wasInline = isInline();
+		Index oldCap = cap;
 		// Allocate the new number array
+		blk = acquire(c);
 		cap = c;
-		blk = new Blk[cap];
 		// Copy number blocks
 		Index i;
 		for (i = 0; i < len; i++)
 			blk[i] = oldBlk[i];
-		// Delete the old array
-		delete [] oldBlk;
+		// Give back the old heap array, if any
+		if (!wasInline)
+			release(oldBlk, oldCap);
 	}
 }
 
 template <class Blk>
 NumberlikeArray<Blk>::NumberlikeArray(const NumberlikeArray<Blk> &x)
-		: len(x.len) {
+		: cap(inlineCap), len(x.len), blk(inlineBlk) {
 	// Create array
-	cap = len;
-	blk = new Blk[cap];
+	allocate(len);
 	// Copy blocks
 	Index i;
 	for (i = 0; i < len; i++)
@@ -147,11 +292,48 @@ void NumberlikeArray<Blk>::operator=(const NumberlikeArray<Blk> &x) {
 		blk[i] = x.blk[i];
 }
 
+#if __cplusplus >= 201103L
+template <class Blk>
+NumberlikeArray<Blk>::NumberlikeArray(NumberlikeArray<Blk> &&x)
+		: cap(inlineCap), len(x.len), blk(inlineBlk) {
+	if (x.isInline()) {
+		// Inline blocks can only be copied.
+		Index i;
+		for (i = 0; i < len; i++)
+			blk[i] = x.blk[i];
+	} else {
+		cap = x.cap;
+		blk = x.blk;
+		x.cap = inlineCap;
+		x.blk = x.inlineBlk;
+	}
+	x.len = 0;
+}
+
+template <class Blk>
+void NumberlikeArray<Blk>::operator=(NumberlikeArray<Blk> &&x) {
+	if (this == &x)
+		return;
+	if (x.isInline())
+		operator =(static_cast<const NumberlikeArray<Blk> &>(x));
+	else {
+		if (!isInline())
+			release(blk, cap);
+		cap = x.cap;
+		len = x.len;
+		blk = x.blk;
+		x.cap = inlineCap;
+		x.blk = x.inlineBlk;
+	}
+	x.len = 0;
+}
+#endif
+
 template <class Blk>
 NumberlikeArray<Blk>::NumberlikeArray(const Blk *b, Index blen)
-		: cap(blen), len(blen) {
+		: cap(inlineCap), len(blen), blk(inlineBlk) {
 	// Create array
-	blk = new Blk[cap];
+	allocate(len);
 	// Copy blocks
 	Index i;
 	for (i = 0; i < len; i++)
@@ -0,0 +1,200 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+//
+//   bigmodexp_bench
+//
+// Checks modexp, in Montgomery form for odd moduli and with Barrett
+// reduction for even ones, and modexpConstantTime against the square and
+// multiply with a full % after each step that modexp used to be, on random
+// and edge-case moduli, bases and exponents; then times the old loop, the
+// sliding windows and the constant-time variant on 1024-, 2048- and
+// 4096-bit moduli, with full-length exponents and with 65537.
+
+#include <stdio.h>
+#include <vector>
+
+#include "bigint/BigIntegerLibrary.hh"
+#include "bench.h"
+
+typedef BigUnsigned::Blk Blk;
+typedef BigUnsigned::Index Index;
+
+static Blk rand_blk()
+{
+    Blk x = 0;
+    for (unsigned int i = 0; i < sizeof(Blk); i += 4)
+        x = (x << 16 << 16) | bench_rand();
+    return x;
+}
+
+static BigUnsigned rand_big(Index n)
+{
+    if (n == 0)
+        return BigUnsigned();
+    std::vector<Blk> b(n);
+    for (Index i = 0; i < n; i++)
+        b[i] = rand_blk();
+    if (b[n - 1] == 0)
+        b[n - 1] = 1;
+    return BigUnsigned(&b[0], n);
+}
+
+// a random `bits'-bit modulus with its top bit set, odd or even
+static BigUnsigned rand_modulus(Index bits, bool odd)
+{
+    BigUnsigned m = rand_big((bits + BigUnsigned::N - 1) / BigUnsigned::N);
+    m %= BigUnsigned(1) << int(bits);
+    m.setBit(bits - 1, true);
+    m.setBit(0, odd);
+    return m;
+}
+
+// the modexp that was: square and multiply, reducing after every step
+static BigUnsigned old_modexp(const BigInteger & base,
+                              const BigUnsigned & exponent,
+                              const BigUnsigned & modulus)
+{
+    BigUnsigned ans = 1, base2 = (base % modulus).getMagnitude();
+    Index i = exponent.bitLength();
+    while (i > 0) {
+        i--;
+        ans *= ans;
+        ans %= modulus;
+        if (exponent.getBit(i)) {
+            ans *= base2;
+            ans %= modulus;
+        }
+    }
+    return ans;
+}
+
+static int compare(const BigInteger & x, const BigUnsigned & e,
+                   const BigUnsigned & m)
+{
+    // the old loop leaves 1 unreduced for e == 0
+    BigUnsigned want = old_modexp(x, e, m) % m;
+    int bad = 0;
+    if (modexp(x, e, m) != want) {
+        printf("ERROR: modexp wrong for a %u-block %s modulus\n",
+               m.getLength(), m.getBit(0) ? "odd" : "even");
+        bad++;
+    }
+    if (m.getBit(0) && modexpConstantTime(x, e, m) != want) {
+        printf("ERROR: modexpConstantTime wrong for a %u-block modulus\n",
+               m.getLength());
+        bad++;
+    }
+    return bad;
+}
+
+static int check()
+{
+    int bad = 0, count = 0;
+    for (int round = 0; round < 1500 && bad < 5; round++) {
+        Index mn = 1 + bench_rand() % ((round % 3 == 0) ? 2 : 24);
+        BigUnsigned m = rand_big(mn);
+        switch (round % 6) {
+        case 0: m.setBit(0, true); break;
+        case 1: m.setBit(0, false); break;
+        // B^(n-1), whose Barrett reciprocal is one block longer
+        case 2: m = BigUnsigned(1) << int((mn - 1) * BigUnsigned::N); break;
+        // all ones, odd
+        case 3: m = (BigUnsigned(1) << int(mn * BigUnsigned::N)) - 1; break;
+        default: break;
+        }
+        if (m.isZero())
+            m = 1;
+        BigInteger x(rand_big(1 + bench_rand() % (2 * mn)),
+                     (round % 4 == 0) ? BigInteger::negative
+                                      : BigInteger::positive);
+        if (round % 10 == 0)
+            x = 0;
+        BigUnsigned e = rand_big(bench_rand() % 5);
+        if (round % 11 == 0)
+            e = bench_rand() % 4;
+        bad += compare(x, e, m);
+        count++;
+    }
+
+    // tiny moduli, and one large one of each kind
+    const unsigned long tiny[] = {1, 2, 3, 4, 5, 7, 8, 9};
+    for (size_t i = 0; i < sizeof(tiny) / sizeof(tiny[0]); i++)
+        for (int x = -3; x <= 3; x++)
+            for (unsigned int e = 0; e < 5; e++, count++)
+                bad += compare(x, e, tiny[i]);
+    for (int odd = 0; odd < 2; odd++, count++)
+        bad += compare(rand_big(40), rand_big(32), rand_modulus(2048, odd));
+
+    // Fermat: 2^(p-1) == 1 mod p for the prime 2^127 - 1
+    BigUnsigned p = (BigUnsigned(1) << 127) - 1;
+    count += 2;
+    if (modexp(2, p - 1, p) != 1 || modexpConstantTime(2, p - 1, p) != 1) {
+        printf("ERROR: Fermat's little theorem fails\n");
+        bad++;
+    }
+    // an even modulus has no constant-time path
+    count++;
+    try {
+        modexpConstantTime(3, 5, 10);
+        printf("ERROR: even modulus accepted\n");
+        bad++;
+    } catch (const char *) {
+    }
+    printf("%d results checked, %d wrong\n", count, bad);
+    return bad;
+}
+
+enum Method { OLD, MODEXP, CONSTANT_TIME };
+
+// seconds per call, repeated for at least 0.2 seconds
+static double time_modexp(Method how, const BigUnsigned & x,
+                          const BigUnsigned & e, const BigUnsigned & m)
+{
+    BigUnsigned r;
+    int reps = 0;
+    double start = now_sec(), elapsed;
+    do {
+        if (how == OLD)
+            r = old_modexp(x, e, m);
+        else if (how == MODEXP)
+            r = modexp(x, e, m);
+        else
+            r = modexpConstantTime(x, e, m);
+        reps++;
+        elapsed = now_sec() - start;
+    } while (elapsed < 0.2);
+    return elapsed / reps;
+}
+
+int main()
+{
+    if (check() != 0)
+        return 1;
+
+    printf("\n%-20s %12s %12s %12s %8s\n", "", "old", "windows",
+           "const-time", "speedup");
+    const Index sizes[] = {1024, 2048, 4096};
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        Index bits = sizes[s];
+        for (int odd = 1; odd >= 0; odd--) {
+            BigUnsigned m = rand_modulus(bits, odd);
+            BigUnsigned x = rand_big(m.getLength()) % m;
+            const BigUnsigned exps[] = {rand_big(m.getLength()) % m, 65537};
+            for (int j = 0; j < 2; j++) {
+                char name[64];
+                snprintf(name, sizeof(name), "%u-bit %s, e %s", bits,
+                         odd ? "odd" : "even", j ? "65537" : "full");
+                double old = time_modexp(OLD, x, exps[j], m);
+                double fast = time_modexp(MODEXP, x, exps[j], m);
+                if (odd) {
+                    double ct = time_modexp(CONSTANT_TIME, x, exps[j], m);
+                    printf("%-20s %10.0fus %10.0fus %10.0fus %7.1fx\n",
+                           name, old * 1e6, fast * 1e6, ct * 1e6,
+                           old / fast);
+                } else
+                    printf("%-20s %10.0fus %10.0fus %12s %7.1fx\n", name,
+                           old * 1e6, fast * 1e6, "-", old / fast);
+            }
+        }
+    }
+    return 0;
+}
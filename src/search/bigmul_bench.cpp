@@ -0,0 +1,295 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+//
+//   bigmul_bench [tune | curve [BLOCKS]]
+//
+// Checks BigUnsigned::multiply against the bit-by-bit shift-and-add it
+// replaced, at every threshold setting, and the transform multiplication
+// against Toom-3 up to 64K blocks; then times the old algorithm,
+// schoolbook, Karatsuba and the default thresholds from 8 to 8192 blocks.
+// With "tune" it finds the Karatsuba, Toom-3 and transform thresholds
+// instead: the smallest sizes at which one level of the faster algorithm
+// beats the slower one, the values to put in bigint/BigUnsigned.cc.  With
+// "curve" it times Toom-3 and the transform from 1K blocks up to BLOCKS
+// (10M by default), checking the largest square against its closed form.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "bigint/BigIntegerLibrary.hh"
+#include "bench.h"
+
+typedef BigUnsigned::Blk Blk;
+typedef BigUnsigned::Index Index;
+
+static const Index NEVER = ~Index(0);
+
+static Blk rand_blk()
+{
+    Blk x = 0;
+    for (unsigned int i = 0; i < sizeof(Blk); i += 4)
+        x = (x << 16 << 16) | bench_rand();
+    return x;
+}
+
+// n random blocks, or n all-ones blocks for the longest carry chains
+static BigUnsigned rand_big(Index n, bool ones = false)
+{
+    std::vector<Blk> b(n);
+    for (Index i = 0; i < n; i++)
+        b[i] = ones ? ~Blk(0) : rand_blk();
+    if (b[n - 1] == 0)
+        b[n - 1] = 1;
+    return BigUnsigned(&b[0], n);
+}
+
+static std::vector<Blk> blocks(const BigUnsigned & x)
+{
+    std::vector<Blk> b(x.getLength() + 1, 0);
+    for (Index i = 0; i < x.getLength(); i++)
+        b[i] = x.getBlock(i);
+    return b;
+}
+
+// the multiply loop BigUnsigned used to have: for each 1 bit of a, add
+// b shifted left by that bit's position
+static BigUnsigned shift_add_multiply(const BigUnsigned & a,
+                                      const BigUnsigned & b)
+{
+    std::vector<Blk> x = blocks(a), y = blocks(b);
+    Index an = a.getLength(), bn = b.getLength();
+    std::vector<Blk> r(an + bn + 1, 0);
+    const unsigned int N = BigUnsigned::N;
+    for (Index i = 0; i < an; i++) {
+        for (unsigned int i2 = 0; i2 < N; i2++) {
+            if ((x[i] & (Blk(1) << i2)) == 0)
+                continue;
+            bool carryIn = false;
+            Index k = i;
+            for (Index j = 0; j <= bn; j++, k++) {
+                Blk lo = (j == 0 || i2 == 0) ? 0 : y[j - 1] >> (N - i2);
+                Blk shifted = lo | (y[j] << i2);
+                Blk temp = r[k] + shifted;
+                bool carryOut = temp < r[k];
+                if (carryIn) {
+                    temp++;
+                    carryOut |= (temp == 0);
+                }
+                r[k] = temp;
+                carryIn = carryOut;
+            }
+            for (; carryIn; k++) {
+                r[k]++;
+                carryIn = (r[k] == 0);
+            }
+        }
+    }
+    return BigUnsigned(&r[0], an + bn);
+}
+
+static void set_thresholds(Index karatsuba, Index toom3, Index ntt)
+{
+    BigUnsigned::karatsubaThreshold = karatsuba;
+    BigUnsigned::toom3Threshold = toom3;
+    BigUnsigned::nttThreshold = ntt;
+}
+
+static int check()
+{
+    // the defaults, schoolbook only, the smallest thresholds allowed,
+    // which send every product down the deepest recursion, and the
+    // transform for everything past schoolbook
+    Index karatsuba = BigUnsigned::karatsubaThreshold;
+    Index toom3 = BigUnsigned::toom3Threshold;
+    Index ntt = BigUnsigned::nttThreshold;
+    const Index settings[][3] = {
+        {karatsuba, toom3, ntt}, {NEVER, NEVER, NEVER}, {2, 5, NEVER},
+        {4, 12, NEVER}, {2, NEVER, NEVER}, {2, 5, 2}};
+    int bad = 0, count = 0;
+
+    for (int round = 0; round < 400; round++) {
+        Index an = 1 + bench_rand() % 300;
+        Index bn = (round % 3 == 0) ? an : 1 + bench_rand() % 300;
+        BigUnsigned a = rand_big(an, round % 7 == 0);
+        BigUnsigned b = rand_big(bn, round % 11 == 0);
+        BigUnsigned want = shift_add_multiply(a, b);
+        for (size_t s = 0; s < sizeof(settings) / sizeof(settings[0]); s++) {
+            set_thresholds(settings[s][0], settings[s][1], settings[s][2]);
+            BigUnsigned got = a * b;
+            count++;
+            if (got != want) {
+                if (bad++ < 5)
+                    printf("ERROR: %u x %u blocks wrong at thresholds "
+                           "%u/%u/%u\n", an, bn, settings[s][0],
+                           settings[s][1], settings[s][2]);
+            }
+        }
+    }
+
+    // the transform against Toom-3, squares and all-ones operands included
+    for (int round = 0; round < 24; round++) {
+        Index an = 1024 + bench_rand() % 65536;
+        Index bn = (round % 3 == 0) ? an : 1024 + bench_rand() % an;
+        BigUnsigned a = rand_big(an, round % 4 == 1);
+        BigUnsigned b = (round % 6 == 0) ? a : rand_big(bn, round % 4 == 1);
+        set_thresholds(karatsuba, toom3, NEVER);
+        BigUnsigned want = a * b;
+        set_thresholds(karatsuba, toom3, 1024);
+        count++;
+        if (a * b != want) {
+            if (bad++ < 5)
+                printf("ERROR: %u x %u blocks wrong by transform\n", an,
+                       b.getLength());
+        }
+    }
+    set_thresholds(karatsuba, toom3, ntt);
+
+    // aliased and mixed-sign products go through the same code
+    BigUnsigned a = rand_big(200);
+    BigUnsigned want = shift_add_multiply(a, a);
+    a *= a;
+    BigInteger neg(rand_big(150), BigInteger::negative);
+    BigInteger pos(rand_big(90));
+    BigInteger p = neg * pos;
+    if (a != want || p.getSign() != BigInteger::negative ||
+        p.getMagnitude() != shift_add_multiply(neg.getMagnitude(),
+                                               pos.getMagnitude())) {
+        printf("ERROR: aliased or signed product wrong\n");
+        bad++;
+    }
+    printf("%d products checked, %d wrong\n", count, bad);
+    return bad;
+}
+
+// seconds per a * b, repeated for at least a tenth of a second
+static double time_multiply(const BigUnsigned & a, const BigUnsigned & b,
+                            bool old = false)
+{
+    BigUnsigned r;
+    int reps = 0;
+    double start = now_sec(), elapsed;
+    do {
+        if (old)
+            r = shift_add_multiply(a, b);
+        else
+            r.multiply(a, b);
+        reps++;
+        elapsed = now_sec() - start;
+    } while (elapsed < 0.1);
+    return elapsed / reps;
+}
+
+static void timings()
+{
+    Index karatsuba = BigUnsigned::karatsubaThreshold;
+    Index toom3 = BigUnsigned::toom3Threshold;
+    Index ntt = BigUnsigned::nttThreshold;
+    printf("\n%6s %12s %12s %12s %12s %8s\n", "blocks", "shift-add",
+           "schoolbook", "karatsuba", "default", "speedup");
+    for (Index n = 8; n <= 8192; n *= 2) {
+        BigUnsigned a = rand_big(n), b = rand_big(n);
+        double old = (n <= 1024) ? time_multiply(a, b, true) : 0;
+        set_thresholds(NEVER, NEVER, NEVER);
+        double school = time_multiply(a, b);
+        set_thresholds(karatsuba, NEVER, NEVER);
+        double kara = time_multiply(a, b);
+        set_thresholds(karatsuba, toom3, ntt);
+        double best = time_multiply(a, b);
+        if (old > 0)
+            printf("%6u %10.1fus %10.1fus %10.1fus %10.1fus %7.0fx\n", n,
+                   old * 1e6, school * 1e6, kara * 1e6, best * 1e6,
+                   old / best);
+        else
+            printf("%6u %12s %10.1fus %10.1fus %10.1fus %8s\n", n, "-",
+                   school * 1e6, kara * 1e6, best * 1e6, "-");
+    }
+}
+
+// the first n of [from, to) at which one more level of the algorithm
+// that `threshold' selects (threshold n) beats leaving n to the one below
+// (threshold n + 1) twice running
+static Index crossover(Index from, Index to, Index step, Index * threshold)
+{
+    int wins = 0;
+    for (Index n = from; n < to; n += step) {
+        BigUnsigned a = rand_big(n), b = rand_big(n);
+        double t[2];
+        for (int faster = 0; faster < 2; faster++) {
+            *threshold = faster ? n : n + 1;
+            t[faster] = time_multiply(a, b);
+        }
+        printf("  %5u blocks %10.2fus %10.2fus\n", n, t[0] * 1e6, t[1] * 1e6);
+        if (t[1] < t[0]) {
+            if (++wins == 2)
+                return n - step;
+        } else {
+            wins = 0;
+        }
+    }
+    return to;
+}
+
+static void tune()
+{
+    printf("karatsuba: schoolbook vs one level of Karatsuba\n");
+    set_thresholds(NEVER, NEVER, NEVER);
+    Index karatsuba = crossover(4, 128, 2, &BigUnsigned::karatsubaThreshold);
+    printf("toom-3: Karatsuba vs one level of Toom-3\n");
+    set_thresholds(karatsuba, NEVER, NEVER);
+    Index toom3 = crossover(karatsuba, 1024, 8, &BigUnsigned::toom3Threshold);
+    printf("ntt: Toom-3 vs the transform\n");
+    set_thresholds(karatsuba, toom3, NEVER);
+    Index ntt = crossover(256, 16384, 256, &BigUnsigned::nttThreshold);
+    printf("karatsubaThreshold = %u, toom3Threshold = %u, "
+           "nttThreshold = %u\n", karatsuba, toom3, ntt);
+    set_thresholds(karatsuba, toom3, ntt);
+}
+
+// Toom-3 (to 1M blocks) and the transform from 1K blocks to max_blocks;
+// then (B^n - 1)^2 = B^2n - 2 B^n + 1 with n = max_blocks, whose
+// transform coefficients are as large as they get
+static int curve(Index max_blocks)
+{
+    Index ntt = BigUnsigned::nttThreshold;
+    printf("%9s %12s %12s %8s\n", "blocks", "toom-3", "ntt", "speedup");
+    for (Index n = 1024; n <= max_blocks; n = (n * 2 > max_blocks &&
+         n < max_blocks) ? max_blocks : n * 2) {
+        BigUnsigned a = rand_big(n), b = rand_big(n);
+        BigUnsigned::nttThreshold = NEVER;
+        double toom3 = (n <= (1U << 20)) ? time_multiply(a, b) : 0;
+        BigUnsigned::nttThreshold = 1;
+        double transform = time_multiply(a, b);
+        if (toom3 > 0)
+            printf("%9u %10.3fms %10.3fms %7.1fx\n", n, toom3 * 1e3,
+                   transform * 1e3, toom3 / transform);
+        else
+            printf("%9u %12s %10.3fms %8s\n", n, "-", transform * 1e3, "-");
+    }
+    BigUnsigned::nttThreshold = ntt;
+
+    BigUnsigned ones = rand_big(max_blocks, true);
+    BigUnsigned square = ones * ones;
+    bool ok = square.getLength() == 2 * max_blocks &&
+              square.getBlock(0) == 1 &&
+              square.getBlock(max_blocks) == ~Blk(1);
+    for (Index i = 1; ok && i < 2 * max_blocks; i++)
+        if (i != max_blocks)
+            ok = square.getBlock(i) == ((i < max_blocks) ? 0 : ~Blk(0));
+    printf("(B^%u - 1)^2 %s\n", max_blocks, ok ? "ok" : "WRONG");
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "tune") == 0) {
+        tune();
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "curve") == 0)
+        return curve(argc > 2 ? atoi(argv[2]) : 10000000);
+    if (check() != 0)
+        return 1;
+    timings();
+    return 0;
+}
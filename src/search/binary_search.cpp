@@ -7,19 +7,23 @@
 
 typedef std::vector<int> RandNumList;
 
-static void binary_search(RandNumList list, int low, int high, int key) 
+// list[low..high], both ends included
+static void binary_search(const RandNumList & list, int low, int high,
+                          int key)
 {
-    int mid = (high + low) / 2;
-    if (low > high || mid <= low || mid >= high) 
+    if (low > high) {
+        printf("%d not found\n", key);
         return;
+    }
+    int mid = low + (high - low) / 2;
     if (key == list[mid]) {
         printf("Found %d at %d\n", key, mid);
         return;
     }
     if (key < list[mid]) 
-        binary_search(list, low, mid, key);
+        binary_search(list, low, mid - 1, key);
     else 
-        binary_search(list, mid, high, key);
+        binary_search(list, mid + 1, high, key);
 }
 
 int main(int argc, char* argv[]) 
@@ -30,7 +34,7 @@ int main(int argc, char* argv[])
     }
     std::sort(numList.begin(), numList.end());
     printf("DEBUG: ");
-    for (int i = 0; i < numList.size(); i++) {
+    for (size_t i = 0; i < numList.size(); i++) {
         printf("%d\t", numList[i]);
     }
     printf("\n");
@@ -0,0 +1,32 @@
+/* Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com> */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "btree.h"
+
+typedef BTree<int, int> tree_t;
+
+void travel_tree(const tree_t & tree)
+{
+    tree.for_each([](int key, int) { printf("%d\t", key); });
+}
+
+int main(int argc, char *argv[])
+{
+    tree_t tree;
+    int key = argv[1] ? atoi(argv[1]) : 67;
+    for (int i = 0; i < 1024; i++) {
+        tree.insert(rand() % 100, i);
+    }
+    travel_tree(tree);
+    printf("\n");
+    int *found = tree.search(key);
+    if (found)
+        printf("search %d: inserted as number %d\n", key, *found);
+    else
+        printf("search %d: not found\n", key);
+    printf("keys in [%d, %d]: %zu\n", key - 10, key + 10,
+           tree.count(key - 10, key + 10));
+    return 0;
+}
@@ -0,0 +1,516 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#ifndef __BTREE_H__
+#define __BTREE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <new>
+
+#include "slab_pool.h"
+
+// bytes of a node, four cache lines
+#define BTREE_NODE_BYTES    256
+// entries of size per that fit in a node after a header of size head, at
+// least 4 so that splits and merges work whatever the types
+#define BTREE_FIT(head, per) \
+    ((BTREE_NODE_BYTES - (head)) / (per) > 4 ? \
+     (BTREE_NODE_BYTES - (head)) / (per) : 4)
+
+// Ordered map as a B+ tree: every entry is in a leaf, the leaves are
+// linked in key order for iteration and range queries, and the inner
+// nodes only hold the keys that route a search. A node is 256 bytes,
+// about 29 int keys and values in a leaf and 20 keys in an inner node,
+// so a million keys are 5 levels deep whatever order they came in, and
+// each level is a few cache lines read one after the other rather than a
+// pointer per comparison. Nodes come from one SlabPool for the leaves and
+// one for the inner nodes.
+//
+// insert() splits every full node on its way down and erase() tops up
+// every node at its minimum on its way down, by borrowing from a sibling
+// or merging with one, so neither ever has to climb back up.
+template <typename Key, typename Value, typename Less = std::less<Key> >
+class BTree
+{
+    struct Node;
+    struct Leaf;
+
+public:
+    // in order from a leaf on; it stays valid until the tree is changed
+    class Iterator
+    {
+    public:
+        bool valid() const { return m_leaf != NULL; }
+        const Key & key() const { return m_leaf->keys[m_pos]; }
+        Value & value() const { return m_leaf->values[m_pos]; }
+        void next()
+        {
+            if (++m_pos == m_leaf->count) {
+                m_leaf = m_leaf->next;
+                m_pos = 0;
+            }
+        }
+
+    private:
+        friend class BTree;
+
+        Iterator(Leaf* leaf, int pos) : m_leaf(leaf), m_pos(pos) {}
+
+        Leaf* m_leaf;
+        int m_pos;
+    };
+
+    BTree()
+      : m_root(NULL),
+        m_first(NULL),
+        m_size(0),
+        m_height(0),
+        m_leafPool(sizeof(Leaf)),
+        m_innerPool(sizeof(Inner))
+    {
+    }
+
+    ~BTree()
+    {
+        clear();
+    }
+
+    size_t size() const { return m_size; }
+    // levels, 0 when empty
+    int height() const { return m_height; }
+    // bytes of the nodes in use
+    size_t bytes() const
+    {
+        return m_leafPool.used() * m_leafPool.block_size() +
+               m_innerPool.used() * m_innerPool.block_size();
+    }
+
+    void clear()
+    {
+        if (m_root)
+            m_destroy(m_root);
+        m_root = NULL;
+        m_first = NULL;
+        m_size = 0;
+        m_height = 0;
+    }
+
+    // NULL when key is not there
+    Value* search(const Key & key) const
+    {
+        if (!m_root)
+            return NULL;
+        Leaf* leaf = m_find_leaf(key);
+        int pos = m_lower(leaf->keys, leaf->count, key);
+        if (pos < leaf->count && !m_less(key, leaf->keys[pos]))
+            return &leaf->values[pos];
+        return NULL;
+    }
+
+    bool contains(const Key & key) const { return search(key) != NULL; }
+
+    // false, leaving the value alone, when key is already there
+    bool insert(const Key & key, const Value & value)
+    {
+        if (!m_root) {
+            m_first = m_new_leaf();
+            m_root = m_first;
+            m_height = 1;
+        }
+        if (m_full(m_root)) {
+            Inner* root = m_new_inner();
+            root->children[0] = m_root;
+            m_root = root;
+            m_height++;
+            m_split(root, 0);
+        }
+        Node* node = m_root;
+        while (!node->leaf) {
+            Inner* inner = (Inner*)node;
+            int i = m_upper(inner->keys, inner->count, key);
+            if (m_full(inner->children[i])) {
+                m_split(inner, i);
+                if (!m_less(key, inner->keys[i]))
+                    i++;
+            }
+            node = inner->children[i];
+        }
+        Leaf* leaf = (Leaf*)node;
+        int pos = m_lower(leaf->keys, leaf->count, key);
+        if (pos < leaf->count && !m_less(key, leaf->keys[pos]))
+            return false;
+        for (int j = leaf->count; j > pos; j--) {
+            leaf->keys[j] = leaf->keys[j - 1];
+            leaf->values[j] = leaf->values[j - 1];
+        }
+        leaf->keys[pos] = key;
+        leaf->values[pos] = value;
+        leaf->count++;
+        m_size++;
+        return true;
+    }
+
+    bool erase(const Key & key)
+    {
+        if (!m_root)
+            return false;
+        Node* node = m_root;
+        while (!node->leaf) {
+            Inner* inner = (Inner*)node;
+            int i = m_upper(inner->keys, inner->count, key);
+            if (inner->children[i]->count <= m_min(inner->children[i]))
+                i = m_fix(inner, i);
+            // a merge can take the last key of the root
+            if (inner == m_root && inner->count == 0) {
+                m_root = inner->children[0];
+                m_delete_inner(inner);
+                m_height--;
+                node = m_root;
+                continue;
+            }
+            node = inner->children[i];
+        }
+        Leaf* leaf = (Leaf*)node;
+        int pos = m_lower(leaf->keys, leaf->count, key);
+        if (pos == leaf->count || m_less(key, leaf->keys[pos]))
+            return false;
+        for (int j = pos + 1; j < leaf->count; j++) {
+            leaf->keys[j - 1] = leaf->keys[j];
+            leaf->values[j - 1] = leaf->values[j];
+        }
+        leaf->count--;
+        m_size--;
+        if (leaf->count == 0) {
+            // only the root can run empty
+            m_delete_leaf(leaf);
+            m_root = NULL;
+            m_first = NULL;
+            m_height = 0;
+        }
+        return true;
+    }
+
+    Iterator begin() const
+    {
+        return Iterator(m_first, 0);
+    }
+
+    // the first entry whose key is not less than key
+    Iterator lower_bound(const Key & key) const
+    {
+        if (!m_root)
+            return Iterator(NULL, 0);
+        Leaf* leaf = m_find_leaf(key);
+        int pos = m_lower(leaf->keys, leaf->count, key);
+        if (pos == leaf->count)
+            return Iterator(leaf->next, 0);
+        return Iterator(leaf, pos);
+    }
+
+    // func(key, value) for every entry in [low, high], in order; returns
+    // how many there were
+    template <typename Func>
+    size_t range(const Key & low, const Key & high, Func func) const
+    {
+        size_t count = 0;
+        for (Iterator it = lower_bound(low);
+             it.valid() && !m_less(high, it.key()); it.next()) {
+            func(it.key(), it.value());
+            count++;
+        }
+        return count;
+    }
+
+    size_t count(const Key & low, const Key & high) const
+    {
+        return range(low, high, [](const Key &, const Value &) {});
+    }
+
+    template <typename Func>
+    void for_each(Func func) const
+    {
+        for (Iterator it = begin(); it.valid(); it.next())
+            func(it.key(), it.value());
+    }
+
+private:
+    BTree(const BTree &);
+    BTree & operator=(const BTree &);
+
+    enum {
+        LEAF_MAX = BTREE_FIT(8 + 2 * sizeof(void*),
+                             sizeof(Key) + sizeof(Value)),
+        INNER_MAX = BTREE_FIT(8 + sizeof(void*),
+                              sizeof(Key) + sizeof(void*)),
+        // a node with fewer than this many keys is topped up before
+        // erase() goes into it; two at the minimum, and for inner nodes
+        // the key between them, still fit in one node
+        LEAF_MIN = LEAF_MAX / 2,
+        INNER_MIN = (INNER_MAX - 1) / 2
+    };
+
+    struct Node {
+        uint16_t count;
+        bool leaf;
+    };
+
+    struct Leaf : Node {
+        Leaf* prev;
+        Leaf* next;
+        Key keys[LEAF_MAX];
+        Value values[LEAF_MAX];
+    };
+
+    // keys[i] is the smallest key under children[i + 1]
+    struct Inner : Node {
+        Key keys[INNER_MAX];
+        Node* children[INNER_MAX + 1];
+    };
+
+    // how many keys are less than key, and how many are not greater; a
+    // loop without an early exit, which the compiler can vectorize
+    int m_lower(const Key* keys, int count, const Key & key) const
+    {
+        int n = 0;
+        for (int i = 0; i < count; i++)
+            n += m_less(keys[i], key);
+        return n;
+    }
+    int m_upper(const Key* keys, int count, const Key & key) const
+    {
+        int n = 0;
+        for (int i = 0; i < count; i++)
+            n += !m_less(key, keys[i]);
+        return n;
+    }
+
+    Leaf* m_find_leaf(const Key & key) const
+    {
+        Node* node = m_root;
+        while (!node->leaf) {
+            Inner* inner = (Inner*)node;
+            node = inner->children[m_upper(inner->keys, inner->count, key)];
+        }
+        return (Leaf*)node;
+    }
+
+    static bool m_full(const Node* node)
+    {
+        return node->count == (node->leaf ? LEAF_MAX : INNER_MAX);
+    }
+    static int m_min(const Node* node)
+    {
+        return node->leaf ? LEAF_MIN : INNER_MIN;
+    }
+
+    Leaf* m_new_leaf()
+    {
+        Leaf* leaf = new (m_leafPool.alloc()) Leaf;
+        leaf->count = 0;
+        leaf->leaf = true;
+        leaf->prev = NULL;
+        leaf->next = NULL;
+        return leaf;
+    }
+    Inner* m_new_inner()
+    {
+        Inner* inner = new (m_innerPool.alloc()) Inner;
+        inner->count = 0;
+        inner->leaf = false;
+        return inner;
+    }
+    void m_delete_leaf(Leaf* leaf)
+    {
+        leaf->~Leaf();
+        m_leafPool.free(leaf);
+    }
+    void m_delete_inner(Inner* inner)
+    {
+        inner->~Inner();
+        m_innerPool.free(inner);
+    }
+
+    void m_destroy(Node* node)
+    {
+        if (node->leaf) {
+            m_delete_leaf((Leaf*)node);
+            return;
+        }
+        Inner* inner = (Inner*)node;
+        for (int i = 0; i <= inner->count; i++)
+            m_destroy(inner->children[i]);
+        m_delete_inner(inner);
+    }
+
+    // Split the full child i of parent in two halves and put the key
+    // between them into parent, which is not full.
+    void m_split(Inner* parent, int i)
+    {
+        Node* child = parent->children[i];
+        Node* right;
+        Key separator;
+        if (child->leaf) {
+            Leaf* left = (Leaf*)child;
+            Leaf* leaf = m_new_leaf();
+            int mid = left->count / 2;
+            for (int j = mid; j < left->count; j++) {
+                leaf->keys[j - mid] = left->keys[j];
+                leaf->values[j - mid] = left->values[j];
+            }
+            leaf->count = left->count - mid;
+            left->count = mid;
+            leaf->next = left->next;
+            if (leaf->next)
+                leaf->next->prev = leaf;
+            leaf->prev = left;
+            left->next = leaf;
+            separator = leaf->keys[0];
+            right = leaf;
+        } else {
+            Inner* left = (Inner*)child;
+            Inner* inner = m_new_inner();
+            int mid = left->count / 2;
+            for (int j = mid + 1; j < left->count; j++)
+                inner->keys[j - mid - 1] = left->keys[j];
+            for (int j = mid + 1; j <= left->count; j++)
+                inner->children[j - mid - 1] = left->children[j];
+            inner->count = left->count - mid - 1;
+            left->count = mid;
+            separator = left->keys[mid];
+            right = inner;
+        }
+        for (int j = parent->count; j > i; j--) {
+            parent->keys[j] = parent->keys[j - 1];
+            parent->children[j + 1] = parent->children[j];
+        }
+        parent->keys[i] = separator;
+        parent->children[i + 1] = right;
+        parent->count++;
+    }
+
+    // Give child i of parent, which is at its minimum, one more key from
+    // a sibling, or merge it with one when both are at the minimum.
+    // Returns the index the child has afterwards.
+    int m_fix(Inner* parent, int i)
+    {
+        Node* child = parent->children[i];
+        if (i > 0 && parent->children[i - 1]->count > m_min(child)) {
+            m_borrow_left(parent, i);
+            return i;
+        }
+        if (i < parent->count &&
+            parent->children[i + 1]->count > m_min(child)) {
+            m_borrow_right(parent, i);
+            return i;
+        }
+        if (i > 0) {
+            m_merge(parent, i - 1);
+            return i - 1;
+        }
+        m_merge(parent, i);
+        return i;
+    }
+
+    void m_borrow_left(Inner* parent, int i)
+    {
+        if (parent->children[i]->leaf) {
+            Leaf* left = (Leaf*)parent->children[i - 1];
+            Leaf* leaf = (Leaf*)parent->children[i];
+            for (int j = leaf->count; j > 0; j--) {
+                leaf->keys[j] = leaf->keys[j - 1];
+                leaf->values[j] = leaf->values[j - 1];
+            }
+            leaf->keys[0] = left->keys[left->count - 1];
+            leaf->values[0] = left->values[left->count - 1];
+            leaf->count++;
+            left->count--;
+            parent->keys[i - 1] = leaf->keys[0];
+            return;
+        }
+        Inner* left = (Inner*)parent->children[i - 1];
+        Inner* inner = (Inner*)parent->children[i];
+        for (int j = inner->count; j > 0; j--)
+            inner->keys[j] = inner->keys[j - 1];
+        for (int j = inner->count + 1; j > 0; j--)
+            inner->children[j] = inner->children[j - 1];
+        inner->keys[0] = parent->keys[i - 1];
+        inner->children[0] = left->children[left->count];
+        inner->count++;
+        parent->keys[i - 1] = left->keys[left->count - 1];
+        left->count--;
+    }
+
+    void m_borrow_right(Inner* parent, int i)
+    {
+        if (parent->children[i]->leaf) {
+            Leaf* leaf = (Leaf*)parent->children[i];
+            Leaf* right = (Leaf*)parent->children[i + 1];
+            leaf->keys[leaf->count] = right->keys[0];
+            leaf->values[leaf->count] = right->values[0];
+            leaf->count++;
+            for (int j = 1; j < right->count; j++) {
+                right->keys[j - 1] = right->keys[j];
+                right->values[j - 1] = right->values[j];
+            }
+            right->count--;
+            parent->keys[i] = right->keys[0];
+            return;
+        }
+        Inner* inner = (Inner*)parent->children[i];
+        Inner* right = (Inner*)parent->children[i + 1];
+        inner->keys[inner->count] = parent->keys[i];
+        inner->children[inner->count + 1] = right->children[0];
+        inner->count++;
+        parent->keys[i] = right->keys[0];
+        for (int j = 1; j < right->count; j++)
+            right->keys[j - 1] = right->keys[j];
+        for (int j = 1; j <= right->count; j++)
+            right->children[j - 1] = right->children[j];
+        right->count--;
+    }
+
+    // children i and i + 1 of parent into child i
+    void m_merge(Inner* parent, int i)
+    {
+        if (parent->children[i]->leaf) {
+            Leaf* left = (Leaf*)parent->children[i];
+            Leaf* right = (Leaf*)parent->children[i + 1];
+            for (int j = 0; j < right->count; j++) {
+                left->keys[left->count + j] = right->keys[j];
+                left->values[left->count + j] = right->values[j];
+            }
+            left->count += right->count;
+            left->next = right->next;
+            if (left->next)
+                left->next->prev = left;
+            m_delete_leaf(right);
+        } else {
+            Inner* left = (Inner*)parent->children[i];
+            Inner* right = (Inner*)parent->children[i + 1];
+            left->keys[left->count] = parent->keys[i];
+            for (int j = 0; j < right->count; j++)
+                left->keys[left->count + 1 + j] = right->keys[j];
+            for (int j = 0; j <= right->count; j++)
+                left->children[left->count + 1 + j] = right->children[j];
+            left->count += 1 + right->count;
+            m_delete_inner(right);
+        }
+        for (int j = i + 1; j < parent->count; j++) {
+            parent->keys[j - 1] = parent->keys[j];
+            parent->children[j] = parent->children[j + 1];
+        }
+        parent->count--;
+    }
+
+    Node* m_root;
+    // the leftmost leaf, where iteration starts
+    Leaf* m_first;
+    size_t m_size;
+    int m_height;
+    Less m_less;
+    SlabPool m_leafPool;
+    SlabPool m_innerPool;
+};
+
+#endif // __BTREE_H__
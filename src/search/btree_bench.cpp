@@ -0,0 +1,180 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+//
+//   btree_bench [KEYS]
+//
+// ns per insert, search, erase and 100 key range of BTree, std::map and
+// the unbalanced tree binary_tree used to have, with KEYS keys (1M by
+// default) in random order and in sorted order. On sorted keys the old
+// tree is a linked list, so it only gets 1 / 32 of them there.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "btree.h"
+#include "bench.h"
+
+// the tree binary_tree had, one malloc() a node and no balancing
+typedef struct node_s {
+    int             item;
+    struct node_s   *left;
+    struct node_s   *right;
+} node_t;
+
+static void insert(int key, node_t **leaf)
+{
+    if (*leaf == NULL) {
+        *leaf = (node_t *)malloc(sizeof(node_t));
+        (*leaf)->item = key;
+        (*leaf)->left = NULL;
+        (*leaf)->right = NULL;
+    } else if (key < (*leaf)->item) {
+        insert(key, &(*leaf)->left);
+    } else if (key > (*leaf)->item) {
+        insert(key, &(*leaf)->right);
+    }
+}
+
+static node_t *search(int key, node_t *leaf)
+{
+    if (leaf != NULL) {
+        if (key == leaf->item) {
+            return leaf;
+        } else if (key < leaf->item) {
+            return search(key, leaf->left);
+        } else {
+            return search(key, leaf->right);
+        }
+    }
+    return NULL;
+}
+
+static void destroy_tree(node_t *leaf)
+{
+    if (leaf != NULL) {
+        destroy_tree(leaf->left);
+        destroy_tree(leaf->right);
+        free(leaf);
+    }
+}
+
+static void print_row(const char* name, size_t keys, double insertSec,
+                      double searchSec, double rangeSec, double eraseSec)
+{
+    printf("  %-12s %9zu %8.1f %8.1f", name, keys, insertSec / keys * 1e9,
+           searchSec / keys * 1e9);
+    // the old tree has neither
+    if (rangeSec >= 0)
+        printf(" %8.1f %8.1f\n", rangeSec / keys * 1e9,
+               eraseSec / keys * 1e9);
+    else
+        printf("        -        -\n");
+}
+
+// keys are inserted in order, searched for and erased in another random
+// order; a range is the keys from a random one up to 100 after it
+static void run(const char* name, const std::vector<int> & keys,
+                size_t oldKeys)
+{
+    std::vector<int> probes(keys);
+    for (size_t i = probes.size() - 1; i > 0; i--)
+        std::swap(probes[i], probes[bench_rand() % (i + 1)]);
+    size_t n = keys.size();
+    size_t expectRange = 0;
+    printf("%s keys        keys   insert   search    range    erase (ns)\n",
+           name);
+
+    {
+        BTree<int, int> tree;
+        double start = now_sec();
+        for (size_t i = 0; i < n; i++)
+            tree.insert(keys[i], i);
+        double insertSec = now_sec() - start;
+        size_t found = 0;
+        start = now_sec();
+        for (size_t i = 0; i < n; i++)
+            found += tree.search(probes[i]) != NULL;
+        double searchSec = now_sec() - start;
+        start = now_sec();
+        for (size_t i = 0; i < n; i++)
+            expectRange += tree.count(probes[i], probes[i] + 99);
+        double rangeSec = now_sec() - start;
+        int height = tree.height();
+        size_t bytes = tree.bytes();
+        start = now_sec();
+        for (size_t i = 0; i < n; i++)
+            found += tree.erase(probes[i]);
+        double eraseSec = now_sec() - start;
+        print_row("BTree", n, insertSec, searchSec, rangeSec, eraseSec);
+        printf("    %d levels, %.1f bytes a key%s\n", height,
+               (double)bytes / n, found == 2 * n && tree.size() == 0 ? "" :
+               "  ERROR: keys lost");
+    }
+    {
+        std::map<int, int> tree;
+        double start = now_sec();
+        for (size_t i = 0; i < n; i++)
+            tree.insert(std::make_pair(keys[i], (int)i));
+        double insertSec = now_sec() - start;
+        size_t found = 0;
+        start = now_sec();
+        for (size_t i = 0; i < n; i++)
+            found += tree.find(probes[i]) != tree.end();
+        double searchSec = now_sec() - start;
+        size_t inRange = 0;
+        start = now_sec();
+        for (size_t i = 0; i < n; i++) {
+            std::map<int, int>::const_iterator it =
+                tree.lower_bound(probes[i]);
+            for (; it != tree.end() && it->first <= probes[i] + 99; ++it)
+                inRange++;
+        }
+        double rangeSec = now_sec() - start;
+        start = now_sec();
+        for (size_t i = 0; i < n; i++)
+            found += tree.erase(probes[i]);
+        double eraseSec = now_sec() - start;
+        print_row("std::map", n, insertSec, searchSec, rangeSec, eraseSec);
+        if (found != 2 * n || inRange != expectRange)
+            printf("    ERROR: std::map and BTree differ\n");
+    }
+    {
+        // the same keys, as many as the old tree can take in reasonable
+        // time
+        size_t m = std::min(n, oldKeys);
+        node_t *root = NULL;
+        double start = now_sec();
+        for (size_t i = 0; i < m; i++)
+            insert(keys[i], &root);
+        double insertSec = now_sec() - start;
+        size_t found = 0;
+        start = now_sec();
+        for (size_t i = 0; i < m; i++)
+            found += search(keys[i], root) != NULL;
+        double searchSec = now_sec() - start;
+        destroy_tree(root);
+        print_row("old tree", m, insertSec, searchSec, -1, -1);
+        if (found != m)
+            printf("    ERROR: old tree lost keys\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    size_t n = argc > 1 ? atol(argv[1]) : 1000000;
+    if (n < 2) {
+        printf("ERROR: too few keys\n");
+        return 1;
+    }
+    // distinct keys 3 apart, so searches and ranges also fall between them
+    std::vector<int> keys(n);
+    for (size_t i = 0; i < n; i++)
+        keys[i] = 3 * i;
+    run("sorted", keys, n / 32);
+    for (size_t i = n - 1; i > 0; i--)
+        std::swap(keys[i], keys[bench_rand() % (i + 1)]);
+    run("random", keys, n);
+    return 0;
+}
@@ -0,0 +1,127 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+//
+//   concurrent_bench [KEYS [MAX_THREADS]]
+//
+// Loads KEYS keys (1M by default) with bulk_load(), then has 1, 2, 4, ..
+// MAX_THREADS (64 by default) threads look up, insert and erase random keys
+// in read/write mixes of 100/0, 90/10 and 50/50, against ConcurrentMap and
+// against a std::unordered_map behind one reader/writer lock.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "concurrent_map.h"
+#include "bench.h"
+
+// operations per thread in a run
+#define BENCH_OPS   (1 << 20)
+
+static inline uint64_t next_rand(uint64_t & state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+typedef ConcurrentMap<uint64_t, uint64_t> Concurrent;
+
+// the same operations on a std::unordered_map under a shared_mutex
+class LockedMap
+{
+public:
+    bool find(uint64_t key, uint64_t & value) const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        std::unordered_map<uint64_t, uint64_t>::const_iterator it =
+            m_map.find(key);
+        if (it == m_map.end())
+            return false;
+        value = it->second;
+        return true;
+    }
+    bool insert(uint64_t key, uint64_t value)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        return m_map.emplace(key, value).second;
+    }
+    bool erase(uint64_t key)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        return m_map.erase(key);
+    }
+
+private:
+    mutable std::shared_mutex m_mutex;
+    std::unordered_map<uint64_t, uint64_t> m_map;
+};
+
+// keys are drawn from twice the loaded range, so about half the lookups
+// hit and the inserts and erases keep the size about where it is
+template <typename Map>
+static double run(Map & map, uint64_t keys, unsigned threads, int readPct)
+{
+    std::vector<std::thread> workers;
+    double start = now_sec();
+    for (unsigned t = 0; t < threads; t++) {
+        workers.push_back(std::thread([&map, keys, readPct, t]() {
+            uint64_t state = 0x9e3779b97f4a7c15ULL * (t + 1);
+            uint64_t value;
+            for (int i = 0; i < BENCH_OPS; i++) {
+                uint64_t r = next_rand(state);
+                uint64_t key = (r >> 8) % (2 * keys);
+                int op = r % 100;
+                if (op < readPct)
+                    map.find(key, value);
+                else if (op & 1)
+                    map.insert(key, key);
+                else
+                    map.erase(key);
+            }
+        }));
+    }
+    for (unsigned t = 0; t < threads; t++)
+        workers[t].join();
+    return (double)threads * BENCH_OPS / (now_sec() - start) / 1e6;
+}
+
+int main(int argc, char* argv[])
+{
+    uint64_t keys = argc > 1 ? atol(argv[1]) : 1000000;
+    unsigned maxThreads = argc > 2 ? atoi(argv[2]) : 64;
+    std::vector<std::pair<uint64_t, uint64_t> > items(keys);
+    for (uint64_t i = 0; i < keys; i++)
+        items[i] = std::make_pair(2 * i, 2 * i);
+
+    Concurrent concurrent;
+    double start = now_sec();
+    concurrent.bulk_load(&items[0], keys, 0);
+    printf("bulk_load: %llu keys in %.2fms\n", (unsigned long long)keys,
+           (now_sec() - start) * 1e3);
+    if (concurrent.size() != keys) {
+        printf("ERROR: %zu keys loaded\n", concurrent.size());
+        return 1;
+    }
+    LockedMap locked;
+    start = now_sec();
+    for (uint64_t i = 0; i < keys; i++)
+        locked.insert(items[i].first, items[i].second);
+    printf("one by one, locked: %.2fms\n", (now_sec() - start) * 1e3);
+
+    const int readPct[] = {100, 90, 50};
+    printf("Mops/s    read%%   ConcurrentMap   unordered_map+rwlock\n");
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        for (int r = 0; r < 3; r++) {
+            double c = run(concurrent, keys, threads, readPct[r]);
+            double l = run(locked, keys, threads, readPct[r]);
+            printf("%2u thread(s) %3d %12.2f %14.2f\n", threads, readPct[r],
+                   c, l);
+        }
+    }
+    return 0;
+}
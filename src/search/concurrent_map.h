@@ -0,0 +1,285 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#ifndef __CONCURRENT_MAP_H__
+#define __CONCURRENT_MAP_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "epoch.h"
+#include "wyhash.h"
+
+// a map has 1 << CONCURRENT_SHARD_BITS shards
+#define CONCURRENT_SHARD_BITS   6
+#define CONCURRENT_SHARDS       (1 << CONCURRENT_SHARD_BITS)
+
+// Hash map shared by many threads. Keys are spread over shards by the top
+// bits of their hash, each shard a chained table with a mutex of its own
+// that only writers take (lock striping). Readers take no lock at all: the
+// bucket heads and links are atomics, a node never changes once it is
+// published, and unlinked nodes and outgrown tables are freed through
+// epoch_retire(), so a reader inside its EpochGuard can always finish the
+// chain it started on.
+template <typename Key, typename Value, typename Hash = wy_hash<Key>,
+          typename Equal = std::equal_to<Key> >
+class ConcurrentMap
+{
+public:
+    ConcurrentMap()
+    {
+        for (int s = 0; s < CONCURRENT_SHARDS; s++) {
+            m_shards[s].table.store(new Table(16));
+            m_shards[s].size = 0;
+        }
+    }
+
+    ~ConcurrentMap()
+    {
+        // no thread may use the map any more, nothing to wait for
+        for (int s = 0; s < CONCURRENT_SHARDS; s++)
+            m_delete_table(m_shards[s].table.load());
+    }
+
+    size_t size() const
+    {
+        size_t size = 0;
+        for (int s = 0; s < CONCURRENT_SHARDS; s++) {
+            std::lock_guard<std::mutex> lock(m_shards[s].mutex);
+            size += m_shards[s].size;
+        }
+        return size;
+    }
+
+    // copies the value out, since the node may be freed once the reader
+    // leaves its epoch
+    bool find(const Key & key, Value & value) const
+    {
+        uint64_t hash = m_hash(key);
+        const Shard & shard = m_shard(hash);
+        EpochGuard guard;
+        Table* table = shard.table.load(std::memory_order_acquire);
+        Node* node = table->bucket(hash).load(std::memory_order_acquire);
+        for (; node; node = node->next.load(std::memory_order_acquire)) {
+            if (node->hash == hash && m_equal(node->key, key)) {
+                value = node->value;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool contains(const Key & key) const
+    {
+        Value value;
+        return find(key, value);
+    }
+
+    // false, leaving the value alone, when key is already there
+    bool insert(const Key & key, const Value & value)
+    {
+        uint64_t hash = m_hash(key);
+        Shard & shard = m_shard(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return m_insert(shard, key, value, hash);
+    }
+
+    bool erase(const Key & key)
+    {
+        uint64_t hash = m_hash(key);
+        Shard & shard = m_shard(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        Table* table = shard.table.load(std::memory_order_relaxed);
+        std::atomic<Node*>* link = &table->bucket(hash);
+        for (Node* node = link->load(); node; node = link->load()) {
+            if (node->hash == hash && m_equal(node->key, key)) {
+                // readers on node can still follow its next
+                link->store(node->next.load(), std::memory_order_release);
+                epoch_retire(node, m_delete_node);
+                shard.size--;
+                return true;
+            }
+            link = &node->next;
+        }
+        return false;
+    }
+
+    // Insert count pairs with threads threads (0 for one per hardware
+    // thread): each thread first sorts the shard of every key of its slice
+    // into per shard lists, then fills whole shards from everybody's lists,
+    // growing each table once to its final size. Safe against other users
+    // of the map, but meant for loading it before they start.
+    void bulk_load(const std::pair<Key, Value>* items, size_t count,
+                   unsigned threads)
+    {
+        if (threads == 0)
+            threads = std::thread::hardware_concurrency();
+        if (threads == 0)
+            threads = 1;
+        std::vector<std::vector<std::vector<size_t> > > bins(threads,
+            std::vector<std::vector<size_t> >(CONCURRENT_SHARDS));
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; t++) {
+            workers.push_back(std::thread([=, &bins]() {
+                size_t begin = count * t / threads;
+                size_t end = count * (t + 1) / threads;
+                for (size_t i = begin; i < end; i++) {
+                    uint64_t hash = m_hash(items[i].first);
+                    bins[t][hash >> (64 - CONCURRENT_SHARD_BITS)].push_back(i);
+                }
+            }));
+        }
+        for (unsigned t = 0; t < threads; t++)
+            workers[t].join();
+        workers.clear();
+        for (unsigned t = 0; t < threads; t++) {
+            workers.push_back(std::thread([=, &bins]() {
+                for (int s = t; s < CONCURRENT_SHARDS; s += threads)
+                    m_load_shard(s, items, bins);
+            }));
+        }
+        for (unsigned t = 0; t < threads; t++)
+            workers[t].join();
+    }
+
+private:
+    ConcurrentMap(const ConcurrentMap &);
+    ConcurrentMap & operator=(const ConcurrentMap &);
+
+    struct Node {
+        Node(const Key & k, const Value & v, uint64_t h, Node* n)
+          : key(k), value(v), hash(h), next(n) {}
+
+        Key key;
+        Value value;
+        uint64_t hash;
+        std::atomic<Node*> next;
+    };
+
+    struct Table {
+        explicit Table(size_t size)
+          : mask(size - 1),
+            buckets(new std::atomic<Node*>[size])
+        {
+            for (size_t i = 0; i < size; i++)
+                buckets[i].store(NULL, std::memory_order_relaxed);
+        }
+        ~Table() { delete [] buckets; }
+
+        std::atomic<Node*> & bucket(uint64_t hash)
+        {
+            return buckets[hash & mask];
+        }
+
+        size_t mask;
+        std::atomic<Node*>* buckets;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::atomic<Table*> table;
+        size_t size;
+    } __attribute__((aligned(64)));
+
+    // the top bits pick the shard, the low ones the bucket in it
+    Shard & m_shard(uint64_t hash)
+    {
+        return m_shards[hash >> (64 - CONCURRENT_SHARD_BITS)];
+    }
+    const Shard & m_shard(uint64_t hash) const
+    {
+        return m_shards[hash >> (64 - CONCURRENT_SHARD_BITS)];
+    }
+
+    bool m_insert(Shard & shard, const Key & key, const Value & value,
+                  uint64_t hash)
+    {
+        Table* table = shard.table.load(std::memory_order_relaxed);
+        std::atomic<Node*> & bucket = table->bucket(hash);
+        Node* head = bucket.load(std::memory_order_relaxed);
+        for (Node* node = head; node; node = node->next.load()) {
+            if (node->hash == hash && m_equal(node->key, key))
+                return false;
+        }
+        // the node is complete before the release store makes it reachable
+        bucket.store(new Node(key, value, hash, head),
+                     std::memory_order_release);
+        if (++shard.size > table->mask + 1)
+            m_grow(shard, (table->mask + 1) * 2);
+        return true;
+    }
+
+    // Readers may be walking the old table, so its nodes are copied rather
+    // than relinked, and the old table is retired whole.
+    void m_grow(Shard & shard, size_t size)
+    {
+        Table* old = shard.table.load(std::memory_order_relaxed);
+        Table* table = new Table(size);
+        for (size_t i = 0; i <= old->mask; i++) {
+            for (Node* node = old->buckets[i].load(); node;
+                 node = node->next.load()) {
+                std::atomic<Node*> & bucket = table->bucket(node->hash);
+                bucket.store(new Node(node->key, node->value, node->hash,
+                                      bucket.load(std::memory_order_relaxed)),
+                             std::memory_order_relaxed);
+            }
+        }
+        shard.table.store(table, std::memory_order_release);
+        epoch_retire(old, m_delete_table);
+    }
+
+    void m_load_shard(int s, const std::pair<Key, Value>* items,
+                      const std::vector<std::vector<std::vector<size_t> > >
+                          & bins)
+    {
+        Shard & shard = m_shards[s];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        size_t total = shard.size;
+        for (size_t t = 0; t < bins.size(); t++)
+            total += bins[t][s].size();
+        size_t size = shard.table.load()->mask + 1;
+        if (total > size) {
+            while (size < total)
+                size *= 2;
+            m_grow(shard, size);
+        }
+        for (size_t t = 0; t < bins.size(); t++) {
+            const std::vector<size_t> & bin = bins[t][s];
+            for (size_t i = 0; i < bin.size(); i++) {
+                const std::pair<Key, Value> & item = items[bin[i]];
+                m_insert(shard, item.first, item.second,
+                         m_hash(item.first));
+            }
+        }
+    }
+
+    static void m_delete_node(void* ptr)
+    {
+        delete (Node*)ptr;
+    }
+
+    static void m_delete_table(void* ptr)
+    {
+        Table* table = (Table*)ptr;
+        for (size_t i = 0; i <= table->mask; i++) {
+            Node* node = table->buckets[i].load();
+            while (node) {
+                Node* next = node->next.load();
+                delete node;
+                node = next;
+            }
+        }
+        delete table;
+    }
+
+    Shard m_shards[CONCURRENT_SHARDS];
+    Hash m_hash;
+    Equal m_equal;
+};
+
+#endif // __CONCURRENT_MAP_H__
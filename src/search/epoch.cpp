@@ -0,0 +1,124 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "epoch.h"
+
+// retired objects between two tries to free some of them
+#define EPOCH_COLLECT_EVERY 64
+
+// the epoch a thread entered at, 0 while it is outside; one cache line
+// each so that entering does not bounce the others' lines
+struct EpochSlot {
+    std::atomic<uint64_t> epoch;
+    std::atomic<bool> used;
+    char pad[64 - sizeof(std::atomic<uint64_t>) - sizeof(std::atomic<bool>)];
+};
+
+struct Retired {
+    void* ptr;
+    EpochDeleter deleter;
+    uint64_t epoch;
+};
+
+static std::atomic<uint64_t> globalEpoch(1);
+static EpochSlot slots[EPOCH_MAX_THREADS] __attribute__((aligned(64)));
+static std::mutex retiredMutex;
+static std::vector<Retired> retired;
+
+// a thread takes a slot the first time it enters and gives it back when it
+// exits
+class SlotOwner
+{
+public:
+    SlotOwner() : m_slot(NULL)
+    {
+        for (int i = 0; i < EPOCH_MAX_THREADS; i++) {
+            bool expected = false;
+            if (slots[i].used.compare_exchange_strong(expected, true)) {
+                m_slot = &slots[i];
+                return;
+            }
+        }
+        printf("ERROR: more than %d threads in epochs\n", EPOCH_MAX_THREADS);
+        abort();
+    }
+    ~SlotOwner()
+    {
+        m_slot->epoch.store(0);
+        m_slot->used.store(false);
+    }
+
+    EpochSlot* slot() const { return m_slot; }
+
+private:
+    EpochSlot* m_slot;
+};
+
+static EpochSlot* self()
+{
+    static thread_local SlotOwner owner;
+    return owner.slot();
+}
+
+void epoch_enter()
+{
+    // seq_cst, so that a writer trying to move the epoch on either sees this
+    // store or the reader sees the objects it unlinked as gone
+    self()->epoch.store(globalEpoch.load());
+}
+
+void epoch_leave()
+{
+    self()->epoch.store(0, std::memory_order_release);
+}
+
+// the global epoch moves on when no thread is still in an older one
+static uint64_t try_advance()
+{
+    uint64_t epoch = globalEpoch.load();
+    for (int i = 0; i < EPOCH_MAX_THREADS; i++) {
+        uint64_t e = slots[i].epoch.load();
+        if (e != 0 && e != epoch)
+            return epoch;
+    }
+    globalEpoch.compare_exchange_strong(epoch, epoch + 1);
+    return globalEpoch.load();
+}
+
+void epoch_collect()
+{
+    uint64_t epoch = try_advance();
+    std::vector<Retired> free;
+    {
+        std::lock_guard<std::mutex> lock(retiredMutex);
+        size_t kept = 0;
+        for (size_t i = 0; i < retired.size(); i++) {
+            if (retired[i].epoch + 2 <= epoch)
+                free.push_back(retired[i]);
+            else
+                retired[kept++] = retired[i];
+        }
+        retired.resize(kept);
+    }
+    for (size_t i = 0; i < free.size(); i++)
+        free[i].deleter(free[i].ptr);
+}
+
+void epoch_retire(void* ptr, EpochDeleter deleter)
+{
+    Retired r = {ptr, deleter, globalEpoch.load()};
+    size_t count;
+    {
+        std::lock_guard<std::mutex> lock(retiredMutex);
+        retired.push_back(r);
+        count = retired.size();
+    }
+    if (count % EPOCH_COLLECT_EVERY == 0)
+        epoch_collect();
+}
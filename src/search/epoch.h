@@ -0,0 +1,35 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#ifndef __EPOCH_H__
+#define __EPOCH_H__
+
+// most threads that can be inside an epoch at the same time
+#define EPOCH_MAX_THREADS   256
+
+typedef void (*EpochDeleter)(void* ptr);
+
+// Epoch based reclamation. Readers run inside epoch_enter() /
+// epoch_leave() and may follow any pointer they load there; a writer that
+// unlinks an object hands it to epoch_retire() instead of freeing it. The
+// global epoch only moves on once every thread inside an epoch has seen
+// the current one, so whatever was retired two epochs back can no longer
+// be reached by anybody and is freed.
+void epoch_enter();
+void epoch_leave();
+void epoch_retire(void* ptr, EpochDeleter deleter);
+// try to move the epoch on and free what is safe to, done by
+// epoch_retire() every so often as well
+void epoch_collect();
+
+class EpochGuard
+{
+public:
+    EpochGuard() { epoch_enter(); }
+    ~EpochGuard() { epoch_leave(); }
+
+private:
+    EpochGuard(const EpochGuard &);
+    EpochGuard & operator=(const EpochGuard &);
+};
+
+#endif // __EPOCH_H__
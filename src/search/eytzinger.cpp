@@ -0,0 +1,83 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#include <stdlib.h>
+
+#include "eytzinger.h"
+
+EytzingerIndex::EytzingerIndex(const std::vector<int> & sorted)
+  : m_size(sorted.size()),
+    m_depth(0),
+    m_data(NULL),
+    m_rank(m_size + 1, m_size)
+{
+    // one based and aligned so that the 16 descendants of a node are one
+    // cache line
+    if (posix_memalign((void**)&m_data, 64, (m_size + 1) * sizeof(int)))
+        abort();
+    m_data[0] = 0;
+    for (size_t n = m_size; n > 1; n >>= 1)
+        m_depth++;
+    m_build(sorted, 0, 1);
+}
+
+EytzingerIndex::~EytzingerIndex()
+{
+    free(m_data);
+}
+
+// in-order walk of the implicit tree, taking the sorted elements in turn
+size_t EytzingerIndex::m_build(const std::vector<int> & sorted, size_t i,
+                               size_t k)
+{
+    if (k <= m_size) {
+        i = m_build(sorted, i, 2 * k);
+        m_data[k] = sorted[i];
+        m_rank[k] = i++;
+        i = m_build(sorted, i, 2 * k + 1);
+    }
+    return i;
+}
+
+// k walked right at every level where the key was larger; the answer is
+// the node where it last went left, found by stripping the trailing ones
+// and that one zero off k. Nowhere left gives 0, whose rank is m_size.
+size_t EytzingerIndex::lower_bound(int key) const
+{
+    size_t k = 1;
+    while (k <= m_size) {
+        __builtin_prefetch(m_data + k * 16);
+        k = 2 * k + (m_data[k] < key);
+    }
+    k >>= __builtin_ffsl(~k);
+    return m_rank[k];
+}
+
+// The keys of a batch walk down in lockstep, so the misses of one level are
+// all in flight together. The first m_depth levels are complete; the last
+// step is taken only by keys still inside the tree, as a select rather than
+// a branch.
+void EytzingerIndex::lower_bound(const int* keys, size_t count,
+                                 size_t* out) const
+{
+    size_t i = 0;
+    for (; i + EYTZINGER_BATCH <= count; i += EYTZINGER_BATCH) {
+        size_t k[EYTZINGER_BATCH];
+        for (int j = 0; j < EYTZINGER_BATCH; j++)
+            k[j] = 1;
+        for (int level = 0; level < m_depth; level++) {
+            for (int j = 0; j < EYTZINGER_BATCH; j++) {
+                k[j] = 2 * k[j] + (m_data[k[j]] < keys[i + j]);
+                __builtin_prefetch(m_data + k[j] * 16);
+            }
+        }
+        for (int j = 0; j < EYTZINGER_BATCH; j++) {
+            bool inside = k[j] <= m_size;
+            size_t next = 2 * k[j] + (m_data[inside ? k[j] : 0] < keys[i + j]);
+            k[j] = inside ? next : k[j];
+            k[j] >>= __builtin_ffsl(~k[j]);
+            out[i + j] = m_rank[k[j]];
+        }
+    }
+    for (; i < count; i++)
+        out[i] = lower_bound(keys[i]);
+}
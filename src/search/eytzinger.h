@@ -0,0 +1,44 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#ifndef __EYTZINGER_H__
+#define __EYTZINGER_H__
+
+#include <stddef.h>
+#include <vector>
+
+// keys searched side by side by the batched lower_bound()
+#define EYTZINGER_BATCH     16
+
+// Search index over a sorted array, kept in Eytzinger (BFS) order: the root
+// at 1, the children of k at 2k and 2k + 1. The top levels of the tree share
+// a few cache lines, and the 16 descendants four levels below k are one
+// cache line that can be prefetched long before it is needed, so a lookup
+// never waits on more than one miss at a time and takes no data dependent
+// branch.
+class EytzingerIndex
+{
+public:
+    explicit EytzingerIndex(const std::vector<int> & sorted);
+    ~EytzingerIndex();
+
+    size_t size() const { return m_size; }
+    // index in the sorted array of the first element not less than key,
+    // size() when there is none
+    size_t lower_bound(int key) const;
+    // the same for count keys, written to out
+    void lower_bound(const int* keys, size_t count, size_t* out) const;
+
+private:
+    EytzingerIndex(const EytzingerIndex &);
+    EytzingerIndex & operator=(const EytzingerIndex &);
+
+    size_t m_build(const std::vector<int> & sorted, size_t i, size_t k);
+
+    size_t m_size;
+    // floor(log2(m_size)): the levels a search is sure to go through
+    int m_depth;
+    int* m_data;
+    std::vector<unsigned int> m_rank;
+};
+
+#endif // __EYTZINGER_H__
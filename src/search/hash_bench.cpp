@@ -0,0 +1,158 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+//
+//   hash_bench [COUNT ...]
+//
+// ns per insert, lookup (hit and miss) and erase of COUNT string keys in
+// SwissMap and std::unordered_map, 1M keys by default. 100M keys need
+// about 16 GB for the keys and both maps.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "swiss_map.h"
+#include "bench.h"
+
+static unsigned long long bench_rand64()
+{
+    static unsigned long long state = 88172645463325252ULL;
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// "user:" and up to 20 digits, so most keys are past the small string
+// buffer of std::string, as names in a symbol table would be
+static void make_keys(std::vector<std::string> & keys, size_t count)
+{
+    char buf[32];
+    keys.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        snprintf(buf, sizeof(buf), "user:%llu", bench_rand64() >> (i % 24));
+        keys[i] = buf;
+    }
+}
+
+struct Result {
+    double insert;
+    double hit;
+    double miss;
+    double erase;
+    size_t found;
+};
+
+template <typename Map, typename Insert, typename Find, typename Erase>
+static Result run(const std::vector<std::string> & keys,
+                  const std::vector<std::string> & missing, Insert insert,
+                  Find find, Erase erase)
+{
+    Result r;
+    size_t count = keys.size();
+    Map map;
+    double start = now_sec();
+    for (size_t i = 0; i < count; i++)
+        insert(map, keys[i], (int)i);
+    r.insert = (now_sec() - start) * 1e9 / count;
+
+    r.found = 0;
+    start = now_sec();
+    for (size_t i = 0; i < count; i++)
+        r.found += find(map, keys[(i * 7919) % count]);
+    r.hit = (now_sec() - start) * 1e9 / count;
+
+    start = now_sec();
+    for (size_t i = 0; i < count; i++)
+        r.found += find(map, missing[i]);
+    r.miss = (now_sec() - start) * 1e9 / count;
+
+    start = now_sec();
+    for (size_t i = 0; i < count; i++)
+        erase(map, keys[i]);
+    r.erase = (now_sec() - start) * 1e9 / count;
+    return r;
+}
+
+static void report(const char* name, const Result & r)
+{
+    printf(" %-20s insert %6.1fns  hit %6.1fns  miss %6.1fns  erase %6.1fns\n",
+           name, r.insert, r.hit, r.miss, r.erase);
+}
+
+typedef SwissMap<std::string, int> Swiss;
+typedef std::unordered_map<std::string, int> Unordered;
+
+// Two groups, each with a key that spilled into the other, so neither
+// overflow count is zero: a miss used to go round them for good.
+static int check()
+{
+    std::vector<int> home[2];
+    wy_hash<int> hash;
+    for (int k = 0; home[0].size() < 17 || home[1].size() < 17; k++) {
+        std::vector<int> & h = home[(hash(k) >> 7) & 1];
+        if (h.size() < 17)
+            h.push_back(k);
+    }
+    SwissMap<int, int> m(20);
+    for (int i = 0; i < 17; i++)
+        m.insert(home[0][i], i);
+    for (int i = 0; i < 12; i++)
+        m.erase(home[0][i]);
+    for (int i = 0; i < 16; i++)
+        m.insert(home[1][i], i);
+    int bad = 0;
+    if (m.capacity() != 32 || m.size() != 21) {
+        printf("ERROR: %zu keys in %zu slots, not 21 in 32\n", m.size(),
+               m.capacity());
+        bad++;
+    }
+    for (int i = 12; i < 17; i++)
+        bad += m.find(home[0][i]) == NULL;
+    for (int i = 0; i < 16; i++)
+        bad += m.find(home[1][i]) == NULL;
+    if (m.find(999999) != NULL || m.insert(999999, 0) == false)
+        bad++;
+    if (bad)
+        printf("ERROR: %d SwissMap lookups wrong after spills both ways\n",
+               bad);
+    return bad;
+}
+
+int main(int argc, char* argv[])
+{
+    if (check() != 0)
+        return 1;
+
+    std::vector<size_t> counts;
+    for (int i = 1; i < argc; i++)
+        counts.push_back(atol(argv[i]));
+    if (counts.empty())
+        counts.push_back(1000000);
+
+    for (size_t c = 0; c < counts.size(); c++) {
+        std::vector<std::string> keys;
+        std::vector<std::string> missing;
+        make_keys(keys, counts[c]);
+        make_keys(missing, counts[c]);
+        for (size_t i = 0; i < missing.size(); i++)
+            missing[i][0] = 'U';
+        printf("%zu keys\n", counts[c]);
+
+        Result swiss = run<Swiss>(keys, missing,
+            [](Swiss & m, const std::string & k, int v) { m.insert(k, v); },
+            [](Swiss & m, const std::string & k) { return m.find(k) != NULL; },
+            [](Swiss & m, const std::string & k) { m.erase(k); });
+        report("SwissMap", swiss);
+        Result unordered = run<Unordered>(keys, missing,
+            [](Unordered & m, const std::string & k, int v) { m.emplace(k, v); },
+            [](Unordered & m, const std::string & k) { return m.count(k); },
+            [](Unordered & m, const std::string & k) { m.erase(k); });
+        report("std::unordered_map", unordered);
+        if (swiss.found != unordered.found)
+            printf("ERROR: SwissMap found %zu keys, std::unordered_map %zu\n",
+                   swiss.found, unordered.found);
+    }
+    return 0;
+}
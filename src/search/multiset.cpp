@@ -0,0 +1,207 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#include <string.h>
+#include <immintrin.h>
+
+#include "multiset.h"
+
+#pragma GCC push_options
+#pragma GCC target("avx2,popcnt")
+namespace multiset_avx2 {
+
+struct Vec {
+    typedef __m256i type;
+    enum { W = 8 };
+
+    static type load(const uint32_t* p)
+    {
+        return _mm256_loadu_si256((const __m256i*)p);
+    }
+    // a > b unsigned is max(a, b) != b
+    static unsigned int gt_mask(type a, type b)
+    {
+        return ~_mm256_movemask_ps(_mm256_castsi256_ps(
+            _mm256_cmpeq_epi32(_mm256_max_epu32(a, b), b))) & 0xff;
+    }
+    static unsigned int ne_mask(type a, type b)
+    {
+        return ~_mm256_movemask_ps(_mm256_castsi256_ps(
+            _mm256_cmpeq_epi32(a, b))) & 0xff;
+    }
+};
+
+#include "multiset_kernel.h"
+
+} // namespace multiset_avx2
+#pragma GCC pop_options
+
+namespace multiset_sse2 {
+
+struct Vec {
+    typedef __m128i type;
+    enum { W = 4 };
+
+    static type load(const uint32_t* p)
+    {
+        return _mm_loadu_si128((const __m128i*)p);
+    }
+    // SSE2 only compares signed, so both sides are flipped by the top bit
+    static unsigned int gt_mask(type a, type b)
+    {
+        __m128i bias = _mm_set1_epi32(0x80000000);
+        return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(
+            _mm_xor_si128(a, bias), _mm_xor_si128(b, bias))));
+    }
+    static unsigned int ne_mask(type a, type b)
+    {
+        return ~_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b))) &
+               0xf;
+    }
+};
+
+#include "multiset_kernel.h"
+
+} // namespace multiset_sse2
+
+struct MultisetImpl {
+    bool (*contains)(const uint32_t* whole, const uint32_t* part);
+    int (*mismatches)(const uint32_t* a, const uint32_t* b);
+    const char* isa;
+};
+
+static MultisetImpl resolve()
+{
+    MultisetImpl impl;
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        impl.contains = multiset_avx2::contains;
+        impl.mismatches = multiset_avx2::mismatches;
+        impl.isa = "avx2";
+    } else {
+        impl.contains = multiset_sse2::contains;
+        impl.mismatches = multiset_sse2::mismatches;
+        impl.isa = "sse2";
+    }
+    return impl;
+}
+
+static const MultisetImpl & impl()
+{
+    static MultisetImpl impl = resolve();
+    return impl;
+}
+
+// Four histograms, one per byte of every 4, so that runs of the same byte
+// do not make each increment wait for the one before it to be stored.
+void byte_histogram(const char* s, size_t size, uint32_t hist[256])
+{
+    const unsigned char* p = (const unsigned char*)s;
+    uint32_t part[4][256];
+    memset(part, 0, sizeof(part));
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        uint32_t word;
+        memcpy(&word, p + i, 4);
+        part[0][word & 0xff]++;
+        part[1][(word >> 8) & 0xff]++;
+        part[2][(word >> 16) & 0xff]++;
+        part[3][word >> 24]++;
+    }
+    for (; i < size; i++)
+        part[0][p[i]]++;
+    for (int c = 0; c < 256; c++)
+        hist[c] = part[0][c] + part[1][c] + part[2][c] + part[3][c];
+}
+
+bool histogram_contains(const uint32_t whole[256], const uint32_t part[256])
+{
+    return impl().contains(whole, part);
+}
+
+bool multiset_contains(const char* text, size_t textSize,
+                       const char* part, size_t partSize)
+{
+    if (partSize > textSize)
+        return false;
+    uint32_t whole[256], sub[256];
+    byte_histogram(text, textSize, whole);
+    byte_histogram(part, partSize, sub);
+    return impl().contains(whole, sub);
+}
+
+bool is_anagram(const char* a, size_t aSize, const char* b, size_t bSize)
+{
+    if (aSize != bSize)
+        return false;
+    uint32_t ha[256], hb[256];
+    byte_histogram(a, aSize, ha);
+    byte_histogram(b, bSize, hb);
+    return impl().mismatches(ha, hb) == 0;
+}
+
+AnagramSearch::AnagramSearch(const char* pattern, size_t size)
+  : m_size(size)
+{
+    byte_histogram(pattern, size, m_hist);
+}
+
+const char* AnagramSearch::isa()
+{
+    return impl().isa;
+}
+
+// diff[c] is the count of c in the window minus the one in the pattern,
+// bad how many of them are not zero; func returns false to stop
+template <typename Func>
+size_t AnagramSearch::m_each(const unsigned char* text, size_t size,
+                             Func func) const
+{
+    size_t found = 0;
+    if (m_size > size)
+        return 0;
+    uint32_t window[256];
+    byte_histogram((const char*)text, m_size, window);
+    int bad = impl().mismatches(window, m_hist);
+    int32_t diff[256];
+    for (int c = 0; c < 256; c++)
+        diff[c] = window[c] - m_hist[c];
+    for (size_t pos = 0; ; pos++) {
+        if (bad == 0) {
+            found++;
+            if (!func(pos))
+                break;
+        }
+        if (pos + m_size >= size)
+            break;
+        unsigned char out = text[pos];
+        unsigned char in = text[pos + m_size];
+        bad += (diff[out] == 0) - (diff[out] == 1);
+        diff[out]--;
+        bad += (diff[in] == 0) - (diff[in] == -1);
+        diff[in]++;
+    }
+    return found;
+}
+
+size_t AnagramSearch::find(const char* text, size_t size) const
+{
+    size_t first = ANAGRAM_NPOS;
+    m_each((const unsigned char*)text, size,
+           [&first](size_t pos) { first = pos; return false; });
+    return first;
+}
+
+size_t AnagramSearch::find_all(const char* text, size_t size,
+                               std::vector<size_t> & out) const
+{
+    return m_each((const unsigned char*)text, size, [&out](size_t pos) {
+        out.push_back(pos);
+        return true;
+    });
+}
+
+size_t AnagramSearch::count(const char* text, size_t size) const
+{
+    return m_each((const unsigned char*)text, size,
+                  [](size_t) { return true; });
+}
@@ -0,0 +1,60 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#ifndef __MULTISET_H__
+#define __MULTISET_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#define ANAGRAM_NPOS    ((size_t)-1)
+
+// Byte multisets as 256-entry count histograms. Comparing two histograms
+// is 256 counts side by side, done 8 (AVX2) or 4 (SSE2) at a time, so a
+// containment check is one pass over each string and a fixed amount of
+// work on top, however long the strings are.
+
+// hist[c] = how many times byte c is in s[0..size)
+void byte_histogram(const char* s, size_t size, uint32_t hist[256]);
+
+// true when every byte count of part is at most the one of whole
+bool histogram_contains(const uint32_t whole[256], const uint32_t part[256]);
+
+// true when the bytes of part, with repeats, are a sub-multiset of those
+// of text
+bool multiset_contains(const char* text, size_t textSize,
+                       const char* part, size_t partSize);
+// true when a is a permutation of b
+bool is_anagram(const char* a, size_t aSize, const char* b, size_t bSize);
+
+// Every window of a text that holds a permutation of one pattern. The
+// window slides one byte at a time keeping the difference of its
+// histogram and the pattern's, and how many of the 256 differences are
+// not zero: a byte coming in and one going out change two counts, and the
+// window matches when none is left, so the scan is O(1) per byte.
+class AnagramSearch
+{
+public:
+    AnagramSearch(const char* pattern, size_t size);
+
+    // start of the first window in text[0..size) that is a permutation
+    // of the pattern, ANAGRAM_NPOS if none
+    size_t find(const char* text, size_t size) const;
+    // every such window, overlapping ones included, appended to out;
+    // returns how many there were
+    size_t find_all(const char* text, size_t size,
+                    std::vector<size_t> & out) const;
+    size_t count(const char* text, size_t size) const;
+
+    // "avx2" or "sse2"
+    static const char* isa();
+
+private:
+    template <typename Func>
+    size_t m_each(const unsigned char* text, size_t size, Func func) const;
+
+    size_t m_size;
+    uint32_t m_hist[256];
+};
+
+#endif // __MULTISET_H__
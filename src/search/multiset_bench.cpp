@@ -0,0 +1,151 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+//
+//   multiset_bench [MB]
+//
+// Checks whether one random printable string is a sub-multiset of another
+// with the byte histograms of multiset_contains() and with the product of
+// one prime per character that boyer_moore used, a BigInteger divided once
+// per character; then finds every permutation of patterns of 4 .. 256
+// bytes in MB megabytes (64 by default) of text with AnagramSearch.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "bigint/BigIntegerLibrary.hh"
+#include "multiset.h"
+#include "bench.h"
+
+// one prime per printable character, '!' .. '~'
+static const int primeNum[] = {
+    2,   3,   5,   7,   11,  13,  17,  19,  23,  29,  31,  37,  41,  43,
+    47,  53,  59,  61,  67,  71,  73,  79,  83,  89,  97,  101, 103, 107,
+    109, 113, 127, 131, 137, 139, 149, 151, 157, 163, 167, 173, 179, 181,
+    191, 193, 197, 199, 211, 223, 227, 229, 233, 239, 241, 251, 257, 263,
+    269, 271, 277, 281, 283, 293, 307, 311, 313, 317, 331, 337, 347, 349,
+    353, 359, 367, 373, 379, 383, 389, 397, 401, 409, 419, 421, 431, 433,
+    439, 443, 449, 457, 461, 463, 467, 479, 487, 491};
+
+// the product of the primes of text, divided by the prime of every
+// character of part in turn; the division taking the prime out again is
+// what counts repeats, which the loop in boyer_moore did not do
+static bool prime_contains(const std::string & text, const std::string & part)
+{
+    BigInteger product = 1;
+    for (size_t i = 0; i < text.size(); i++)
+        product *= primeNum[text[i] - '!'];
+    for (size_t i = 0; i < part.size(); i++) {
+        int prime = primeNum[part[i] - '!'];
+        if (product % prime != 0)
+            return false;
+        product /= prime;
+    }
+    return true;
+}
+
+static std::string printable(size_t size)
+{
+    std::string s(size, ' ');
+    for (size_t i = 0; i < size; i++)
+        s[i] = '!' + bench_rand() % 94;
+    return s;
+}
+
+// characters picked from text, so about half the time, when none of them
+// is changed, part is contained in it
+static std::string pick(const std::string & text, size_t size)
+{
+    std::string rest = text, part;
+    for (size_t i = 0; i < size; i++) {
+        size_t j = bench_rand() % rest.size();
+        part += rest[j];
+        rest.erase(j, 1);
+    }
+    if (bench_rand() % 2)
+        part[bench_rand() % size] = '!' + bench_rand() % 94;
+    return part;
+}
+
+static void bench_contains()
+{
+    const size_t sizes[][2] = {{15, 7}, {64, 16}, {256, 64}, {1024, 256}};
+    printf("contains: text part   histogram    prime product\n");
+    for (int s = 0; s < 4; s++) {
+        const int pairs = 256;
+        std::vector<std::string> texts, parts;
+        for (int i = 0; i < pairs; i++) {
+            texts.push_back(printable(sizes[s][0]));
+            parts.push_back(pick(texts.back(), sizes[s][1]));
+        }
+        int rounds = 1 << (12 - 2 * s);
+        std::vector<bool> expect(pairs);
+        double start = now_sec();
+        for (int r = 0; r < rounds; r++) {
+            for (int i = 0; i < pairs; i++)
+                expect[i] = multiset_contains(texts[i].data(),
+                                              texts[i].size(),
+                                              parts[i].data(),
+                                              parts[i].size());
+        }
+        double ours = (now_sec() - start) / rounds / pairs;
+        // the products are slow enough for one round
+        bool same = true;
+        start = now_sec();
+        for (int i = 0; i < pairs; i++)
+            same &= prime_contains(texts[i], parts[i]) == expect[i];
+        double prime = (now_sec() - start) / pairs;
+        printf("        %7zu %4zu %9.0fns %14.0fns%s\n", sizes[s][0],
+               sizes[s][1], ours * 1e9, prime * 1e9,
+               same ? "" : "  ERROR: answers differ");
+    }
+}
+
+// windows of text checked one by one, for a short stretch of it
+static size_t naive_count(const std::string & text, size_t size,
+                          const std::string & pattern)
+{
+    size_t count = 0;
+    for (size_t pos = 0; pos + pattern.size() <= size; pos++) {
+        if (is_anagram(text.data() + pos, pattern.size(), pattern.data(),
+                       pattern.size()))
+            count++;
+    }
+    return count;
+}
+
+static void bench_windows(size_t mb)
+{
+    // four letters, so that permutations of the pattern do turn up
+    std::string text(mb << 20, ' ');
+    for (size_t i = 0; i < text.size(); i++)
+        text[i] = 'a' + bench_rand() % 4;
+    printf("windows (%s): %zu MB, len       matches      GB/s\n",
+           AnagramSearch::isa(), mb);
+    for (size_t len = 4; len <= 256; len *= 4) {
+        std::string pattern = text.substr(bench_rand() % (text.size() - len),
+                                          len);
+        AnagramSearch search(pattern.data(), len);
+        double start = now_sec();
+        size_t count = search.count(text.data(), text.size());
+        double sec = now_sec() - start;
+        size_t prefix = 1 << 16;
+        bool same = search.count(text.data(), prefix) ==
+                    naive_count(text, prefix, pattern);
+        printf("                        %4zu %13zu %9.2f%s\n", len, count,
+               text.size() / 1e9 / sec,
+               same ? "" : "  ERROR: counts differ");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    size_t mb = argc > 1 ? atol(argv[1]) : 64;
+    if (mb == 0) {
+        printf("ERROR: no text\n");
+        return 1;
+    }
+    bench_contains();
+    bench_windows(mb);
+    return 0;
+}
@@ -0,0 +1,25 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+//
+// Width independent part of the histogram compares, included once per
+// instruction set by multiset.cpp inside a namespace that defines Vec: W
+// counts per register, load(), gt_mask(), the bit mask of the counts of a
+// greater than those of b, unsigned, and ne_mask(), of those that differ.
+
+// no count of part above the one of whole
+static bool contains(const uint32_t* whole, const uint32_t* part)
+{
+    unsigned int over = 0;
+    for (int i = 0; i < 256; i += Vec::W)
+        over |= Vec::gt_mask(Vec::load(part + i), Vec::load(whole + i));
+    return over == 0;
+}
+
+// how many of the 256 counts of a and b differ
+static int mismatches(const uint32_t* a, const uint32_t* b)
+{
+    int count = 0;
+    for (int i = 0; i < 256; i += Vec::W)
+        count += __builtin_popcount(Vec::ne_mask(Vec::load(a + i),
+                                                 Vec::load(b + i)));
+    return count;
+}
@@ -0,0 +1,369 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#include <math.h>
+#include <string.h>
+#include <immintrin.h>
+#include <algorithm>
+
+#include "resolution.h"
+
+// for every mask of 8 keys, the indexes of its keys packed to the front
+static uint8_t packIndex[256][8];
+
+#pragma GCC push_options
+#pragma GCC target("avx2,popcnt")
+namespace resolution_avx2 {
+
+struct Vec {
+    typedef __m256i type;
+    enum { W = 8 };
+
+    static type load(const uint32_t* p)
+    {
+        return _mm256_loadu_si256((const __m256i*)p);
+    }
+    // b as it is, its halves swapped, and both rotated within each half by
+    // 1 .. 3 keys: every key of b meets every key of a once, with one slow
+    // cross lane shuffle
+    static unsigned int match_mask(type a, type b)
+    {
+        __m256i c = _mm256_permute2x128_si256(b, b, 1);
+        __m256i eq = _mm256_or_si256(_mm256_cmpeq_epi32(a, b),
+                                     _mm256_cmpeq_epi32(a, c));
+        b = _mm256_shuffle_epi32(b, _MM_SHUFFLE(0, 3, 2, 1));
+        c = _mm256_shuffle_epi32(c, _MM_SHUFFLE(0, 3, 2, 1));
+        eq = _mm256_or_si256(eq, _mm256_or_si256(_mm256_cmpeq_epi32(a, b),
+                                                 _mm256_cmpeq_epi32(a, c)));
+        b = _mm256_shuffle_epi32(b, _MM_SHUFFLE(0, 3, 2, 1));
+        c = _mm256_shuffle_epi32(c, _MM_SHUFFLE(0, 3, 2, 1));
+        eq = _mm256_or_si256(eq, _mm256_or_si256(_mm256_cmpeq_epi32(a, b),
+                                                 _mm256_cmpeq_epi32(a, c)));
+        b = _mm256_shuffle_epi32(b, _MM_SHUFFLE(0, 3, 2, 1));
+        c = _mm256_shuffle_epi32(c, _MM_SHUFFLE(0, 3, 2, 1));
+        eq = _mm256_or_si256(eq, _mm256_or_si256(_mm256_cmpeq_epi32(a, b),
+                                                 _mm256_cmpeq_epi32(a, c)));
+        return _mm256_movemask_ps(_mm256_castsi256_ps(eq));
+    }
+    static size_t store(uint32_t* out, const uint32_t* a, unsigned int mask)
+    {
+        __m256i index = _mm256_cvtepu8_epi32(
+            _mm_loadl_epi64((const __m128i*)packIndex[mask]));
+        _mm256_storeu_si256((__m256i*)out,
+            _mm256_permutevar8x32_epi32(load(a), index));
+        return __builtin_popcount(mask);
+    }
+};
+
+#include "resolution_kernel.h"
+
+} // namespace resolution_avx2
+#pragma GCC pop_options
+
+namespace resolution_sse2 {
+
+struct Vec {
+    typedef __m128i type;
+    enum { W = 4 };
+
+    static type load(const uint32_t* p)
+    {
+        return _mm_loadu_si128((const __m128i*)p);
+    }
+    static unsigned int match_mask(type a, type b)
+    {
+        __m128i eq = _mm_cmpeq_epi32(a, b);
+        b = _mm_shuffle_epi32(b, _MM_SHUFFLE(0, 3, 2, 1));
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(a, b));
+        b = _mm_shuffle_epi32(b, _MM_SHUFFLE(0, 3, 2, 1));
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(a, b));
+        b = _mm_shuffle_epi32(b, _MM_SHUFFLE(0, 3, 2, 1));
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(a, b));
+        return _mm_movemask_ps(_mm_castsi128_ps(eq));
+    }
+    static size_t store(uint32_t* out, const uint32_t* a, unsigned int mask)
+    {
+        size_t k = 0;
+        for (; mask; mask &= mask - 1)
+            out[k++] = a[__builtin_ctz(mask)];
+        return k;
+    }
+};
+
+#include "resolution_kernel.h"
+
+} // namespace resolution_sse2
+
+typedef size_t (*IntersectFunc)(const uint32_t* a, size_t na,
+                                const uint32_t* b, size_t nb, uint32_t* out);
+
+struct ResolutionImpl {
+    IntersectFunc func;
+    const char* isa;
+};
+
+static ResolutionImpl resolve()
+{
+    ResolutionImpl impl;
+    for (int mask = 0; mask < 256; mask++) {
+        int k = 0;
+        for (int i = 0; i < 8; i++) {
+            if (mask & (1 << i))
+                packIndex[mask][k++] = i;
+        }
+    }
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        impl.func = resolution_avx2::intersect_sorted;
+        impl.isa = "avx2";
+    } else {
+        impl.func = resolution_sse2::intersect_sorted;
+        impl.isa = "sse2";
+    }
+    return impl;
+}
+
+static const ResolutionImpl & impl()
+{
+    static ResolutionImpl impl = resolve();
+    return impl;
+}
+
+const char* resolution_isa()
+{
+    return impl().isa;
+}
+
+// 1 .. 65535 decimal digits up to end or to the first byte that is not a
+// digit, which end is set to
+static int parse_side(const char* s, const char** end)
+{
+    int value = 0;
+    const char* p = s;
+    for (; *p >= '0' && *p <= '9'; p++) {
+        value = value * 10 + (*p - '0');
+        if (value > 65535)
+            return 0;
+    }
+    *end = p;
+    return p == s ? 0 : value;
+}
+
+bool parse_resolution(const char* s, Resolution & res)
+{
+    const char* p = s;
+    int width = parse_side(p, &p);
+    if (width == 0 || (*p != 'x' && *p != 'X'))
+        return false;
+    int height = parse_side(p + 1, &p);
+    if (height == 0 || *p != '\0')
+        return false;
+    res.width = width;
+    res.height = height;
+    return true;
+}
+
+static bool valid(const Resolution & res)
+{
+    return res.width > 0 && res.width <= 65535 &&
+           res.height > 0 && res.height <= 65535;
+}
+
+ResolutionSet::ResolutionSet()
+  : m_table(RESOLUTION_TABLE_MIN),
+    m_shift(32 - RESOLUTION_TABLE_BITS)
+{
+}
+
+ResolutionSet::ResolutionSet(const std::vector<Resolution> & modes)
+  : m_table(RESOLUTION_TABLE_MIN),
+    m_shift(32 - RESOLUTION_TABLE_BITS)
+{
+    m_keys.reserve(modes.size());
+    for (size_t i = 0; i < modes.size(); i++) {
+        if (valid(modes[i]))
+            m_keys.push_back(modes[i].key());
+    }
+    std::sort(m_keys.begin(), m_keys.end());
+    // with duplicates, the list is built one mode at a time after all
+    if (std::adjacent_find(m_keys.begin(), m_keys.end()) != m_keys.end()) {
+        m_keys.clear();
+        for (size_t i = 0; i < modes.size(); i++)
+            add(modes[i]);
+        return;
+    }
+    for (size_t i = 0; i < modes.size(); i++) {
+        if (valid(modes[i]))
+            m_append(modes[i]);
+    }
+}
+
+ResolutionSet::ResolutionSet(const char* const* names)
+  : m_table(RESOLUTION_TABLE_MIN),
+    m_shift(32 - RESOLUTION_TABLE_BITS)
+{
+    for (; *names; names++)
+        add(*names);
+}
+
+void ResolutionSet::m_append(const Resolution & res)
+{
+    m_list.push_back(res);
+    m_index(res.key());
+    m_logAspect.push_back(logf((float)res.width / res.height));
+    m_logArea.push_back(logf((float)res.width * res.height));
+}
+
+bool ResolutionSet::add(const Resolution & res)
+{
+    if (!valid(res))
+        return false;
+    uint32_t key = res.key();
+    std::vector<uint32_t>::iterator it = std::lower_bound(m_keys.begin(),
+                                                          m_keys.end(), key);
+    if (it != m_keys.end() && *it == key)
+        return false;
+    m_keys.insert(it, key);
+    m_append(res);
+    return true;
+}
+
+bool ResolutionSet::add(const char* name)
+{
+    Resolution res;
+    return parse_resolution(name, res) && add(res);
+}
+
+// Fibonacci hashing: the top bits of the key times 2^32 / phi
+size_t ResolutionSet::m_home(uint32_t key) const
+{
+    return (uint32_t)(key * 2654435769U) >> m_shift;
+}
+
+// key 0 is no mode, so it marks a free slot
+void ResolutionSet::m_index(uint32_t key)
+{
+    if (m_list.size() * 2 > m_table.size()) {
+        std::vector<uint32_t> old;
+        old.swap(m_table);
+        m_table.resize(old.size() * 2);
+        m_shift--;
+        for (size_t i = 0; i < old.size(); i++) {
+            if (old[i])
+                m_index(old[i]);
+        }
+    }
+    size_t mask = m_table.size() - 1;
+    size_t slot = m_home(key);
+    while (m_table[slot])
+        slot = (slot + 1) & mask;
+    m_table[slot] = key;
+}
+
+bool ResolutionSet::contains(const Resolution & res) const
+{
+    uint32_t key = res.key();
+    size_t mask = m_table.size() - 1;
+    for (size_t slot = m_home(key); m_table[slot];
+         slot = (slot + 1) & mask) {
+        if (m_table[slot] == key)
+            return true;
+    }
+    return false;
+}
+
+size_t intersect_hashed(const ResolutionSet & a, const ResolutionSet & b,
+                        std::vector<Resolution> & out)
+{
+    if (a.size() == 0 || b.size() == 0)
+        return 0;
+    size_t found = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (b.contains(a[i])) {
+            out.push_back(a[i]);
+            found++;
+        }
+    }
+    return found;
+}
+
+size_t intersect_sorted(const ResolutionSet & a, const ResolutionSet & b,
+                        std::vector<Resolution> & out)
+{
+    size_t most = std::min(a.size(), b.size());
+    if (most == 0)
+        return 0;
+    // kept from call to call; the AVX2 kernel stores whole registers
+    static thread_local std::vector<uint32_t> keys;
+    if (keys.size() < most + 8)
+        keys.resize(most + 8);
+    size_t found = impl().func(&a.keys()[0], a.size(), &b.keys()[0],
+                               b.size(), &keys[0]);
+    size_t start = out.size();
+    out.resize(start + found);
+    for (size_t i = 0; i < found; i++) {
+        out[start + i].width = keys[i] >> 16;
+        out[start + i].height = keys[i] & 0xffff;
+    }
+    return found;
+}
+
+size_t intersect(const ResolutionSet & a, const ResolutionSet & b,
+                 std::vector<Resolution> & out)
+{
+    if (a.size() >= RESOLUTION_MERGE_MIN && b.size() >= RESOLUTION_MERGE_MIN)
+        return intersect_sorted(a, b, out);
+    return intersect_hashed(a, b, out);
+}
+
+bool best_common(const ResolutionSet & a, const ResolutionSet & b,
+                 Resolution & res)
+{
+    if (a.size() == 0 || b.size() == 0)
+        return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (b.contains(a[i])) {
+            res = a[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+bool best_fit(const ResolutionSet & a, const ResolutionSet & b,
+              ResolutionMatch & match)
+{
+    if (a.size() == 0 || b.size() == 0)
+        return false;
+    float best = HUGE_VALF;
+    size_t bestA = 0, bestB = 0;
+    for (size_t i = 0; i < a.size() && best > 0; i++) {
+        float aspect = a.log_aspect(i);
+        float area = a.log_area(i);
+        for (size_t j = 0; j < b.size(); j++) {
+            float score = RESOLUTION_ASPECT_WEIGHT *
+                          fabsf(aspect - b.log_aspect(j)) +
+                          fabsf(area - b.log_area(j));
+            if (score < best) {
+                best = score;
+                bestA = i;
+                bestB = j;
+            }
+        }
+    }
+    match.primary = a[bestA];
+    match.second = b[bestB];
+    // the logarithms of the same mode are the same, but leave no doubt
+    match.score = a[bestA] == b[bestB] ? 0 : best;
+    return true;
+}
+
+void best_fit_batch(const ResolutionSet* a, const ResolutionSet* b,
+                    size_t count, ResolutionMatch* out)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (!best_fit(a[i], b[i], out[i])) {
+            memset(&out[i], 0, sizeof(out[i]));
+            out[i].score = -1;
+        }
+    }
+}
@@ -0,0 +1,116 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#ifndef __RESOLUTION_H__
+#define __RESOLUTION_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// intersect() merges the sorted keys when both sets have at least this
+// many modes, and probes a hash table otherwise
+#define RESOLUTION_MERGE_MIN        16
+// how much more a difference in aspect ratio counts than one in area
+#define RESOLUTION_ASPECT_WEIGHT    4.0f
+// slots of the hash table of an empty set
+#define RESOLUTION_TABLE_BITS       5
+#define RESOLUTION_TABLE_MIN        (1 << RESOLUTION_TABLE_BITS)
+
+// A display mode, width and height each 1 .. 65535.
+struct Resolution {
+    int width;
+    int height;
+
+    // width in the high half, so keys sort by width and then height
+    uint32_t key() const { return (uint32_t)width << 16 | height; }
+    bool operator==(const Resolution & other) const
+    {
+        return width == other.width && height == other.height;
+    }
+};
+
+// "1280x800" (or "1280X800"); false, leaving res alone, for anything else
+bool parse_resolution(const char* s, Resolution & res);
+
+// The modes one display supports, in its order of preference, duplicates
+// dropped. Besides the list it keeps the keys sorted, for the merge, the
+// keys in a linear probing hash table at most half full, for contains(),
+// and the logarithms of every aspect ratio and area, for best_fit().
+class ResolutionSet
+{
+public:
+    ResolutionSet();
+    explicit ResolutionSet(const std::vector<Resolution> & modes);
+    // a NULL terminated list of "WxH" names; bad names are skipped
+    explicit ResolutionSet(const char* const* names);
+
+    // false when res is already there or not a valid mode
+    bool add(const Resolution & res);
+    bool add(const char* name);
+
+    size_t size() const { return m_list.size(); }
+    const Resolution & operator[](size_t i) const { return m_list[i]; }
+    const std::vector<uint32_t> & keys() const { return m_keys; }
+    bool contains(const Resolution & res) const;
+
+    // logarithms of the aspect ratio and of the area of mode i
+    float log_aspect(size_t i) const { return m_logAspect[i]; }
+    float log_area(size_t i) const { return m_logArea[i]; }
+
+private:
+    void m_append(const Resolution & res);
+    size_t m_home(uint32_t key) const;
+    void m_index(uint32_t key);
+
+    std::vector<Resolution> m_list;
+    std::vector<uint32_t> m_keys;
+    std::vector<uint32_t> m_table;
+    // 32 minus the bits of a slot number
+    int m_shift;
+    std::vector<float> m_logAspect;
+    std::vector<float> m_logArea;
+};
+
+// The modes in both a and b, appended to out in the order of a, found by
+// probing the hash table of b with the keys of a. Returns how many there
+// were.
+size_t intersect_hashed(const ResolutionSet & a, const ResolutionSet & b,
+                        std::vector<Resolution> & out);
+// The same in key order, found by merging the sorted keys a block of 8
+// (AVX2) or 4 (SSE2) keys at a time: each key of a block of a is compared
+// with every key of a block of b, by comparing the blocks as they are and
+// rotated, and the block with the smaller last key moves on.
+size_t intersect_sorted(const ResolutionSet & a, const ResolutionSet & b,
+                        std::vector<Resolution> & out);
+// either of them, by the sizes of the sets
+size_t intersect(const ResolutionSet & a, const ResolutionSet & b,
+                 std::vector<Resolution> & out);
+
+// the first mode of a that b has too, what similar used to look for
+bool best_common(const ResolutionSet & a, const ResolutionSet & b,
+                 Resolution & res);
+
+struct ResolutionMatch {
+    Resolution primary;
+    Resolution second;
+    // 0 for the same mode on both
+    float score;
+};
+
+// The pair of modes, one from each set, that look the most alike: the
+// score is RESOLUTION_ASPECT_WEIGHT times the distance of the logarithms
+// of their aspect ratios plus the distance of those of their areas, and
+// of pairs scoring the same the one earlier in a, then in b, wins. So a
+// mode both have always wins, and the best one is best_common()'s. False
+// when either set is empty.
+bool best_fit(const ResolutionSet & a, const ResolutionSet & b,
+              ResolutionMatch & match);
+// best_fit() of a[i] and b[i] into out[i] for count configurations; a pair
+// with an empty set gets a score of -1
+void best_fit_batch(const ResolutionSet* a, const ResolutionSet* b,
+                    size_t count, ResolutionMatch* out);
+
+// "avx2" or "sse2", what intersect_sorted() runs on
+const char* resolution_isa();
+
+#endif // __RESOLUTION_H__
@@ -0,0 +1,188 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+//
+//   resolution_bench [CONFIGS]
+//
+// For CONFIGS (100000 by default) pairs of displays, each with 4 .. 32
+// common modes, finds the first mode of the primary that the second has
+// with the nested strcmp() loop similar used and with best_common(), and
+// the best fitting pair with best_fit_batch(). Then intersects sets of 64
+// .. 65536 random modes with intersect_hashed(), intersect_sorted() and
+// std::set_intersection().
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "resolution.h"
+#include "bench.h"
+
+static const char* commonModes[] = {
+    "640x400", "640x480", "720x400", "720x480", "720x576", "800x480",
+    "800x600", "832x624", "1024x600", "1024x768", "1152x864", "1152x870",
+    "1280x720", "1280x768", "1280x800", "1280x960", "1280x1024", "1360x768",
+    "1366x768", "1400x1050", "1440x900", "1536x864", "1600x900",
+    "1600x1200", "1680x1050", "1920x1080", "1920x1200", "2048x1152",
+    "2560x1080", "2560x1440", "2560x1600", "2880x1800", "3440x1440",
+    "3840x1600", "3840x2160", "4096x2160", "5120x1440", "5120x2880",
+    "7680x4320", NULL};
+
+// 4 .. 32 different modes, largest first, as displays list them
+static void make_display(std::vector<const char*> & names)
+{
+    int modes = 0;
+    while (commonModes[modes])
+        modes++;
+    std::vector<int> picked(modes);
+    for (int i = 0; i < modes; i++)
+        picked[i] = i;
+    for (int i = modes - 1; i > 0; i--)
+        std::swap(picked[i], picked[bench_rand() % (i + 1)]);
+    picked.resize(4 + bench_rand() % 29);
+    std::sort(picked.begin(), picked.end());
+    for (int i = (int)picked.size() - 1; i >= 0; i--)
+        names.push_back(commonModes[picked[i]]);
+    names.push_back(NULL);
+}
+
+// the loop similar had, -1 for none
+static int first_common(const char* const* primary,
+                        const char* const* second)
+{
+    for (int i = 0; primary[i]; i++) {
+        for (int j = 0; second[j]; j++) {
+            if (strcmp(primary[i], second[j]) == 0)
+                return i;
+        }
+    }
+    return -1;
+}
+
+static void bench_displays(size_t configs)
+{
+    std::vector<std::vector<const char*> > names(2 * configs);
+    for (size_t i = 0; i < 2 * configs; i++)
+        make_display(names[i]);
+
+    double start = now_sec();
+    std::vector<int> expect(configs);
+    for (size_t i = 0; i < configs; i++)
+        expect[i] = first_common(&names[2 * i][0], &names[2 * i + 1][0]);
+    double strcmpSec = now_sec() - start;
+
+    start = now_sec();
+    std::vector<ResolutionSet> primary, second;
+    for (size_t i = 0; i < configs; i++) {
+        primary.push_back(ResolutionSet(&names[2 * i][0]));
+        second.push_back(ResolutionSet(&names[2 * i + 1][0]));
+    }
+    double parseSec = now_sec() - start;
+
+    start = now_sec();
+    size_t wrong = 0;
+    for (size_t i = 0; i < configs; i++) {
+        Resolution res;
+        bool found = best_common(primary[i], second[i], res);
+        if (found != (expect[i] >= 0) ||
+            (found && !(res == primary[i][expect[i]])))
+            wrong++;
+    }
+    double commonSec = now_sec() - start;
+
+    std::vector<ResolutionMatch> matches(configs);
+    start = now_sec();
+    best_fit_batch(&primary[0], &second[0], configs, &matches[0]);
+    double fitSec = now_sec() - start;
+    for (size_t i = 0; i < configs; i++) {
+        if ((matches[i].score == 0) != (expect[i] >= 0))
+            wrong++;
+    }
+
+    printf("%zu display pairs, configurations/s:\n", configs);
+    printf(" strcmp loop    %12.0f\n", configs / strcmpSec);
+    printf(" parse sets     %12.0f\n", configs / parseSec);
+    printf(" best_common    %12.0f\n", configs / commonSec);
+    printf(" best_fit_batch %12.0f%s\n", configs / fitSec,
+           wrong ? "  ERROR: answers differ" : "");
+}
+
+// size random modes, about half of them in both sets
+static void make_sets(size_t size, std::vector<Resolution> & a,
+                      std::vector<Resolution> & b)
+{
+    for (size_t i = 0; i < size; i++) {
+        Resolution res;
+        res.width = 1 + bench_rand() % 65535;
+        res.height = 1 + bench_rand() % 65535;
+        a.push_back(res);
+        if (bench_rand() % 2) {
+            res.width = 1 + bench_rand() % 65535;
+            res.height = 1 + bench_rand() % 65535;
+        }
+        b.push_back(res);
+    }
+}
+
+// enough different pairs of sets at each size that the branches of the
+// scalar merge can not be learnt
+static void bench_intersect()
+{
+    printf("intersect (%s):  size   hashed     sorted  set_intersection\n",
+           resolution_isa());
+    for (size_t size = 64; size <= 65536; size *= 4) {
+        size_t pairs = std::max((size_t)1, (size_t)65536 / size);
+        std::vector<ResolutionSet> a, b;
+        for (size_t p = 0; p < pairs; p++) {
+            std::vector<Resolution> modesA, modesB;
+            make_sets(size, modesA, modesB);
+            a.push_back(ResolutionSet(modesA));
+            b.push_back(ResolutionSet(modesB));
+        }
+        int rounds = std::max((size_t)1, ((size_t)1 << 22) / size / pairs);
+        std::vector<Resolution> out;
+        std::vector<uint32_t> keys;
+        double sec[3];
+        size_t found[3] = {0, 0, 0};
+        for (int m = 0; m < 3; m++) {
+            double start = now_sec();
+            for (int r = 0; r < rounds; r++) {
+                for (size_t p = 0; p < pairs; p++) {
+                    out.clear();
+                    keys.clear();
+                    if (m == 0) {
+                        found[m] += intersect_hashed(a[p], b[p], out);
+                    } else if (m == 1) {
+                        found[m] += intersect_sorted(a[p], b[p], out);
+                    } else {
+                        std::set_intersection(a[p].keys().begin(),
+                                              a[p].keys().end(),
+                                              b[p].keys().begin(),
+                                              b[p].keys().end(),
+                                              std::back_inserter(keys));
+                        found[m] += keys.size();
+                    }
+                }
+            }
+            sec[m] = (now_sec() - start) / rounds / pairs;
+        }
+        printf("%23zu %7.2fus %8.2fus %10.2fus%s\n", size, sec[0] * 1e6,
+               sec[1] * 1e6, sec[2] * 1e6,
+               found[0] == found[2] && found[1] == found[2] ? "" :
+               "  ERROR: counts differ");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    size_t configs = argc > 1 ? atol(argv[1]) : 100000;
+    if (configs == 0) {
+        printf("ERROR: no configurations\n");
+        return 1;
+    }
+    bench_displays(configs);
+    bench_intersect();
+    return 0;
+}
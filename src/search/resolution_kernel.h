@@ -0,0 +1,37 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+//
+// Width independent part of the sorted intersection, included once per
+// instruction set by resolution.cpp inside a namespace that defines Vec: W
+// keys per register, load(), match_mask(), the bit mask of the keys of a
+// that are equal to any key of b, and store(), which writes the keys of a
+// in a mask next to each other and returns how many.
+
+// keys in both a and b, both sorted and without duplicates, into out
+static size_t intersect_sorted(const uint32_t* a, size_t na,
+                               const uint32_t* b, size_t nb, uint32_t* out)
+{
+    const size_t W = Vec::W;
+    size_t i = 0, j = 0, k = 0;
+    while (i + W <= na && j + W <= nb) {
+        unsigned int mask = Vec::match_mask(Vec::load(a + i),
+                                            Vec::load(b + j));
+        k += Vec::store(out + k, a + i, mask);
+        // which block moves on is a coin toss on most data, so no branch
+        uint32_t lastA = a[i + W - 1];
+        uint32_t lastB = b[j + W - 1];
+        i += W & -(size_t)(lastA <= lastB);
+        j += W & -(size_t)(lastB <= lastA);
+    }
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) {
+            i++;
+        } else if (b[j] < a[i]) {
+            j++;
+        } else {
+            out[k++] = a[i];
+            i++;
+            j++;
+        }
+    }
+    return k;
+}
@@ -0,0 +1,108 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+//
+//   search_bench [MAX_LOG2 [QUERIES]]
+//
+// ns per lower_bound, flat, Eytzinger and S-tree, over sorted arrays of
+// 2^10 .. 2^MAX_LOG2 random ints (default 2^24; 2^30 needs about 12 GB).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+#include "eytzinger.h"
+#include "stree.h"
+#include "bench.h"
+
+// binary search over the flat array with a select instead of a branch
+static size_t branchless_lower_bound(const std::vector<int> & list, int key)
+{
+    const int* base = &list[0];
+    size_t size = list.size();
+    if (size == 0)
+        return 0;
+    while (size > 1) {
+        size_t half = size / 2;
+        base = base[half - 1] < key ? base + half : base;
+        size -= half;
+    }
+    return (base - &list[0]) + (*base < key);
+}
+
+static void report(const char* name, double sec, size_t queries,
+                   size_t sum, size_t expect)
+{
+    printf(" %-22s %7.1fns%s\n", name, sec * 1e9 / queries,
+           sum == expect ? "" : "  ERROR: wrong result");
+}
+
+int main(int argc, char* argv[])
+{
+    int maxLog = argc > 1 ? atoi(argv[1]) : 24;
+    size_t queries = argc > 2 ? atol(argv[2]) : 1 << 22;
+    std::vector<int> keys(queries);
+    std::vector<size_t> out(queries);
+    for (size_t i = 0; i < queries; i++)
+        keys[i] = (int)bench_rand();
+
+    for (int log = 10; log <= maxLog; log += 2) {
+        size_t size = (size_t)1 << log;
+        std::vector<int> list(size);
+        for (size_t i = 0; i < size; i++)
+            list[i] = (int)bench_rand();
+        std::sort(list.begin(), list.end());
+        printf("2^%d ints, %zu KB\n", log, size * sizeof(int) >> 10);
+
+        size_t expect = 0;
+        double start = now_sec();
+        for (size_t i = 0; i < queries; i++)
+            expect += std::lower_bound(list.begin(), list.end(), keys[i]) -
+                      list.begin();
+        report("std::lower_bound", now_sec() - start, queries, expect, expect);
+
+        size_t sum = 0;
+        start = now_sec();
+        for (size_t i = 0; i < queries; i++)
+            sum += branchless_lower_bound(list, keys[i]);
+        report("branchless", now_sec() - start, queries, sum, expect);
+
+        EytzingerIndex eytzinger(list);
+        sum = 0;
+        start = now_sec();
+        for (size_t i = 0; i < queries; i++)
+            sum += eytzinger.lower_bound(keys[i]);
+        report("eytzinger", now_sec() - start, queries, sum, expect);
+
+        sum = 0;
+        start = now_sec();
+        eytzinger.lower_bound(&keys[0], queries, &out[0]);
+        for (size_t i = 0; i < queries; i++)
+            sum += out[i];
+        report("eytzinger batch", now_sec() - start, queries, sum, expect);
+
+        STree stree(list);
+        sum = 0;
+        start = now_sec();
+        for (size_t i = 0; i < queries; i++)
+            sum += stree.lower_bound(keys[i]);
+        report("s-tree", now_sec() - start, queries, sum, expect);
+
+        // upper_bound() and count() against the standard library, once per
+        // thousand queries
+        bool ok = true;
+        for (size_t i = 0; i + 1 < queries; i += 1000) {
+            int low = std::min(keys[i], keys[i + 1]);
+            int high = std::max(keys[i], keys[i + 1]);
+            size_t upper = std::upper_bound(list.begin(), list.end(), high) -
+                           list.begin();
+            size_t lower = std::lower_bound(list.begin(), list.end(), low) -
+                           list.begin();
+            ok = ok && stree.upper_bound(high) == upper &&
+                 stree.count(low, high) == upper - lower;
+        }
+        printf(" s-tree %s, %.1f%% over the array%s\n", stree_isa(),
+               100.0 * stree.bytes() / (size * sizeof(int)) - 100,
+               ok ? "" : "  ERROR: wrong range count");
+    }
+    return 0;
+}
@@ -0,0 +1,44 @@
+/* Copyright (C) 2015 Leslie Zhai <xiang.zhai@i-soft.com.cn> */
+
+#include <stdio.h>
+
+#include "resolution.h"
+
+int main(int argc, char *argv[])
+{
+    const char *primary[] = {"1280x800", "1024x768", "800x600", "640x480",
+                             "640x400", NULL};
+    const char *second[] = {"1366x768", "1280x1024", "1280x960", "1280x720",
+                            "1024x768", "800x600", "640x480", "720x400", NULL};
+    int i;
+
+    printf("primary resolution:\n");
+    i = 0;
+    while (primary[i]) {
+        printf("%s\n", primary[i]);
+        i++;
+    }
+
+    printf("second resolution: \n");
+    i = 0;
+    while (second[i]) {
+        printf("%s\n", second[i]);
+        i++;
+    }
+
+    printf("find the best similar resolution: \n");
+    ResolutionSet primarySet(primary);
+    ResolutionSet secondSet(second);
+    Resolution res;
+    if (best_common(primarySet, secondSet, res)) {
+        printf("%dx%d\n", res.width, res.height);
+        return 0;
+    }
+    // no mode in common, the nearest pair then
+    ResolutionMatch match;
+    if (best_fit(primarySet, secondSet, match))
+        printf("%dx%d ~ %dx%d\n", match.primary.width, match.primary.height,
+               match.second.width, match.second.height);
+
+    return 0;
+}
@@ -0,0 +1,50 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#include "slab_pool.h"
+
+SlabPool::SlabPool(size_t blockSize)
+  : m_blockSize((blockSize + SLAB_ALIGN - 1) & ~(size_t)(SLAB_ALIGN - 1)),
+    m_used(0),
+    m_next(NULL),
+    m_end(NULL),
+    m_free(NULL)
+{
+}
+
+SlabPool::~SlabPool()
+{
+    for (size_t i = 0; i < m_slabs.size(); i++)
+        ::free(m_slabs[i]);
+}
+
+void* SlabPool::alloc()
+{
+    m_used++;
+    if (m_free) {
+        void* block = m_free;
+        m_free = *(void**)block;
+        return block;
+    }
+    if (m_next + m_blockSize > m_end) {
+        void* slab;
+        if (posix_memalign(&slab, SLAB_SIZE, SLAB_SIZE))
+            abort();
+        madvise(slab, SLAB_SIZE, MADV_HUGEPAGE);
+        m_slabs.push_back(slab);
+        m_next = (char*)slab;
+        m_end = m_next + SLAB_SIZE;
+    }
+    void* block = m_next;
+    m_next += m_blockSize;
+    return block;
+}
+
+void SlabPool::free(void* block)
+{
+    *(void**)block = m_free;
+    m_free = block;
+    m_used--;
+}
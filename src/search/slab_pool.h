@@ -0,0 +1,49 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#ifndef __SLAB_POOL_H__
+#define __SLAB_POOL_H__
+
+#include <stddef.h>
+#include <vector>
+
+// blocks are carved out of slabs this big, on a huge page where the
+// kernel has one
+#define SLAB_SIZE       (2 << 20)
+// and start on a cache line
+#define SLAB_ALIGN      64
+
+// Fixed size blocks for nodes: a block is a bump of a pointer in the
+// current slab, or the head of the list of freed blocks, which are reused
+// first. Blocks are aligned to SLAB_ALIGN, so a node of a whole number of
+// cache lines never straddles one more than it has to, and nodes allocated
+// one after the other sit next to each other. Memory goes back to the
+// system only when the pool does.
+class SlabPool
+{
+public:
+    explicit SlabPool(size_t blockSize);
+    ~SlabPool();
+
+    void* alloc();
+    void free(void* block);
+
+    // blockSize rounded up to SLAB_ALIGN
+    size_t block_size() const { return m_blockSize; }
+    size_t used() const { return m_used; }
+    // bytes taken from the system
+    size_t bytes() const { return m_slabs.size() * (size_t)SLAB_SIZE; }
+
+private:
+    SlabPool(const SlabPool &);
+    SlabPool & operator=(const SlabPool &);
+
+    size_t m_blockSize;
+    size_t m_used;
+    std::vector<void*> m_slabs;
+    char* m_next;
+    char* m_end;
+    // freed blocks, linked through their first word
+    void* m_free;
+};
+
+#endif // __SLAB_POOL_H__
@@ -0,0 +1,141 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#include <limits.h>
+#include <stdlib.h>
+#include <immintrin.h>
+
+#include "stree.h"
+
+#pragma GCC push_options
+#pragma GCC target("avx2,popcnt")
+namespace stree_avx2 {
+
+static inline int rank(const int* node, int key)
+{
+    __m256i x = _mm256_set1_epi32(key);
+    __m256i lo = _mm256_cmpgt_epi32(x, _mm256_load_si256((const __m256i*)node));
+    __m256i hi = _mm256_cmpgt_epi32(x,
+        _mm256_load_si256((const __m256i*)(node + 8)));
+    unsigned int mask = _mm256_movemask_ps(_mm256_castsi256_ps(lo)) |
+                        _mm256_movemask_ps(_mm256_castsi256_ps(hi)) << 8;
+    return __builtin_popcount(mask);
+}
+
+#include "stree_kernel.h"
+
+} // namespace stree_avx2
+#pragma GCC pop_options
+
+namespace stree_sse2 {
+
+static inline int rank(const int* node, int key)
+{
+    __m128i x = _mm_set1_epi32(key);
+    int count = 0;
+    for (int i = 0; i < STREE_B; i += 4) {
+        __m128i lt = _mm_cmpgt_epi32(x, _mm_load_si128((const __m128i*)(node + i)));
+        count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(lt)));
+    }
+    return count;
+}
+
+#include "stree_kernel.h"
+
+} // namespace stree_sse2
+
+typedef size_t (*LowerBoundFunc)(const int* tree, const size_t* offset,
+                                 int height, int key);
+
+struct STreeImpl {
+    LowerBoundFunc func;
+    const char* isa;
+};
+
+static STreeImpl resolve()
+{
+    STreeImpl impl;
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        impl.func = stree_avx2::lower_bound;
+        impl.isa = "avx2";
+    } else {
+        impl.func = stree_sse2::lower_bound;
+        impl.isa = "sse2";
+    }
+    return impl;
+}
+
+static const STreeImpl & impl()
+{
+    static STreeImpl impl = resolve();
+    return impl;
+}
+
+STree::STree(const std::vector<int> & sorted)
+  : m_size(sorted.size()),
+    m_height(0),
+    m_tree(NULL)
+{
+    // nodes per level, up to a single root
+    std::vector<size_t> nodes;
+    nodes.push_back((m_size + STREE_B - 1) / STREE_B);
+    if (nodes[0] == 0)
+        nodes[0] = 1;
+    while (nodes.back() > 1)
+        nodes.push_back((nodes.back() + STREE_B) / (STREE_B + 1));
+    m_height = nodes.size();
+    m_offset.push_back(0);
+    for (int h = 0; h < m_height; h++)
+        m_offset.push_back(m_offset[h] + nodes[h] * STREE_B);
+
+    if (posix_memalign((void**)&m_tree, 64, bytes()))
+        abort();
+    // INT_MAX pads the last leaf and stands for missing children, it is
+    // never counted as less than a key
+    for (size_t i = 0; i < m_offset[1]; i++)
+        m_tree[i] = i < m_size ? sorted[i] : INT_MAX;
+    for (int h = 1; h < m_height; h++) {
+        for (size_t k = 0; k < nodes[h]; k++) {
+            for (int j = 0; j < STREE_B; j++) {
+                // the smallest key below child j + 1 is the first key of
+                // its leftmost leaf
+                size_t child = k * (STREE_B + 1) + j + 1;
+                int key = INT_MAX;
+                if (child < nodes[h - 1]) {
+                    for (int l = h - 1; l > 0; l--)
+                        child *= STREE_B + 1;
+                    key = m_tree[child * STREE_B];
+                }
+                m_tree[m_offset[h] + k * STREE_B + j] = key;
+            }
+        }
+    }
+}
+
+STree::~STree()
+{
+    free(m_tree);
+}
+
+size_t STree::lower_bound(int key) const
+{
+    size_t i = impl().func(m_tree, &m_offset[0], m_height, key);
+    return i < m_size ? i : m_size;
+}
+
+size_t STree::upper_bound(int key) const
+{
+    return key == INT_MAX ? m_size : lower_bound(key + 1);
+}
+
+size_t STree::count(int low, int high) const
+{
+    if (low > high)
+        return 0;
+    return upper_bound(high) - lower_bound(low);
+}
+
+const char* stree_isa()
+{
+    return impl().isa;
+}
@@ -0,0 +1,53 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#ifndef __STREE_H__
+#define __STREE_H__
+
+#include <stddef.h>
+#include <vector>
+
+// keys per node, one cache line of ints
+#define STREE_B     16
+
+// Static B+ tree ("S-tree") over a sorted array. The leaves are the array
+// itself, padded to whole nodes; every inner node holds, for each of its
+// children but the first, the smallest key below that child, so there are
+// STREE_B + 1 children a node and the inner levels add about 1/16 to the
+// size. The nodes of each level are stored one after the other, a child
+// found by index arithmetic rather than a pointer, and a node is searched
+// by counting its keys less than the key with two AVX2 compares, or four
+// SSE2 ones on older CPUs.
+class STree
+{
+public:
+    explicit STree(const std::vector<int> & sorted);
+    ~STree();
+
+    size_t size() const { return m_size; }
+    // bytes taken by the leaves and inner levels
+    size_t bytes() const { return m_offset.back() * sizeof(int); }
+
+    // index in the sorted array of the first element not less than key,
+    // size() when there is none
+    size_t lower_bound(int key) const;
+    // the first element greater than key
+    size_t upper_bound(int key) const;
+    // number of elements in [low, high]
+    size_t count(int low, int high) const;
+
+private:
+    STree(const STree &);
+    STree & operator=(const STree &);
+
+    size_t m_size;
+    int m_height;
+    // level h starts at m_offset[h], level 0 being the leaves; the last
+    // entry is the end of the root
+    std::vector<size_t> m_offset;
+    int* m_tree;
+};
+
+// "avx2" or "sse2"
+const char* stree_isa();
+
+#endif // __STREE_H__
@@ -0,0 +1,14 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+//
+// Instruction set independent part of STree::lower_bound(), included once
+// per instruction set by stree.cpp inside a namespace that defines
+// rank(node, key): how many of the STREE_B keys of node are less than key.
+
+static size_t lower_bound(const int* tree, const size_t* offset, int height,
+                          int key)
+{
+    size_t k = 0;
+    for (int h = height - 1; h > 0; h--)
+        k = k * (STREE_B + 1) + rank(tree + offset[h] + k * STREE_B, key);
+    return k * STREE_B + rank(tree + k * STREE_B, key);
+}
@@ -0,0 +1,96 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+//
+//   string_bench [MB | FILE]
+//
+// GB/s counting every match of patterns of 1 .. 1024 bytes, taken from the
+// corpus, with StringSearch, std::string::find and memmem(). The corpus is
+// FILE, or MB megabytes (256 by default) of generated words.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#include "string_search.h"
+#include "bench.h"
+
+// words of 2 .. 10 letters, the common ones much more common
+static void make_corpus(std::string & text, size_t size)
+{
+    std::string words[4096];
+    for (int i = 0; i < 4096; i++) {
+        int len = 2 + bench_rand() % 9;
+        for (int j = 0; j < len; j++)
+            words[i] += 'a' + bench_rand() % 26;
+    }
+    text.reserve(size + 16);
+    while (text.size() < size) {
+        text += words[bench_rand() % (bench_rand() % 4096 + 1)];
+        text += bench_rand() % 16 ? ' ' : '\n';
+    }
+    text.resize(size);
+}
+
+static bool read_corpus(std::string & text, const char* path)
+{
+    FILE* fp = fopen(path, "rb");
+    if (!fp)
+        return false;
+    char buf[1 << 16];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+        text.append(buf, n);
+    fclose(fp);
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string text;
+    if (argc > 1 && read_corpus(text, argv[1])) {
+        printf("%s, %.1f MB\n", argv[1], text.size() / 1e6);
+    } else {
+        size_t mb = argc > 1 ? atol(argv[1]) : 256;
+        make_corpus(text, mb << 20);
+        printf("%zu MB of words\n", mb);
+    }
+    if (text.size() < 2048) {
+        printf("ERROR: corpus too small\n");
+        return 1;
+    }
+    double gb = text.size() / 1e9;
+
+    printf("  len  algorithm      matches  StringSearch  std::string   memmem\n");
+    for (size_t len = 1; len <= 1024; len *= 2) {
+        std::string pattern = text.substr(bench_rand() % (text.size() - len),
+                                          len);
+        StringSearch search(pattern.data(), len);
+        double start = now_sec();
+        size_t count = search.count(text.data(), text.size());
+        double ours = now_sec() - start;
+
+        size_t stdCount = 0;
+        start = now_sec();
+        for (size_t pos = text.find(pattern); pos != std::string::npos;
+             pos = text.find(pattern, pos + 1))
+            stdCount++;
+        double std = now_sec() - start;
+
+        size_t memCount = 0;
+        start = now_sec();
+        const char* end = text.data() + text.size();
+        for (const char* p = text.data(); p < end; p++) {
+            p = (const char*)memmem(p, end - p, pattern.data(), len);
+            if (!p)
+                break;
+            memCount++;
+        }
+        double mem = now_sec() - start;
+
+        printf("%5zu  %-9s %12zu %10.2fGB/s %8.2fGB/s %6.2fGB/s%s\n", len,
+               search.algorithm(), count, gb / ours, gb / std, gb / mem,
+               count == stdCount && count == memCount ? "" :
+               "  ERROR: counts differ");
+    }
+    return 0;
+}
@@ -0,0 +1,240 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#include <string.h>
+#include <immintrin.h>
+#include <algorithm>
+
+#include "string_search.h"
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+namespace search_avx2 {
+
+struct Vec {
+    typedef __m256i type;
+    enum { W = 32 };
+
+    static type set1(unsigned char c) { return _mm256_set1_epi8(c); }
+    static type load(const unsigned char* p)
+    {
+        return _mm256_loadu_si256((const __m256i*)p);
+    }
+    static unsigned int eq_mask(type a, type b)
+    {
+        return _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b));
+    }
+};
+
+#include "string_search_kernel.h"
+
+} // namespace search_avx2
+#pragma GCC pop_options
+
+namespace search_sse2 {
+
+struct Vec {
+    typedef __m128i type;
+    enum { W = 16 };
+
+    static type set1(unsigned char c) { return _mm_set1_epi8(c); }
+    static type load(const unsigned char* p)
+    {
+        return _mm_loadu_si128((const __m128i*)p);
+    }
+    static unsigned int eq_mask(type a, type b)
+    {
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(a, b));
+    }
+};
+
+#include "string_search_kernel.h"
+
+} // namespace search_sse2
+
+static bool has_avx2()
+{
+    static bool avx2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+    return avx2;
+}
+
+// Crochemore-Perrin maximal suffix of x[0..len) under the byte order, or
+// under the reverse order; returns where it starts minus one and sets
+// period to its period
+static size_t max_suffix(const unsigned char* x, size_t len, bool reverse,
+                         size_t & period)
+{
+    size_t ms = STRING_NPOS;
+    size_t j = 0, k = 1;
+    period = 1;
+    while (j + k < len) {
+        unsigned char a = x[j + k];
+        unsigned char b = x[ms + k];
+        if (a == b) {
+            if (k == period) {
+                j += period;
+                k = 1;
+            } else {
+                k++;
+            }
+        } else if (reverse ? a > b : a < b) {
+            j += k;
+            k = 1;
+            period = j - ms;
+        } else {
+            ms = j++;
+            k = period = 1;
+        }
+    }
+    return ms;
+}
+
+StringSearch::StringSearch(const char* pattern, size_t size)
+  : m_pattern((const unsigned char*)pattern,
+              (const unsigned char*)pattern + size),
+    m_algorithm("memchr"),
+    m_short(NULL),
+    m_split(0),
+    m_period(1),
+    m_periodic(false)
+{
+    const unsigned char* p = size ? &m_pattern[0] : NULL;
+    for (int c = 0; c < 256; c++)
+        m_shift[c] = size;
+    for (size_t i = 0; i + 1 < size; i++)
+        m_shift[p[i]] = size - 1 - i;
+
+    if (size > 1 && size <= SEARCH_SHORT_MAX) {
+        if (has_avx2()) {
+            m_short = search_avx2::find_short;
+            m_algorithm = "avx2";
+        } else {
+            m_short = search_sse2::find_short;
+            m_algorithm = "sse2";
+        }
+    } else if (size > SEARCH_SHORT_MAX) {
+        m_algorithm = "two-way";
+        // the critical factorization is the later of the two maximal
+        // suffixes
+        size_t period, reversePeriod;
+        size_t ms = max_suffix(p, size, false, period);
+        size_t rms = max_suffix(p, size, true, reversePeriod);
+        if (rms + 1 > ms + 1) {
+            ms = rms;
+            period = reversePeriod;
+        }
+        m_split = ms + 1;
+        // the left part occurring again one period on means the whole
+        // pattern has that period; otherwise any shift up to the longer
+        // part is safe
+        if (memcmp(p, p + period, m_split) == 0) {
+            m_period = period;
+            m_periodic = true;
+        } else {
+            m_period = std::max(m_split, size - m_split) + 1;
+            m_periodic = false;
+        }
+    }
+}
+
+size_t StringSearch::m_find(const unsigned char* text, size_t size) const
+{
+    size_t len = m_pattern.size();
+    if (len == 0)
+        return 0;
+    if (len > size)
+        return STRING_NPOS;
+    if (len == 1) {
+        const void* hit = memchr(text, m_pattern[0], size);
+        return hit ? (const unsigned char*)hit - text : STRING_NPOS;
+    }
+    if (m_short)
+        return m_short(text, size, &m_pattern[0], len);
+    size_t memory = 0;
+    return m_two_way(text, size, 0, memory);
+}
+
+// Compare the right part left to right and the left part right to left: a
+// mismatch on the right shifts past what matched, one on the left by the
+// period. For a periodic pattern the prefix known to match after such a
+// shift, memory, is not compared again, which keeps the search linear. The
+// search starts at from with what memory says is known there.
+size_t StringSearch::m_two_way(const unsigned char* text, size_t size,
+                               size_t from, size_t & memory) const
+{
+    const unsigned char* p = &m_pattern[0];
+    size_t len = m_pattern.size();
+    unsigned char lastByte = p[len - 1];
+    for (size_t pos = from; pos + len <= size; ) {
+        // the last byte first, as in Horspool
+        unsigned char c = text[pos + len - 1];
+        if (c != lastByte) {
+            pos += m_shift[c];
+            memory = 0;
+            continue;
+        }
+        size_t i = std::max(m_split, memory);
+        while (i < len && p[i] == text[pos + i])
+            i++;
+        if (i < len) {
+            pos += i - m_split + 1;
+            memory = 0;
+            continue;
+        }
+        i = m_split;
+        while (i > memory && p[i - 1] == text[pos + i - 1])
+            i--;
+        if (i <= memory)
+            return pos;
+        pos += m_period;
+        memory = m_periodic ? len - m_period : 0;
+    }
+    return STRING_NPOS;
+}
+
+size_t StringSearch::find(const char* text, size_t size) const
+{
+    return m_find((const unsigned char*)text, size);
+}
+
+// Two-Way goes on one period past a match, with the memory that gives;
+// the others just search again from the next byte
+template <typename Func>
+size_t StringSearch::m_each(const unsigned char* text, size_t size,
+                            Func func) const
+{
+    size_t len = m_pattern.size();
+    size_t found = 0;
+    if (len > SEARCH_SHORT_MAX) {
+        size_t memory = 0;
+        for (size_t pos = 0; ; pos += m_period) {
+            pos = m_two_way(text, size, pos, memory);
+            if (pos == STRING_NPOS)
+                break;
+            func(pos);
+            found++;
+            memory = m_periodic ? len - m_period : 0;
+        }
+        return found;
+    }
+    for (size_t pos = 0; pos <= size; pos++) {
+        size_t hit = m_find(text + pos, size - pos);
+        if (hit == STRING_NPOS)
+            break;
+        pos += hit;
+        func(pos);
+        found++;
+    }
+    return found;
+}
+
+size_t StringSearch::find_all(const char* text, size_t size,
+                              std::vector<size_t> & out) const
+{
+    return m_each((const unsigned char*)text, size,
+                  [&out](size_t pos) { out.push_back(pos); });
+}
+
+size_t StringSearch::count(const char* text, size_t size) const
+{
+    return m_each((const unsigned char*)text, size, [](size_t) {});
+}
@@ -0,0 +1,59 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#ifndef __STRING_SEARCH_H__
+#define __STRING_SEARCH_H__
+
+#include <stddef.h>
+#include <vector>
+
+#define STRING_NPOS         ((size_t)-1)
+// patterns up to this long are found by the SIMD first/last byte filter,
+// longer ones by Two-Way
+#define SEARCH_SHORT_MAX    256
+
+// Substring search for one pattern over byte buffers. The pattern is
+// preprocessed once and the algorithm picked by its length: memchr() for
+// one byte; for short patterns, comparing 32 (AVX2) or 16 (SSE2) positions
+// at once against the first and last byte of the pattern and checking only
+// the candidates; and Two-Way, linear in the worst case, for long ones.
+// Up to SEARCH_SHORT_MAX bytes the filter is faster than Horspool's bad
+// character shifts, which therefore only serve Two-Way.
+class StringSearch
+{
+public:
+    StringSearch(const char* pattern, size_t size);
+
+    // position of the first match in text[0..size), STRING_NPOS if none
+    size_t find(const char* text, size_t size) const;
+    // every match, overlapping ones included, appended to out; returns how
+    // many there were
+    size_t find_all(const char* text, size_t size,
+                    std::vector<size_t> & out) const;
+    size_t count(const char* text, size_t size) const;
+
+    // "memchr", "avx2", "sse2" or "two-way"
+    const char* algorithm() const { return m_algorithm; }
+
+private:
+    typedef size_t (*ShortFunc)(const unsigned char* text, size_t size,
+                                const unsigned char* pattern, size_t len);
+
+    size_t m_find(const unsigned char* text, size_t size) const;
+    size_t m_two_way(const unsigned char* text, size_t size, size_t from,
+                     size_t & memory) const;
+    template <typename Func>
+    size_t m_each(const unsigned char* text, size_t size, Func func) const;
+
+    std::vector<unsigned char> m_pattern;
+    const char* m_algorithm;
+    ShortFunc m_short;
+    // Two-Way: shift by the last byte of the window, Horspool's bad
+    // character rule
+    size_t m_shift[256];
+    // Two-Way: the critical factorization and the period
+    size_t m_split;
+    size_t m_period;
+    bool m_periodic;
+};
+
+#endif // __STRING_SEARCH_H__
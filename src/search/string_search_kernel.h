@@ -0,0 +1,35 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+//
+// Width independent part of the short pattern search, included once per
+// instruction set by string_search.cpp inside a namespace that defines
+// Vec: W bytes per register, set1(), load() and eq_mask(), the bit mask of
+// the bytes of two registers that are equal.
+
+// first position in text where the pattern, 2 .. SEARCH_SHORT_MAX long,
+// starts: W positions at a time are tested against its first and last byte,
+// and only positions that pass both are compared in full
+static size_t find_short(const unsigned char* text, size_t size,
+                         const unsigned char* pattern, size_t len)
+{
+    const int W = Vec::W;
+    if (size < len)
+        return STRING_NPOS;
+    Vec::type first = Vec::set1(pattern[0]);
+    Vec::type last = Vec::set1(pattern[len - 1]);
+    size_t i = 0;
+    for (; i + len - 1 + W <= size; i += W) {
+        unsigned int mask = Vec::eq_mask(Vec::load(text + i), first) &
+                            Vec::eq_mask(Vec::load(text + i + len - 1), last);
+        for (; mask; mask &= mask - 1) {
+            size_t pos = i + __builtin_ctz(mask);
+            if (memcmp(text + pos + 1, pattern + 1, len - 2) == 0)
+                return pos;
+        }
+    }
+    for (; i + len <= size; i++) {
+        if (text[i] == pattern[0] && text[i + len - 1] == pattern[len - 1] &&
+            memcmp(text + i + 1, pattern + 1, len - 2) == 0)
+            return i;
+    }
+    return STRING_NPOS;
+}
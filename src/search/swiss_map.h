@@ -0,0 +1,240 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#ifndef __SWISS_MAP_H__
+#define __SWISS_MAP_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <emmintrin.h>
+#include <functional>
+#include <new>
+#include <utility>
+
+#include "wyhash.h"
+
+// slots per group, probed with one SSE2 compare
+#define SWISS_GROUP     16
+// control byte of a free slot; a full one holds 7 bits of its key's hash
+#define SWISS_EMPTY     ((int8_t)0x80)
+// the map grows once it is this many eighths full
+#define SWISS_MAX_LOAD  7
+
+// Open addressing hash map in the style of Swiss tables: every slot has a
+// control byte, kept apart from the slots in groups of 16, so the slots of
+// a group that may hold a key are found by comparing its 16 control bytes
+// against 7 bits of the key's hash at once, and only those keys are
+// compared. A key goes to the first group with a free slot along
+// triangular steps from the group given by the rest of its hash.
+//
+// Rather than tombstones, each group counts the keys that passed over it
+// because it was full (as in F14). A lookup stops at the first group that
+// nobody passed over, and erase() frees the slot for good and takes the key
+// off the counts along its path, so deletes never slow lookups down and
+// never force a rehash. A count that reaches 255 stays there, as erase()
+// can no longer tell what it stands for; once erase() has had to leave
+// such counts alone capacity() / 8 times, insert() rehashes in place,
+// which counts afresh. A lookup gives up after m_groups steps, by which
+// it has seen every group.
+template <typename Key, typename Value, typename Hash = wy_hash<Key>,
+          typename Equal = std::equal_to<Key> >
+class SwissMap
+{
+public:
+    typedef std::pair<Key, Value> value_type;
+
+    explicit SwissMap(size_t capacity = 0)
+      : m_ctrl(NULL),
+        m_overflow(NULL),
+        m_slots(NULL),
+        m_groups(0),
+        m_size(0),
+        m_stale(0)
+    {
+        size_t groups = 1;
+        while (groups * SWISS_GROUP * SWISS_MAX_LOAD / 8 < capacity)
+            groups *= 2;
+        m_alloc(groups);
+    }
+
+    ~SwissMap()
+    {
+        m_free();
+    }
+
+    size_t size() const { return m_size; }
+    size_t capacity() const { return m_groups * SWISS_GROUP; }
+
+    // false, leaving the value alone, when key is already there
+    bool insert(const Key & key, const Value & value)
+    {
+        uint64_t hash = m_hash(key);
+        if (m_find(key, hash) >= 0)
+            return false;
+        if ((m_size + 1) * 8 > capacity() * SWISS_MAX_LOAD)
+            m_rehash(m_groups * 2);
+        else if (m_stale * 8 > capacity())
+            m_rehash(m_groups);
+        new (&m_slots[m_place(hash)]) value_type(key, value);
+        m_size++;
+        return true;
+    }
+
+    // NULL when key is not there
+    Value* find(const Key & key)
+    {
+        ptrdiff_t slot = m_find(key, m_hash(key));
+        return slot < 0 ? NULL : &m_slots[slot].second;
+    }
+
+    const Value* find(const Key & key) const
+    {
+        ptrdiff_t slot = m_find(key, m_hash(key));
+        return slot < 0 ? NULL : &m_slots[slot].second;
+    }
+
+    bool erase(const Key & key)
+    {
+        uint64_t hash = m_hash(key);
+        ptrdiff_t slot = m_find(key, hash);
+        if (slot < 0)
+            return false;
+        size_t target = slot / SWISS_GROUP;
+        size_t g = m_home(hash);
+        for (size_t step = 1; g != target; step++) {
+            if (m_overflow[g] != 255)
+                m_overflow[g]--;
+            else
+                m_stale++;
+            g = (g + step) & (m_groups - 1);
+        }
+        m_ctrl[slot] = SWISS_EMPTY;
+        m_slots[slot].~value_type();
+        m_size--;
+        return true;
+    }
+
+    template <typename Func>
+    void for_each(Func func) const
+    {
+        for (size_t i = 0; i < capacity(); i++) {
+            if (m_ctrl[i] != SWISS_EMPTY)
+                func(m_slots[i].first, m_slots[i].second);
+        }
+    }
+
+private:
+    SwissMap(const SwissMap &);
+    SwissMap & operator=(const SwissMap &);
+
+    void m_alloc(size_t groups)
+    {
+        m_groups = groups;
+        m_stale = 0;
+        if (posix_memalign((void**)&m_ctrl, 16, capacity()))
+            throw std::bad_alloc();
+        memset(m_ctrl, SWISS_EMPTY, capacity());
+        m_overflow = new uint8_t[groups]();
+        m_slots = (value_type*)::operator new(capacity() * sizeof(value_type));
+    }
+
+    void m_free()
+    {
+        for (size_t i = 0; i < capacity(); i++) {
+            if (m_ctrl[i] != SWISS_EMPTY)
+                m_slots[i].~value_type();
+        }
+        free(m_ctrl);
+        delete [] m_overflow;
+        ::operator delete(m_slots);
+    }
+
+    size_t m_home(uint64_t hash) const
+    {
+        return (hash >> 7) & (m_groups - 1);
+    }
+
+    static int8_t m_tag(uint64_t hash)
+    {
+        return hash & 0x7f;
+    }
+
+    unsigned int m_match(size_t g, int8_t tag) const
+    {
+        __m128i ctrl = _mm_load_si128((const __m128i*)(m_ctrl + g * SWISS_GROUP));
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(tag)));
+    }
+
+    // empty slots are the ones with the top bit set
+    unsigned int m_empty(size_t g) const
+    {
+        __m128i ctrl = _mm_load_si128((const __m128i*)(m_ctrl + g * SWISS_GROUP));
+        return _mm_movemask_epi8(ctrl);
+    }
+
+    ptrdiff_t m_find(const Key & key, uint64_t hash) const
+    {
+        int8_t tag = m_tag(hash);
+        size_t g = m_home(hash);
+        for (size_t step = 1; step <= m_groups; step++) {
+            for (unsigned int m = m_match(g, tag); m; m &= m - 1) {
+                size_t slot = g * SWISS_GROUP + __builtin_ctz(m);
+                if (m_equal(m_slots[slot].first, key))
+                    return slot;
+            }
+            if (m_overflow[g] == 0)
+                return -1;
+            g = (g + step) & (m_groups - 1);
+        }
+        return -1;
+    }
+
+    // a free slot for hash, counting it on every full group it passes
+    size_t m_place(uint64_t hash)
+    {
+        size_t g = m_home(hash);
+        for (size_t step = 1; ; step++) {
+            unsigned int m = m_empty(g);
+            if (m) {
+                size_t slot = g * SWISS_GROUP + __builtin_ctz(m);
+                m_ctrl[slot] = m_tag(hash);
+                return slot;
+            }
+            if (m_overflow[g] != 255)
+                m_overflow[g]++;
+            g = (g + step) & (m_groups - 1);
+        }
+    }
+
+    void m_rehash(size_t groups)
+    {
+        int8_t* ctrl = m_ctrl;
+        uint8_t* overflow = m_overflow;
+        value_type* slots = m_slots;
+        size_t oldCapacity = capacity();
+        m_alloc(groups);
+        for (size_t i = 0; i < oldCapacity; i++) {
+            if (ctrl[i] == SWISS_EMPTY)
+                continue;
+            size_t slot = m_place(m_hash(slots[i].first));
+            new (&m_slots[slot]) value_type(std::move(slots[i]));
+            slots[i].~value_type();
+        }
+        free(ctrl);
+        delete [] overflow;
+        ::operator delete(slots);
+    }
+
+    int8_t* m_ctrl;
+    uint8_t* m_overflow;
+    value_type* m_slots;
+    size_t m_groups;
+    size_t m_size;
+    // keys erase() could not take off a count stuck at 255
+    size_t m_stale;
+    Hash m_hash;
+    Equal m_equal;
+};
+
+#endif // __SWISS_MAP_H__
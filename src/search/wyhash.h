@@ -0,0 +1,109 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+//
+// wyhash: a 64 x 64 -> 128 bit multiply folded back to 64 bits does the
+// mixing, reading 16 bytes per round for short keys and 48 for long ones.
+
+#ifndef __WYHASH_H__
+#define __WYHASH_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <type_traits>
+
+static const uint64_t wyhash_secret[4] = {
+    0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL,
+    0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL
+};
+
+static inline uint64_t wymix(uint64_t a, uint64_t b)
+{
+    __uint128_t r = (__uint128_t)a * b;
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+}
+
+static inline uint64_t wyread8(const uint8_t* p)
+{
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline uint64_t wyread4(const uint8_t* p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline uint64_t wyhash(const void* key, size_t len, uint64_t seed)
+{
+    const uint8_t* p = (const uint8_t*)key;
+    const uint64_t* s = wyhash_secret;
+    uint64_t a, b;
+    seed ^= wymix(seed ^ s[0], s[1]);
+    if (len <= 16) {
+        if (len >= 4) {
+            // two overlapping reads from each end cover 4..16 bytes
+            size_t mid = (len >> 3) << 2;
+            a = wyread4(p) << 32 | wyread4(p + mid);
+            b = wyread4(p + len - 4) << 32 | wyread4(p + len - 4 - mid);
+        } else if (len > 0) {
+            a = (uint64_t)p[0] << 16 | (uint64_t)p[len >> 1] << 8 | p[len - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+        if (i > 48) {
+            uint64_t seed1 = seed, seed2 = seed;
+            do {
+                seed = wymix(wyread8(p) ^ s[1], wyread8(p + 8) ^ seed);
+                seed1 = wymix(wyread8(p + 16) ^ s[2], wyread8(p + 24) ^ seed1);
+                seed2 = wymix(wyread8(p + 32) ^ s[3], wyread8(p + 40) ^ seed2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= seed1 ^ seed2;
+        }
+        while (i > 16) {
+            seed = wymix(wyread8(p) ^ s[1], wyread8(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        a = wyread8(p + i - 16);
+        b = wyread8(p + i - 8);
+    }
+    a ^= s[1];
+    b ^= seed;
+    __uint128_t r = (__uint128_t)a * b;
+    a = (uint64_t)r;
+    b = (uint64_t)(r >> 64);
+    return wymix(a ^ s[0] ^ len, b ^ s[1]);
+}
+
+// hash functor for strings and integers
+template <typename T, typename Enable = void>
+struct wy_hash;
+
+template <>
+struct wy_hash<std::string>
+{
+    uint64_t operator()(const std::string & key) const
+    {
+        return wyhash(key.data(), key.size(), 0);
+    }
+};
+
+template <typename T>
+struct wy_hash<T, typename std::enable_if<std::is_integral<T>::value>::type>
+{
+    uint64_t operator()(T key) const
+    {
+        return wymix((uint64_t)key ^ wyhash_secret[0], wyhash_secret[1]);
+    }
+};
+
+#endif // __WYHASH_H__
@@ -0,0 +1,121 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <vector>
+
+typedef std::vector<int> IntList;
+
+enum Distribution {
+    DIST_RANDOM = 0,
+    DIST_SORTED,
+    DIST_REVERSE,
+    DIST_ORGAN_PIPE,
+    DIST_LOW_CARDINALITY,
+    DIST_COUNT
+};
+
+static const char* const dist_name[DIST_COUNT] = {"random", "sorted",
+                                                  "reverse", "organ-pipe",
+                                                  "low-card"};
+
+static inline double now_sec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// xorshift, so the inputs are the same on every run and cheap to make
+static inline unsigned int bench_rand()
+{
+    static unsigned int state = 2463534242U;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static inline void fill_list(IntList & list, int size, Distribution dist)
+{
+    list.resize(size);
+    for (int i = 0; i < size; i++) {
+        switch (dist) {
+        case DIST_RANDOM:
+            list[i] = (int)bench_rand();
+            break;
+        case DIST_SORTED:
+            list[i] = i;
+            break;
+        case DIST_REVERSE:
+            list[i] = size - i;
+            break;
+        case DIST_ORGAN_PIPE:
+            list[i] = i < size / 2 ? i : size - i;
+            break;
+        default:
+            list[i] = bench_rand() % 16;
+            break;
+        }
+    }
+}
+
+static inline int bench_size(int argc, char* argv[], int def)
+{
+    return argc > 1 ? atoi(argv[1]) : def;
+}
+
+// hardware counter through perf_event_open(2); value() is -1 when the kernel
+// or the sandbox does not allow it
+class PerfCounter
+{
+public:
+    explicit PerfCounter(unsigned long long config)
+    {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        m_fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+    ~PerfCounter()
+    {
+        if (m_fd >= 0)
+            close(m_fd);
+    }
+
+    void start()
+    {
+        if (m_fd < 0)
+            return;
+        ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    long long stop()
+    {
+        long long count = -1;
+        if (m_fd < 0)
+            return count;
+        ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(m_fd, &count, sizeof(count)) != sizeof(count))
+            count = -1;
+        return count;
+    }
+
+private:
+    int m_fd;
+};
+
+#endif // __BENCH_H__
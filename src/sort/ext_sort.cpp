@@ -0,0 +1,419 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+//
+// External merge sort for binary files of native-endian 32-bit ints that do
+// not fit in memory:
+//
+//   ext_sort [-m MB] [-t TMPDIR] [-r] INPUT OUTPUT
+//   ext_sort -g COUNT FILE     write COUNT random ints to FILE
+//   ext_sort [-r] -c FILE      check that FILE is sorted
+//
+// Runs of budget / 2 bytes are read with large sequential reads, sorted by
+// radix_sort() (which needs the same size again as scratch) and spilled to
+// unlinked temp files. The runs are then merged through a loser tree, each
+// run read through its own share of the budget, in as many passes as the
+// fan-in allows.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <vector>
+#include <string>
+
+#include "radix_sort.h"
+#include "bench.h"
+
+// smallest read buffer a run gets during a merge
+#define MIN_MERGE_BUF   (1 << 20)
+
+static bool descending = false;
+
+struct descending_key {
+    unsigned int operator()(int value) const { return radix_key(value); }
+};
+
+static inline bool before(int a, int b)
+{
+    return descending ? a > b : a < b;
+}
+
+static bool read_full(int fd, void* buf, size_t size, size_t & got)
+{
+    char* p = (char*)buf;
+    got = 0;
+    while (got < size) {
+        ssize_t n = read(fd, p + got, size - got);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0) {
+            perror("read");
+            return false;
+        }
+        if (n == 0)
+            break;
+        got += n;
+    }
+    return true;
+}
+
+static bool write_full(int fd, const void* buf, size_t size)
+{
+    const char* p = (const char*)buf;
+    while (size > 0) {
+        ssize_t n = write(fd, p, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0) {
+            perror("write");
+            return false;
+        }
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+// an unlinked temp file, gone as soon as it is closed
+static int temp_file(const std::string & dir)
+{
+    std::string path = dir + "/ext_sort.XXXXXX";
+    std::vector<char> name(path.begin(), path.end());
+    name.push_back('\0');
+    int fd = mkstemp(&name[0]);
+    if (fd < 0) {
+        perror("mkstemp");
+        return -1;
+    }
+    unlink(&name[0]);
+    return fd;
+}
+
+class RunReader
+{
+public:
+    RunReader(int fd, size_t bufSize)
+      : m_fd(fd),
+        m_buf(bufSize / sizeof(int)),
+        m_pos(0),
+        m_len(0)
+    {
+        lseek(m_fd, 0, SEEK_SET);
+        posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+
+    // false at the end of the run or on error
+    bool next(int & value)
+    {
+        if (m_pos == m_len) {
+            size_t got;
+            if (!read_full(m_fd, &m_buf[0], m_buf.size() * sizeof(int), got))
+                return false;
+            m_len = got / sizeof(int);
+            m_pos = 0;
+            if (m_len == 0)
+                return false;
+        }
+        value = m_buf[m_pos++];
+        return true;
+    }
+
+private:
+    int m_fd;
+    IntList m_buf;
+    size_t m_pos;
+    size_t m_len;
+};
+
+class RunWriter
+{
+public:
+    RunWriter(int fd, size_t bufSize)
+      : m_fd(fd),
+        m_buf(bufSize / sizeof(int)),
+        m_len(0),
+        m_ok(true)
+    {
+    }
+
+    void put(int value)
+    {
+        m_buf[m_len++] = value;
+        if (m_len == m_buf.size())
+            flush();
+    }
+
+    bool flush()
+    {
+        if (m_ok && m_len)
+            m_ok = write_full(m_fd, &m_buf[0], m_len * sizeof(int));
+        m_len = 0;
+        return m_ok;
+    }
+
+private:
+    int m_fd;
+    IntList m_buf;
+    size_t m_len;
+    bool m_ok;
+};
+
+// Loser tree over k runs: m_tree[0] is the run holding the next value, the
+// inner nodes the loser of the game played there, so replacing the winner
+// costs log2(k) comparisons against a single path.
+class LoserTree
+{
+public:
+    explicit LoserTree(std::vector<RunReader*> & runs)
+      : m_runs(runs),
+        m_k(runs.size()),
+        m_key(m_k),
+        m_done(m_k),
+        m_tree(m_k > 1 ? m_k : 1, m_k)
+    {
+        for (int i = 0; i < m_k; i++)
+            m_done[i] = !m_runs[i]->next(m_key[i]);
+        // m_k is a virtual run that wins every game until it is replaced
+        for (int i = m_k - 1; i >= 0; i--)
+            m_adjust(i);
+    }
+
+    bool pop(int & value)
+    {
+        int s = m_tree[0];
+        if (m_done[s])
+            return false;
+        value = m_key[s];
+        m_done[s] = !m_runs[s]->next(m_key[s]);
+        m_adjust(s);
+        return true;
+    }
+
+private:
+    bool m_beats(int a, int b) const
+    {
+        if (a == m_k || b == m_k)
+            return a == m_k;
+        if (m_done[a] || m_done[b])
+            return m_done[b] && !m_done[a];
+        return before(m_key[a], m_key[b]);
+    }
+
+    void m_adjust(int s)
+    {
+        for (int t = (s + m_k) / 2; t > 0; t /= 2) {
+            if (m_beats(m_tree[t], s))
+                std::swap(s, m_tree[t]);
+        }
+        m_tree[0] = s;
+    }
+
+    std::vector<RunReader*> & m_runs;
+    int m_k;
+    IntList m_key;
+    std::vector<char> m_done;
+    IntList m_tree;
+};
+
+static bool merge_runs(std::vector<int> & fds, int out, size_t budget)
+{
+    size_t bufSize = budget / (fds.size() + 1);
+    std::vector<RunReader*> runs;
+    for (size_t i = 0; i < fds.size(); i++)
+        runs.push_back(new RunReader(fds[i], bufSize));
+    RunWriter writer(out, bufSize);
+    LoserTree tree(runs);
+    int value;
+    while (tree.pop(value))
+        writer.put(value);
+    for (size_t i = 0; i < runs.size(); i++)
+        delete runs[i];
+    return writer.flush();
+}
+
+static int sort_file(const char* input, const char* output, size_t budget,
+                     const std::string & tmpDir)
+{
+    int in = open(input, O_RDONLY);
+    if (in < 0) {
+        perror(input);
+        return 1;
+    }
+    posix_fadvise(in, 0, 0, POSIX_FADV_SEQUENTIAL);
+    int out = open(output, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0) {
+        perror(output);
+        close(in);
+        return 1;
+    }
+
+    double start = now_sec();
+    size_t total = 0;
+    std::vector<int> runs;
+    size_t runCount = 0;
+    IntList run(budget / 2 / sizeof(int));
+    for (;;) {
+        size_t got;
+        if (!read_full(in, &run[0], run.size() * sizeof(int), got))
+            return 1;
+        // only the last read can come up short, by any leftover bytes
+        if (got % sizeof(int) != 0) {
+            fprintf(stderr, "%s: size is not a multiple of %zu bytes\n",
+                    input, sizeof(int));
+            return 1;
+        }
+        size_t count = got / sizeof(int);
+        if (count == 0)
+            break;
+        total += count * sizeof(int);
+        runCount++;
+        if (descending)
+            radix_sort(run.begin(), run.begin() + count, descending_key());
+        else
+            radix_sort(run.begin(), run.begin() + count);
+        // a single run is already the answer
+        if (runs.empty() && count < run.size()) {
+            if (!write_full(out, &run[0], count * sizeof(int)))
+                return 1;
+            break;
+        }
+        int fd = temp_file(tmpDir);
+        if (fd < 0 || !write_full(fd, &run[0], count * sizeof(int)))
+            return 1;
+        runs.push_back(fd);
+        if (count < run.size())
+            break;
+    }
+    close(in);
+    IntList().swap(run);
+    double runTime = now_sec() - start;
+    printf("runs: %zu, %.1f MB in %.2fs, %.1f MB/s\n", runCount,
+           total / 1e6, runTime, total / 1e6 / runTime);
+
+    // merge passes until the remaining runs fit in one final merge
+    size_t fanIn = std::max<size_t>(2, budget / MIN_MERGE_BUF - 1);
+    start = now_sec();
+    int passes = 0;
+    while (runs.size() > fanIn) {
+        std::vector<int> merged;
+        for (size_t i = 0; i < runs.size(); i += fanIn) {
+            std::vector<int> group(runs.begin() + i,
+                                   runs.begin() + std::min(runs.size(), i + fanIn));
+            int fd = temp_file(tmpDir);
+            if (fd < 0 || !merge_runs(group, fd, budget))
+                return 1;
+            for (size_t j = 0; j < group.size(); j++)
+                close(group[j]);
+            merged.push_back(fd);
+        }
+        runs.swap(merged);
+        passes++;
+    }
+    if (runs.size() > 0) {
+        if (!merge_runs(runs, out, budget))
+            return 1;
+        passes++;
+    }
+    for (size_t i = 0; i < runs.size(); i++)
+        close(runs[i]);
+    if (close(out) < 0) {
+        perror(output);
+        return 1;
+    }
+    double mergeTime = now_sec() - start;
+    if (passes)
+        printf("merge: %d pass(es), %.2fs, %.1f MB/s\n", passes, mergeTime,
+               total / 1e6 * passes / mergeTime);
+    printf("total: %.2fs, %.1f MB/s\n", runTime + mergeTime,
+           total / 1e6 / (runTime + mergeTime));
+    return 0;
+}
+
+static int generate_file(const char* path, long count)
+{
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror(path);
+        return 1;
+    }
+    RunWriter writer(fd, 1 << 20);
+    for (long i = 0; i < count; i++)
+        writer.put((int)bench_rand());
+    bool ok = writer.flush();
+    close(fd);
+    return ok ? 0 : 1;
+}
+
+static int check_file(const char* path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return 1;
+    }
+    RunReader reader(fd, 1 << 20);
+    long count = 0;
+    int prev = 0, value;
+    while (reader.next(value)) {
+        if (count && before(value, prev)) {
+            printf("ERROR: %s is not sorted at %ld\n", path, count);
+            close(fd);
+            return 1;
+        }
+        prev = value;
+        count++;
+    }
+    close(fd);
+    printf("%s: %ld ints sorted\n", path, count);
+    return 0;
+}
+
+static void usage(const char* name)
+{
+    printf("Usage: %s [-m MB] [-t TMPDIR] [-r] INPUT OUTPUT\n"
+           "       %s -g COUNT FILE\n"
+           "       %s [-r] -c FILE\n", name, name, name);
+}
+
+int main(int argc, char* argv[])
+{
+    size_t budget = 256UL << 20;
+    const char* tmp = getenv("TMPDIR");
+    std::string tmpDir = tmp ? tmp : "/tmp";
+    long generate = -1;
+    bool check = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "m:t:g:rch")) != -1) {
+        switch (opt) {
+        case 'm':
+            budget = strtoul(optarg, NULL, 10) << 20;
+            break;
+        case 't':
+            tmpDir = optarg;
+            break;
+        case 'g':
+            generate = atol(optarg);
+            break;
+        case 'r':
+            descending = true;
+            break;
+        case 'c':
+            check = true;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (generate >= 0 && optind + 1 == argc)
+        return generate_file(argv[optind], generate);
+    if (check && optind + 1 == argc)
+        return check_file(argv[optind]);
+    if (optind + 2 != argc || budget < 4 * MIN_MERGE_BUF) {
+        usage(argv[0]);
+        return 1;
+    }
+    return sort_file(argv[optind], argv[optind + 1], budget, tmpDir);
+}
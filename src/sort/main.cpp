@@ -0,0 +1,26 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "radix_sort.h"
+
+int main(int argc, char* argv[])
+{
+    IntList numList;
+    for (int i = 0; i < 1024; i++) {
+        numList.push_back(rand() % 1000);
+    }
+    printf("DEBUG: ");
+    for (size_t i = 0; i < numList.size(); i++) {
+        printf("%d\t", numList[i]);
+    }
+    printf("\n\n");
+    radix_sort(numList, 0, numList.size() - 1);
+    printf("\nSORT: ");
+    for (size_t i = 0; i < numList.size(); i++) {
+        printf("%d\t", numList[i]);
+    }
+    printf("\n");
+    return 0;
+}
@@ -0,0 +1,119 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <functional>
+
+#include "merge_sort.h"
+#include "bench.h"
+
+// an int key with the position it started at, to check stability
+struct Record {
+    int key;
+    int pos;
+};
+
+struct record_less {
+    bool operator()(const Record & a, const Record & b) const
+    {
+        return a.key < b.key;
+    }
+};
+
+enum Input {
+    INPUT_RANDOM = 0,
+    INPUT_NEARLY_SORTED,
+    INPUT_RUNS,
+    INPUT_SORTED,
+    INPUT_REVERSE,
+    INPUT_LOW_CARDINALITY,
+    INPUT_COUNT
+};
+
+static const char* inputName[INPUT_COUNT] = {"random", "nearly-sorted",
+                                             "16-runs", "sorted", "reverse",
+                                             "low-card"};
+
+static void fill_records(std::vector<Record> & list, int size, Input input)
+{
+    list.resize(size);
+    for (int i = 0; i < size; i++) {
+        switch (input) {
+        case INPUT_RANDOM:
+            list[i].key = (int)bench_rand();
+            break;
+        case INPUT_RUNS:
+            list[i].key = i % (size / 16 + 1);
+            break;
+        case INPUT_REVERSE:
+            list[i].key = size - i;
+            break;
+        case INPUT_LOW_CARDINALITY:
+            list[i].key = bench_rand() % 16;
+            break;
+        default:
+            list[i].key = i;
+            break;
+        }
+        list[i].pos = i;
+    }
+    // sorted but for 1% of the elements swapped to random places
+    if (input == INPUT_NEARLY_SORTED) {
+        for (int i = 0; i < size / 100; i++)
+            std::swap(list[bench_rand() % size].key,
+                      list[bench_rand() % size].key);
+    }
+}
+
+static bool check(const std::vector<Record> & list, const char* name)
+{
+    for (size_t i = 1; i < list.size(); i++) {
+        if (list[i].key < list[i - 1].key ||
+            (list[i].key == list[i - 1].key &&
+             list[i].pos < list[i - 1].pos)) {
+            printf("ERROR: %s is not stable sorted at %zu\n", name, i);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    int size = bench_size(argc, argv, 1000000);
+    unsigned threads = argc > 2 ? atoi(argv[2]) : 0;
+    std::vector<Record> origin;
+    std::vector<Record> list;
+    // one arena for every run below, it is only allocated on the first
+    SortArena<Record> arena;
+    printf("%d records of %zu bytes\n", size, sizeof(Record));
+    for (int in = 0; in < INPUT_COUNT; in++) {
+        fill_records(origin, size, (Input)in);
+        printf("%s\n", inputName[in]);
+
+        list = origin;
+        double start = now_sec();
+        std::stable_sort(list.begin(), list.end(), record_less());
+        printf(" std::stable_sort      %8.2fms\n", (now_sec() - start) * 1e3);
+        if (!check(list, "std::stable_sort"))
+            return 1;
+
+        list = origin;
+        start = now_sec();
+        merge_sort(list.begin(), list.end(), record_less(), arena);
+        printf(" merge_sort            %8.2fms\n", (now_sec() - start) * 1e3);
+        if (!check(list, "merge_sort"))
+            return 1;
+
+        list = origin;
+        start = now_sec();
+        parallel_merge_sort(list.begin(), list.end(), record_less(), arena,
+                            threads);
+        printf(" parallel_merge_sort   %8.2fms\n", (now_sec() - start) * 1e3);
+        if (!check(list, "parallel_merge_sort"))
+            return 1;
+    }
+    printf("arena: %zu records\n", arena.capacity());
+    return 0;
+}
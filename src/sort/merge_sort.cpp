@@ -0,0 +1,18 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#include "merge_sort.h"
+
+void merge_sort(IntList & list, int left, int right)
+{
+    if (left >= right)
+        return;
+    merge_sort(list.begin() + left, list.begin() + right + 1,
+               std::greater<int>());
+}
+
+void parallel_merge_sort(IntList & list, unsigned threads)
+{
+    SortArena<int> arena;
+    parallel_merge_sort(list.begin(), list.end(), std::greater<int>(), arena,
+                        threads);
+}
@@ -0,0 +1,410 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#ifndef __MERGE_SORT_H__
+#define __MERGE_SORT_H__
+
+#include <stddef.h>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "quick_sort.h"
+#include "task_pool.h"
+
+// runs shorter than this are extended with binary insertion sort
+#define MIN_RUN         32
+// wins in a row after which a merge switches to galloping
+#define MIN_GALLOP      7
+
+// Scratch space kept between sorts, so that sorting many ranges allocates
+// once: get() only grows the buffer. Elements left in it are moved-from.
+template <typename T>
+class SortArena
+{
+public:
+    T* get(size_t size)
+    {
+        if (m_buffer.size() < size)
+            m_buffer.resize(size);
+        return m_buffer.empty() ? NULL : &m_buffer[0];
+    }
+
+    size_t capacity() const { return m_buffer.size(); }
+
+private:
+    std::vector<T> m_buffer;
+};
+
+namespace sort_detail {
+
+// first position in [first, last) whose element comes after key, found by
+// probing 1, 3, 7, .. elements ahead and then bisecting; cheap when the
+// answer is near first, which is the common case inside a merge
+template <typename It, typename T, typename Compare>
+It gallop_upper(const T & key, It first, It last, Compare & comp)
+{
+    ptrdiff_t size = last - first;
+    ptrdiff_t lo = 0, hi = 1;
+    while (hi < size && !comp(key, first[hi - 1])) {
+        lo = hi;
+        hi = 2 * hi + 1;
+    }
+    return std::upper_bound(first + lo, first + std::min(hi, size), key, comp);
+}
+
+// first position in [first, last) whose element does not come before key
+template <typename It, typename T, typename Compare>
+It gallop_lower(const T & key, It first, It last, Compare & comp)
+{
+    ptrdiff_t size = last - first;
+    ptrdiff_t lo = 0, hi = 1;
+    while (hi < size && comp(first[hi - 1], key)) {
+        lo = hi;
+        hi = 2 * hi + 1;
+    }
+    return std::lower_bound(first + lo, first + std::min(hi, size), key, comp);
+}
+
+// the same searches from the back, for merges that run backwards
+template <typename It, typename T, typename Compare>
+It gallop_upper_back(const T & key, It first, It last, Compare & comp)
+{
+    ptrdiff_t size = last - first;
+    ptrdiff_t lo = 0, hi = 1;
+    while (hi < size && comp(key, last[-hi])) {
+        lo = hi;
+        hi = 2 * hi + 1;
+    }
+    return std::upper_bound(last - std::min(hi, size), last - lo, key, comp);
+}
+
+template <typename It, typename T, typename Compare>
+It gallop_lower_back(const T & key, It first, It last, Compare & comp)
+{
+    ptrdiff_t size = last - first;
+    ptrdiff_t lo = 0, hi = 1;
+    while (hi < size && !comp(last[-hi], key)) {
+        lo = hi;
+        hi = 2 * hi + 1;
+    }
+    return std::lower_bound(last - std::min(hi, size), last - lo, key, comp);
+}
+
+// merge [first, middle) and [middle, last) where the left run is the shorter
+// one: it is moved out to buf and merged forwards. On ties the left run
+// wins, which is what keeps the sort stable.
+template <typename RandomIt, typename T, typename Compare>
+void merge_lo(RandomIt first, RandomIt middle, RandomIt last, T* buf,
+              Compare & comp)
+{
+    T* a = buf;
+    T* aEnd = std::move(first, middle, buf);
+    RandomIt b = middle;
+    RandomIt dest = first;
+    int winsA = 0, winsB = 0;
+    while (a != aEnd && b != last) {
+        if (comp(*b, *a)) {
+            *dest++ = std::move(*b++);
+            winsA = 0;
+            if (++winsB >= MIN_GALLOP) {
+                RandomIt end = gallop_lower(*a, b, last, comp);
+                dest = std::move(b, end, dest);
+                b = end;
+                winsB = 0;
+            }
+        } else {
+            *dest++ = std::move(*a++);
+            winsB = 0;
+            if (++winsA >= MIN_GALLOP) {
+                T* end = gallop_upper(*b, a, aEnd, comp);
+                dest = std::move(a, end, dest);
+                a = end;
+                winsA = 0;
+            }
+        }
+    }
+    // what is left of the right run is already in place
+    std::move(a, aEnd, dest);
+}
+
+// the right run is the shorter one: move it out and merge backwards
+template <typename RandomIt, typename T, typename Compare>
+void merge_hi(RandomIt first, RandomIt middle, RandomIt last, T* buf,
+              Compare & comp)
+{
+    T* bBegin = buf;
+    T* b = std::move(middle, last, buf);
+    RandomIt a = middle;
+    RandomIt dest = last;
+    int winsA = 0, winsB = 0;
+    while (a != first && b != bBegin) {
+        if (comp(*(b - 1), *(a - 1))) {
+            *--dest = std::move(*--a);
+            winsB = 0;
+            if (++winsA >= MIN_GALLOP) {
+                RandomIt begin = gallop_upper_back(*(b - 1), first, a, comp);
+                dest = std::move_backward(begin, a, dest);
+                a = begin;
+                winsA = 0;
+            }
+        } else {
+            *--dest = std::move(*--b);
+            winsA = 0;
+            if (++winsB >= MIN_GALLOP) {
+                T* begin = gallop_lower_back(*(a - 1), bBegin, b, comp);
+                dest = std::move_backward(begin, b, dest);
+                b = begin;
+                winsB = 0;
+            }
+        }
+    }
+    std::move_backward(bBegin, b, dest);
+}
+
+// merge two adjacent sorted runs using at most min(left, right) of buf
+template <typename RandomIt, typename T, typename Compare>
+void merge_runs(RandomIt first, RandomIt middle, RandomIt last, T* buf,
+                Compare & comp)
+{
+    if (first == middle || middle == last || !comp(*middle, *(middle - 1)))
+        return;
+    // the head of the left run that is before all of the right run and the
+    // tail of the right run that is after all of the left one stay put
+    first = gallop_upper(*middle, first, middle, comp);
+    last = gallop_lower(*(middle - 1), middle, last, comp);
+    if (middle - first <= last - middle)
+        merge_lo(first, middle, last, buf, comp);
+    else
+        merge_hi(first, middle, last, buf, comp);
+}
+
+template <typename RandomIt, typename Compare>
+void binary_insertion_sort(RandomIt first, RandomIt sorted, RandomIt last,
+                           Compare & comp)
+{
+    typedef typename std::iterator_traits<RandomIt>::value_type T;
+    for (RandomIt i = sorted; i != last; ++i) {
+        RandomIt pos = std::upper_bound(first, i, *i, comp);
+        if (pos == i)
+            continue;
+        T value = std::move(*i);
+        std::move_backward(pos, i, i + 1);
+        *pos = std::move(value);
+    }
+}
+
+// the natural run starting at first, reversed if it is strictly descending
+// and extended to at least MIN_RUN elements; returns where it ends
+template <typename RandomIt, typename Compare>
+RandomIt next_run(RandomIt first, RandomIt last, Compare & comp)
+{
+    RandomIt end = first + 1;
+    if (end == last)
+        return end;
+    if (comp(*end, *first)) {
+        // strictly, so that reversing cannot reorder equal elements
+        while (end != last && comp(*end, *(end - 1)))
+            ++end;
+        std::reverse(first, end);
+    } else {
+        while (end != last && !comp(*end, *(end - 1)))
+            ++end;
+    }
+    if (end - first < MIN_RUN) {
+        RandomIt stop = last - first < MIN_RUN ? last : first + MIN_RUN;
+        binary_insertion_sort(first, end, stop, comp);
+        end = stop;
+    }
+    return end;
+}
+
+// Timsort-like: split into natural runs, then merge neighbouring runs in
+// passes until one is left
+template <typename RandomIt, typename T, typename Compare>
+void merge_sort(RandomIt first, RandomIt last, T* buf, Compare & comp)
+{
+    std::vector<RandomIt> bounds;
+    bounds.push_back(first);
+    for (RandomIt begin = first; begin != last; ) {
+        begin = next_run(begin, last, comp);
+        bounds.push_back(begin);
+    }
+    while (bounds.size() > 2) {
+        size_t out = 1;
+        size_t i = 0;
+        for (; i + 2 < bounds.size(); i += 2) {
+            merge_runs(bounds[i], bounds[i + 1], bounds[i + 2], buf, comp);
+            bounds[out++] = bounds[i + 2];
+        }
+        if (i + 1 < bounds.size())
+            bounds[out++] = bounds[i + 1];
+        bounds.resize(out);
+    }
+}
+
+// merge path: how many of the first k merged elements come from a, given
+// that ties go to a
+template <typename ItA, typename ItB, typename Compare>
+ptrdiff_t co_rank(ptrdiff_t k, ItA a, ptrdiff_t la, ItB b, ptrdiff_t lb,
+                  Compare & comp)
+{
+    ptrdiff_t lo = std::max<ptrdiff_t>(0, k - lb);
+    ptrdiff_t hi = std::min(k, la);
+    while (lo < hi) {
+        ptrdiff_t i = lo + (hi - lo) / 2;
+        ptrdiff_t j = k - i;
+        // a[i] is taken before b[j - 1] unless b[j - 1] comes first
+        if (j > 0 && i < la && !comp(b[j - 1], a[i]))
+            lo = i + 1;
+        else
+            hi = i;
+    }
+    return lo;
+}
+
+template <typename ItA, typename ItB, typename OutIt, typename Compare>
+void merge_into(ItA a, ItA aEnd, ItB b, ItB bEnd, OutIt out, Compare & comp)
+{
+    while (a != aEnd && b != bEnd) {
+        if (comp(*b, *a))
+            *out++ = std::move(*b++);
+        else
+            *out++ = std::move(*a++);
+    }
+    out = std::move(a, aEnd, out);
+    std::move(b, bEnd, out);
+}
+
+// merge src[lo, mid) and src[mid, hi) into dst[lo, hi) as parts tasks, each
+// starting where the merge path crosses its share of the output
+template <typename SrcIt, typename DstIt, typename Compare>
+void parallel_merge(TaskPool & pool, SrcIt src, DstIt dst, ptrdiff_t lo,
+                    ptrdiff_t mid, ptrdiff_t hi, int parts, Compare comp)
+{
+    ptrdiff_t la = mid - lo, lb = hi - mid;
+    ptrdiff_t total = la + lb;
+    for (int p = 0; p < parts; p++) {
+        ptrdiff_t k0 = total * p / parts;
+        ptrdiff_t k1 = total * (p + 1) / parts;
+        pool.submit([=]() mutable {
+            ptrdiff_t i0 = co_rank(k0, src + lo, la, src + mid, lb, comp);
+            ptrdiff_t i1 = co_rank(k1, src + lo, la, src + mid, lb, comp);
+            merge_into(src + lo + i0, src + lo + i1,
+                       src + mid + (k0 - i0), src + mid + (k1 - i1),
+                       dst + lo + k0, comp);
+        });
+    }
+}
+
+} // namespace sort_detail
+
+// Stable sort of [first, last): natural runs, galloping merges, and never
+// more than (last - first) / 2 elements of scratch, taken from arena.
+template <typename RandomIt, typename Compare>
+void merge_sort(RandomIt first, RandomIt last, Compare comp,
+                SortArena<typename std::iterator_traits<RandomIt>::value_type>
+                    & arena)
+{
+    if (last - first < 2)
+        return;
+    sort_detail::merge_sort(first, last, arena.get((last - first) / 2 + 1),
+                            comp);
+}
+
+template <typename RandomIt, typename Compare>
+void merge_sort(RandomIt first, RandomIt last, Compare comp)
+{
+    SortArena<typename std::iterator_traits<RandomIt>::value_type> arena;
+    merge_sort(first, last, comp, arena);
+}
+
+template <typename RandomIt>
+void merge_sort(RandomIt first, RandomIt last)
+{
+    typedef typename std::iterator_traits<RandomIt>::value_type T;
+    merge_sort(first, last, std::less<T>());
+}
+
+// Stable sort on threads: every thread merge-sorts one chunk in its own part
+// of the arena, then the chunks are merged pairwise between the input and
+// the arena, each merge split by merge path so all threads take part. This
+// one needs last - first elements of scratch.
+template <typename RandomIt, typename Compare>
+void parallel_merge_sort(RandomIt first, RandomIt last, Compare comp,
+                         SortArena<typename std::iterator_traits<RandomIt>::value_type>
+                             & arena, unsigned threads)
+{
+    ptrdiff_t size = last - first;
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if (threads <= 1 || size < 4 * MIN_RUN * (ptrdiff_t)threads) {
+        merge_sort(first, last, comp, arena);
+        return;
+    }
+    typedef typename std::iterator_traits<RandomIt>::value_type T;
+    T* buf = arena.get(size);
+    TaskPool pool(threads);
+
+    std::vector<ptrdiff_t> bounds;
+    for (unsigned t = 0; t <= threads; t++)
+        bounds.push_back(size * t / threads);
+    for (unsigned t = 0; t < threads; t++) {
+        ptrdiff_t lo = bounds[t], hi = bounds[t + 1];
+        pool.submit([=]() mutable {
+            sort_detail::merge_sort(first + lo, first + hi, buf + lo, comp);
+        });
+    }
+    pool.wait();
+
+    bool inBuf = false;
+    while (bounds.size() > 2) {
+        size_t pairs = (bounds.size() - 1) / 2;
+        int parts = std::max<int>(1, threads / pairs);
+        std::vector<ptrdiff_t> merged;
+        size_t i = 0;
+        for (; i + 2 < bounds.size(); i += 2) {
+            merged.push_back(bounds[i]);
+            if (inBuf)
+                sort_detail::parallel_merge(pool, buf, first, bounds[i],
+                                            bounds[i + 1], bounds[i + 2],
+                                            parts, comp);
+            else
+                sort_detail::parallel_merge(pool, first, buf, bounds[i],
+                                            bounds[i + 1], bounds[i + 2],
+                                            parts, comp);
+        }
+        // an odd run out just changes sides
+        if (i + 1 < bounds.size()) {
+            ptrdiff_t lo = bounds[i], hi = bounds[i + 1];
+            merged.push_back(lo);
+            pool.submit([=]() {
+                if (inBuf)
+                    std::move(buf + lo, buf + hi, first + lo);
+                else
+                    std::move(first + lo, first + hi, buf + lo);
+            });
+        }
+        merged.push_back(size);
+        pool.wait();
+        bounds.swap(merged);
+        inBuf = !inBuf;
+    }
+    if (inBuf) {
+        for (unsigned t = 0; t < threads; t++) {
+            ptrdiff_t lo = size * t / threads, hi = size * (t + 1) / threads;
+            pool.submit([=]() {
+                std::move(buf + lo, buf + hi, first + lo);
+            });
+        }
+        pool.wait();
+    }
+}
+
+// sort list[left..right] in descending order, keeping equal elements in
+// their original order
+void merge_sort(IntList & list, int left, int right);
+void parallel_merge_sort(IntList & list, unsigned threads);
+
+#endif // __MERGE_SORT_H__
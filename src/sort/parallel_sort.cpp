@@ -0,0 +1,118 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#include <string.h>
+#include <algorithm>
+
+#include "parallel_sort.h"
+#include "radix_sort.h"
+#include "task_pool.h"
+
+static unsigned thread_count(unsigned threads)
+{
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    return threads ? threads : 1;
+}
+
+static void quick_sort_task(TaskPool & pool, IntList & list, int left,
+                            int right)
+{
+    // split off the smaller side as a task for whoever is idle and keep
+    // partitioning the larger one
+    while (right - left + 1 > PARALLEL_GRAIN) {
+        int lt, gt;
+        partition(list, left, right, lt, gt);
+        if (lt - left < right - gt) {
+            int l = left, r = lt - 1;
+            pool.submit([&pool, &list, l, r] {
+                quick_sort_task(pool, list, l, r);
+            });
+            left = gt + 1;
+        } else {
+            int l = gt + 1, r = right;
+            pool.submit([&pool, &list, l, r] {
+                quick_sort_task(pool, list, l, r);
+            });
+            right = lt - 1;
+        }
+    }
+    quick_sort(list, left, right);
+}
+
+void parallel_quick_sort(IntList & list, unsigned threads)
+{
+    int size = list.size();
+    threads = thread_count(threads);
+    if (threads == 1 || size <= PARALLEL_GRAIN) {
+        quick_sort(list, 0, size - 1);
+        return;
+    }
+    TaskPool pool(threads);
+    pool.submit([&pool, &list, size] {
+        quick_sort_task(pool, list, 0, size - 1);
+    });
+    pool.wait();
+}
+
+void parallel_radix_sort(IntList & list, unsigned threads)
+{
+    int size = list.size();
+    threads = thread_count(threads);
+    if (threads == 1 || size <= PARALLEL_GRAIN) {
+        radix_sort(list, 0, size - 1);
+        return;
+    }
+    const int shift = 32 - RADIX_BITS;
+    int chunk = (size + threads - 1) / threads;
+    // count[t][digit] is first the histogram of chunk t, then the place
+    // chunk t writes its first element with that top digit to
+    std::vector<std::vector<int> > count(threads, std::vector<int>(RADIX_SIZE));
+    IntList scratch(size);
+    TaskPool pool(threads);
+
+    for (unsigned t = 0; t < threads; t++) {
+        pool.submit([&, t] {
+            int begin = std::min(size, (int)t * chunk);
+            int end = std::min(size, begin + chunk);
+            for (int i = begin; i < end; i++)
+                count[t][radix_key(list[i]) >> shift]++;
+        });
+    }
+    pool.wait();
+
+    int bucket[RADIX_SIZE + 1];
+    int offset = 0;
+    for (int digit = 0; digit < RADIX_SIZE; digit++) {
+        bucket[digit] = offset;
+        for (unsigned t = 0; t < threads; t++) {
+            int n = count[t][digit];
+            count[t][digit] = offset;
+            offset += n;
+        }
+    }
+    bucket[RADIX_SIZE] = size;
+
+    for (unsigned t = 0; t < threads; t++) {
+        pool.submit([&, t] {
+            int begin = std::min(size, (int)t * chunk);
+            int end = std::min(size, begin + chunk);
+            for (int i = begin; i < end; i++)
+                scratch[count[t][radix_key(list[i]) >> shift]++] = list[i];
+        });
+    }
+    pool.wait();
+
+    // the buckets are independent now; radix_sort() skips the top digit
+    // since it is the same for the whole bucket
+    for (int digit = 0; digit < RADIX_SIZE; digit++) {
+        int left = bucket[digit], right = bucket[digit + 1] - 1;
+        if (left > right)
+            continue;
+        pool.submit([&, left, right] {
+            radix_sort(scratch, left, right);
+            memcpy(&list[left], &scratch[left],
+                   (right - left + 1) * sizeof(int));
+        });
+    }
+    pool.wait();
+}
@@ -0,0 +1,17 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#ifndef __PARALLEL_SORT_H__
+#define __PARALLEL_SORT_H__
+
+#include "quick_sort.h"
+
+// ranges at most this long are handed to the sequential sorts
+#define PARALLEL_GRAIN  (1 << 16)
+
+// sort list in descending order on a work-stealing pool of threads, 0 means
+// one per hardware thread
+void parallel_quick_sort(IntList & list, unsigned threads);
+// MSD radix on the top digit in parallel, then radix_sort() per bucket
+void parallel_radix_sort(IntList & list, unsigned threads);
+
+#endif // __PARALLEL_SORT_H__
@@ -0,0 +1,63 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <functional>
+
+#include "quick_sort.h"
+#include "bench.h"
+
+static void report(const char* name, int size, double sec, long long misses)
+{
+    if (misses < 0)
+        printf("  %-18s %8.2f ns/elem  branch-misses n/a\n", name,
+               sec * 1e9 / size);
+    else
+        printf("  %-18s %8.2f ns/elem  %6.3f branch-misses/elem\n", name,
+               sec * 1e9 / size, (double)misses / size);
+}
+
+int main(int argc, char* argv[])
+{
+    int maxSize = bench_size(argc, argv, 100000000);
+    PerfCounter misses(PERF_COUNT_HW_BRANCH_MISSES);
+    IntList origin;
+    IntList list;
+    for (int size = 1000000; size <= maxSize; size *= 10) {
+        fill_list(origin, size, DIST_RANDOM);
+        printf("%d random ints\n", size);
+
+        // a single top level pass of each kernel
+        int lt, gt;
+        list = origin;
+        misses.start();
+        double start = now_sec();
+        partition(list, 0, size - 1, lt, gt);
+        report("partition", size, now_sec() - start, misses.stop());
+
+        list = origin;
+        misses.start();
+        start = now_sec();
+        block_partition(list, 0, size - 1);
+        report("block_partition", size, now_sec() - start, misses.stop());
+
+        // and the whole sort built on it
+        list = origin;
+        misses.start();
+        start = now_sec();
+        quick_sort(list, 0, size - 1);
+        report("quick_sort", size, now_sec() - start, misses.stop());
+
+        list = origin;
+        misses.start();
+        start = now_sec();
+        block_quick_sort(list, 0, size - 1);
+        report("block_quick_sort", size, now_sec() - start, misses.stop());
+        if (!std::is_sorted(list.begin(), list.end(), std::greater<int>())) {
+            printf("ERROR: block_quick_sort result is not sorted\n");
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -5,26 +5,53 @@
 
 #include "quick_sort.h"
 
-static int partition(IntList & list, int left, int right)
+void quick_sort(IntList & list, int left, int right)
 {
-    int index = left;
-    int pivot = list[index];
-    // put pivot to the end
-    std::swap(list[index], list[right]);
-    for (int i = left; i < right; i++) {
-        if (list[i] >= pivot) 
-            std::swap(list[index++], list[i]);
-    }
-    // get pivot back
-    std::swap(list[right], list[index]);
-    return index;
+    if (left >= right)
+        return;
+    quick_sort(list.begin() + left, list.begin() + right + 1,
+               std::greater<int>());
 }
- 
-void quick_sort(IntList & list, int left, int right)
+
+void block_quick_sort(IntList & list, int left, int right)
+{
+    if (left >= right)
+        return;
+    block_quick_sort(list.begin() + left, list.begin() + right + 1,
+                     std::greater<int>());
+}
+
+void quick_sort(IntList & list, int left, int right, SortStats & stats)
+{
+    if (left >= right)
+        return;
+    quick_sort(list.begin() + left, list.begin() + right + 1,
+               std::greater<int>(), stats);
+}
+
+void block_quick_sort(IntList & list, int left, int right,
+                      SortStats & stats)
 {
-    if (left >= right) 
+    if (left >= right)
         return;
-    int index = partition(list, left, right);
-    quick_sort(list, left, index - 1);
-    quick_sort(list, index + 1, right);
+    block_quick_sort(list.begin() + left, list.begin() + right + 1,
+                     std::greater<int>(), stats);
+}
+
+void partition(IntList & list, int left, int right, int & lt, int & gt)
+{
+    std::greater<int> comp;
+    IntList::iterator first = list.begin() + left;
+    IntList::iterator l, g;
+    sort_detail::partition(first, list.begin() + right + 1, l, g, comp);
+    lt = l - list.begin();
+    gt = g - list.begin() - 1;
+}
+
+int block_partition(IntList & list, int left, int right)
+{
+    std::greater<int> comp;
+    return sort_detail::block_partition(list.begin() + left,
+                                        list.begin() + right + 1, comp) -
+           list.begin();
 }
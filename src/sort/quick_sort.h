@@ -3,10 +3,358 @@
 #ifndef __QUICK_SORT_H__
 #define __QUICK_SORT_H__
 
+#include <stddef.h>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
 #include <vector>
 
+#include "small_sort.h"
+#include "sort_stats.h"
+
 typedef std::vector<int> IntList;
- 
+
+// ranges at most this long are finished by insertion sort
+#define INSERTION_CUTOFF    16
+// or by small_sort() when the elements are ints in plain order
+#define SMALL_SORT_CUTOFF   64
+// ranges longer than this take the ninther instead of median of three
+#define NINTHER_CUTOFF      128
+// elements scanned per side before the swap pass of block_partition()
+#define BLOCK_SIZE          128
+
+namespace sort_detail {
+
+template <typename RandomIt, typename Compare>
+void insertion_sort(RandomIt first, RandomIt last, Compare & comp)
+{
+    typedef typename std::iterator_traits<RandomIt>::value_type T;
+    if (first == last)
+        return;
+    for (RandomIt i = first + 1; i != last; ++i) {
+        T value = std::move(*i);
+        RandomIt j = i;
+        while (j != first && comp(value, *(j - 1))) {
+            *j = std::move(*(j - 1));
+            --j;
+        }
+        *j = std::move(value);
+        note_moves(comp, (i - j + 1) * sizeof(T));
+    }
+}
+
+// heap whose root is the element that belongs last, so popping it to the
+// back of the range leaves the range in sorted order
+template <typename RandomIt, typename Compare>
+void sift_down(RandomIt first, ptrdiff_t root, ptrdiff_t size,
+               Compare & comp)
+{
+    typedef typename std::iterator_traits<RandomIt>::value_type T;
+    T value = std::move(first[root]);
+    ptrdiff_t child;
+    while ((child = 2 * root + 1) < size) {
+        if (child + 1 < size && comp(first[child], first[child + 1]))
+            child++;
+        if (!comp(value, first[child]))
+            break;
+        first[root] = std::move(first[child]);
+        note_moves(comp, sizeof(T));
+        root = child;
+    }
+    first[root] = std::move(value);
+    note_moves(comp, sizeof(T));
+}
+
+template <typename RandomIt, typename Compare>
+void heap_sort(RandomIt first, RandomIt last, Compare & comp)
+{
+    ptrdiff_t size = last - first;
+    for (ptrdiff_t i = size / 2 - 1; i >= 0; i--)
+        sift_down(first, i, size, comp);
+    for (ptrdiff_t i = size - 1; i > 0; i--) {
+        swap_elements(first, first + i, comp);
+        sift_down(first, 0, i, comp);
+    }
+}
+
+template <typename RandomIt, typename Compare>
+RandomIt median_of_three(RandomIt a, RandomIt b, RandomIt c, Compare & comp)
+{
+    if (comp(*a, *b)) {
+        if (comp(*b, *c))
+            return b;
+        return comp(*a, *c) ? c : a;
+    }
+    if (comp(*a, *c))
+        return a;
+    return comp(*b, *c) ? c : b;
+}
+
+// Tukey's ninther for long ranges, median of the quartiles otherwise; the
+// end points are left out since partitioning leaves the pivot's neighbour
+// there, which on nearly sorted input is the same extreme every time
+template <typename RandomIt, typename Compare>
+RandomIt choose_pivot(RandomIt first, RandomIt last, Compare & comp)
+{
+    ptrdiff_t size = last - first;
+    RandomIt mid = first + size / 2;
+    if (size <= NINTHER_CUTOFF)
+        return median_of_three(first + size / 4, mid,
+                               last - 1 - size / 4, comp);
+    ptrdiff_t step = size / 8;
+    RandomIt a = median_of_three(first, first + step, first + 2 * step, comp);
+    RandomIt b = median_of_three(mid - step, mid, mid + step, comp);
+    RandomIt c = median_of_three(last - 1 - 2 * step, last - 1 - step,
+                                 last - 1, comp);
+    return median_of_three(a, b, c, comp);
+}
+
+// Dutch flag partition: [first, lt) before the pivot, [lt, gt) equal to it,
+// [gt, last) after it
+template <typename RandomIt, typename Compare>
+void partition(RandomIt first, RandomIt last, RandomIt & lt, RandomIt & gt,
+               Compare & comp)
+{
+    typedef typename std::iterator_traits<RandomIt>::value_type T;
+    T pivot = *choose_pivot(first, last, comp);
+    RandomIt i = first;
+    lt = first;
+    gt = last;
+    while (i != gt) {
+        if (comp(*i, pivot))
+            swap_elements(lt++, i++, comp);
+        else if (comp(pivot, *i))
+            swap_elements(i, --gt, comp);
+        else
+            ++i;
+    }
+}
+
+// BlockQuicksort: the comparisons of a block only record offsets of the
+// misplaced elements, with no branch on their result, and the swaps are done
+// afterwards in a separate pass
+template <typename RandomIt, typename Compare>
+RandomIt block_partition(RandomIt first, RandomIt last, Compare & comp)
+{
+    typedef typename std::iterator_traits<RandomIt>::value_type T;
+    int offsetL[BLOCK_SIZE];
+    int offsetR[BLOCK_SIZE];
+    swap_elements(first, choose_pivot(first, last, comp), comp);
+    T pivot = *first;
+    RandomIt l = first + 1;
+    RandomIt r = last - 1;
+    int numL = 0, numR = 0, startL = 0, startR = 0;
+    while (r - l + 1 > 2 * BLOCK_SIZE) {
+        if (numL == 0) {
+            startL = 0;
+            for (int j = 0; j < BLOCK_SIZE; j++) {
+                offsetL[numL] = j;
+                numL += !comp(l[j], pivot);
+            }
+        }
+        if (numR == 0) {
+            startR = 0;
+            for (int j = 0; j < BLOCK_SIZE; j++) {
+                offsetR[numR] = j;
+                numR += !comp(pivot, *(r - j));
+            }
+        }
+        int num = std::min(numL, numR);
+        for (int j = 0; j < num; j++)
+            swap_elements(l + offsetL[startL + j], r - offsetR[startR + j],
+                          comp);
+        numL -= num;
+        numR -= num;
+        startL += num;
+        startR += num;
+        if (numL == 0)
+            l += BLOCK_SIZE;
+        if (numR == 0)
+            r -= BLOCK_SIZE;
+    }
+    // everything before l belongs before the pivot and everything after r
+    // after it; what is left in between, at most three blocks, is finished
+    // by a Hoare scan, which like the blocks stops on keys equal to the
+    // pivot so that runs of them are split evenly
+    for (;;) {
+        while (l <= r && comp(*l, pivot))
+            ++l;
+        while (l <= r && comp(pivot, *r))
+            --r;
+        if (l >= r)
+            break;
+        swap_elements(l++, r--, comp);
+    }
+    swap_elements(first, l - 1, comp);
+    return l - 1;
+}
+
+// how short ranges are finished: insertion sort in general, the sorting
+// networks of small_sort() for contiguous ints in either plain order
+template <typename RandomIt, typename Compare>
+struct small_sorter
+{
+    enum { cutoff = INSERTION_CUTOFF, network = 0 };
+    static void sort(RandomIt first, RandomIt last, Compare & comp)
+    {
+        insertion_sort(first, last, comp);
+    }
+};
+
+template <typename RandomIt, bool Descending>
+struct int_small_sorter
+{
+    enum { cutoff = SMALL_SORT_CUTOFF, network = 1 };
+    template <typename Compare>
+    static void sort(RandomIt first, RandomIt last, Compare &)
+    {
+        if (first == last)
+            return;
+        if (Descending)
+            small_sort_descending(&*first, last - first);
+        else
+            small_sort(&*first, last - first);
+    }
+};
+
+template <>
+struct small_sorter<int*, std::less<int> >
+  : int_small_sorter<int*, false> {};
+template <>
+struct small_sorter<int*, std::greater<int> >
+  : int_small_sorter<int*, true> {};
+template <>
+struct small_sorter<IntList::iterator, std::less<int> >
+  : int_small_sorter<IntList::iterator, false> {};
+template <>
+struct small_sorter<IntList::iterator, std::greater<int> >
+  : int_small_sorter<IntList::iterator, true> {};
+
+// instrumented sorts finish the same way as plain ones; the networks do no
+// element comparisons of their own, they just move every element twice
+template <typename RandomIt, typename Compare>
+struct small_sorter<RandomIt, counting_compare<Compare> >
+{
+    typedef small_sorter<RandomIt, Compare> plain;
+    enum { cutoff = plain::cutoff, network = plain::network };
+    static void sort(RandomIt first, RandomIt last,
+                     counting_compare<Compare> & comp)
+    {
+        typedef typename std::iterator_traits<RandomIt>::value_type T;
+        if (network) {
+            plain::sort(first, last, comp.comp);
+            note_moves(comp, 2 * (last - first) * sizeof(T));
+        } else {
+            insertion_sort(first, last, comp);
+        }
+    }
+};
+
+template <typename RandomIt, typename Compare>
+void intro_sort(RandomIt first, RandomIt last, int depth, bool block,
+                Compare & comp)
+{
+    typedef small_sorter<RandomIt, Compare> base_case;
+    while (last - first > base_case::cutoff) {
+        if (depth-- == 0) {
+            note_heap_sort(comp);
+            heap_sort(first, last, comp);
+            return;
+        }
+        note_depth(comp, depth);
+        RandomIt lt, gt;
+        if (block) {
+            lt = block_partition(first, last, comp);
+            gt = lt + 1;
+        } else {
+            partition(first, last, lt, gt, comp);
+        }
+        // recurse into the smaller side, loop on the larger one so that the
+        // stack depth stays O(log n)
+        if (lt - first < last - gt) {
+            intro_sort(first, lt, depth, block, comp);
+            first = gt;
+        } else {
+            intro_sort(gt, last, depth, block, comp);
+            last = lt;
+        }
+    }
+    note_base_case(comp);
+    base_case::sort(first, last, comp);
+}
+
+inline int depth_limit(ptrdiff_t size)
+{
+    int depth = 0;
+    for (; size > 1; size >>= 1)
+        depth += 2;
+    return depth;
+}
+
+} // namespace sort_detail
+
+// sort [first, last) so that comp(a, b) holds whenever a ends up before b
+// (introsort)
+template <typename RandomIt, typename Compare>
+void quick_sort(RandomIt first, RandomIt last, Compare comp)
+{
+    sort_detail::intro_sort(first, last, sort_detail::depth_limit(last - first),
+                            false, comp);
+}
+
+template <typename RandomIt>
+void quick_sort(RandomIt first, RandomIt last)
+{
+    typedef typename std::iterator_traits<RandomIt>::value_type T;
+    quick_sort(first, last, std::less<T>());
+}
+
+// same as quick_sort() but with the branch-free block_partition()
+template <typename RandomIt, typename Compare>
+void block_quick_sort(RandomIt first, RandomIt last, Compare comp)
+{
+    sort_detail::intro_sort(first, last, sort_detail::depth_limit(last - first),
+                            true, comp);
+}
+
+template <typename RandomIt>
+void block_quick_sort(RandomIt first, RandomIt last)
+{
+    typedef typename std::iterator_traits<RandomIt>::value_type T;
+    block_quick_sort(first, last, std::less<T>());
+}
+
+// the same, counting what the sort does in stats
+template <typename RandomIt, typename Compare>
+void quick_sort(RandomIt first, RandomIt last, Compare comp,
+                SortStats & stats)
+{
+    counting_compare<Compare> counted(comp, stats);
+    stats.depth_limit = sort_detail::depth_limit(last - first);
+    sort_detail::intro_sort(first, last, stats.depth_limit, false, counted);
+}
+
+template <typename RandomIt, typename Compare>
+void block_quick_sort(RandomIt first, RandomIt last, Compare comp,
+                      SortStats & stats)
+{
+    counting_compare<Compare> counted(comp, stats);
+    stats.depth_limit = sort_detail::depth_limit(last - first);
+    sort_detail::intro_sort(first, last, stats.depth_limit, true, counted);
+}
+
+// sort list[left..right] in descending order
 void quick_sort(IntList & list, int left, int right);
+void block_quick_sort(IntList & list, int left, int right);
+void quick_sort(IntList & list, int left, int right, SortStats & stats);
+void block_quick_sort(IntList & list, int left, int right,
+                      SortStats & stats);
+
+// three-way partition of list[left..right]: [left, lt) greater than the
+// pivot, [lt, gt] equal to it, (gt, right] smaller
+void partition(IntList & list, int left, int right, int & lt, int & gt);
+// two-way partition of list[left..right], returns the final pivot index
+int block_partition(IntList & list, int left, int right);
 
 #endif // __QUICK_SORT_H__
@@ -0,0 +1,226 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#ifndef __RADIX_SORT_H__
+#define __RADIX_SORT_H__
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "quick_sort.h"
+
+#define RADIX_BITS      8
+#define RADIX_SIZE      (1 << RADIX_BITS)
+#define RADIX_MASK      (RADIX_SIZE - 1)
+// bytes per software write-combining buffer, one cache line
+#define WC_BYTES        64
+
+// radix_traits<T>::to_bits() maps a key to unsigned bits that compare in
+// the same order as the key itself
+template <typename T, typename Enable = void>
+struct radix_traits;
+
+template <typename T>
+struct radix_traits<T, typename std::enable_if<std::is_integral<T>::value &&
+                                               std::is_unsigned<T>::value>::type>
+{
+    typedef T bits_type;
+    static bits_type to_bits(T key) { return key; }
+};
+
+// flipping the sign bit orders two's complement values as unsigned ones
+template <typename T>
+struct radix_traits<T, typename std::enable_if<std::is_integral<T>::value &&
+                                               std::is_signed<T>::value>::type>
+{
+    typedef typename std::make_unsigned<T>::type bits_type;
+    static bits_type to_bits(T key)
+    {
+        return (bits_type)key ^ ((bits_type)1 << (sizeof(T) * 8 - 1));
+    }
+};
+
+// IEEE 754: positive values just need the sign bit set, negative ones are
+// ordered backwards so all of their bits are flipped
+template <typename T>
+struct radix_traits<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+    typedef typename std::conditional<sizeof(T) == 4, uint32_t,
+                                      uint64_t>::type bits_type;
+    static bits_type to_bits(T key)
+    {
+        bits_type bits;
+        memcpy(&bits, &key, sizeof(bits));
+        const bits_type sign = (bits_type)1 << (sizeof(T) * 8 - 1);
+        return (bits & sign) ? ~bits : (bits | sign);
+    }
+};
+
+struct identity_key
+{
+    template <typename T>
+    const T & operator()(const T & value) const { return value; }
+};
+
+namespace sort_detail {
+
+template <typename KeyExtract, typename T>
+struct radix_key_type
+{
+    typedef typename std::decay<decltype(std::declval<KeyExtract &>()(
+        std::declval<const T &>()))>::type type;
+};
+
+template <typename KeyExtract, typename T>
+typename radix_traits<typename radix_key_type<KeyExtract, T>::type>::bits_type
+radix_bits(KeyExtract & key, const T & value)
+{
+    typedef typename radix_key_type<KeyExtract, T>::type K;
+    return radix_traits<K>::to_bits(key(value));
+}
+
+// small trivially copyable elements are staged per bucket and stored a
+// cache line at a time: on sorted-like inputs all buckets are written in
+// lockstep and their write positions can alias to the same cache sets
+template <typename T>
+struct radix_wc
+{
+    enum { size = std::is_trivially_copyable<T>::value &&
+                  sizeof(T) <= WC_BYTES / 4 ? WC_BYTES / sizeof(T) : 0 };
+};
+
+template <typename SrcIt, typename DstIt, typename KeyExtract>
+void radix_scatter(SrcIt src, DstIt dst, size_t size, int shift,
+                   size_t* offset, KeyExtract & key, std::false_type)
+{
+    for (size_t i = 0; i < size; i++) {
+        size_t digit = (radix_bits(key, src[i]) >> shift) & RADIX_MASK;
+        dst[offset[digit]++] = std::move(src[i]);
+    }
+}
+
+template <typename SrcIt, typename DstIt, typename KeyExtract>
+void radix_scatter(SrcIt src, DstIt dst, size_t size, int shift,
+                   size_t* offset, KeyExtract & key, std::true_type)
+{
+    typedef typename std::iterator_traits<SrcIt>::value_type T;
+    const int wc = radix_wc<T>::size;
+    static thread_local T buffer[RADIX_SIZE][wc] __attribute__((aligned(64)));
+    int fill[RADIX_SIZE] = {0};
+    for (size_t i = 0; i < size; i++) {
+        const T & value = src[i];
+        size_t digit = (radix_bits(key, value) >> shift) & RADIX_MASK;
+        buffer[digit][fill[digit]++] = value;
+        if (fill[digit] == wc) {
+            std::copy(buffer[digit], buffer[digit] + wc, dst + offset[digit]);
+            offset[digit] += wc;
+            fill[digit] = 0;
+        }
+    }
+    for (int digit = 0; digit < RADIX_SIZE; digit++) {
+        std::copy(buffer[digit], buffer[digit] + fill[digit],
+                  dst + offset[digit]);
+        offset[digit] += fill[digit];
+    }
+}
+
+// one counting pass over a digit; false when every element has the same
+// digit and the pass would be a plain copy
+template <typename SrcIt, typename DstIt, typename KeyExtract>
+bool radix_pass(SrcIt src, DstIt dst, size_t size, int shift,
+                size_t* histogram, KeyExtract & key)
+{
+    typedef typename std::iterator_traits<SrcIt>::value_type T;
+    size_t first = (radix_bits(key, src[0]) >> shift) & RADIX_MASK;
+    if (histogram[first] == size)
+        return false;
+    size_t offset = 0;
+    for (int digit = 0; digit < RADIX_SIZE; digit++) {
+        size_t n = histogram[digit];
+        histogram[digit] = offset;
+        offset += n;
+    }
+    radix_scatter(src, dst, size, shift, histogram, key,
+                  std::integral_constant<bool, radix_wc<T>::size != 0>());
+    return true;
+}
+
+} // namespace sort_detail
+
+// LSD radix sort of [first, last) in ascending order of key(element), over
+// 8-bit digits of radix_traits<>::to_bits(); stable
+template <typename RandomIt, typename KeyExtract>
+void radix_sort(RandomIt first, RandomIt last, KeyExtract key)
+{
+    typedef typename std::iterator_traits<RandomIt>::value_type T;
+    typedef typename sort_detail::radix_key_type<KeyExtract, T>::type K;
+    typedef typename radix_traits<K>::bits_type U;
+    const int passes = sizeof(U) * 8 / RADIX_BITS;
+    size_t size = last - first;
+    if (size < 2)
+        return;
+
+    // one histogram per digit, all filled by a single read of the input
+    size_t count[passes][RADIX_SIZE];
+    memset(count, 0, sizeof(count));
+    for (size_t i = 0; i < size; i++) {
+        U bits = sort_detail::radix_bits(key, first[i]);
+        for (int pass = 0; pass < passes; pass++)
+            count[pass][(bits >> (pass * RADIX_BITS)) & RADIX_MASK]++;
+    }
+
+    // ping-pong between the input and a single scratch buffer
+    std::vector<T> scratch(size);
+    bool inScratch = false;
+    for (int pass = 0; pass < passes; pass++) {
+        int shift = pass * RADIX_BITS;
+        double start = sort_detail::pass_begin(key);
+        bool moved;
+        if (inScratch)
+            moved = sort_detail::radix_pass(scratch.begin(), first, size,
+                                            shift, count[pass], key);
+        else
+            moved = sort_detail::radix_pass(first, scratch.begin(), size,
+                                            shift, count[pass], key);
+        sort_detail::pass_end(key, start, moved);
+        if (moved) {
+            sort_detail::note_moves(key, size * sizeof(T));
+            inScratch = !inScratch;
+        }
+    }
+    if (inScratch) {
+        std::move(scratch.begin(), scratch.end(), first);
+        sort_detail::note_moves(key, size * sizeof(T));
+    }
+}
+
+// the same, recording the passes in stats
+template <typename RandomIt, typename KeyExtract>
+void radix_sort(RandomIt first, RandomIt last, KeyExtract key,
+                SortStats & stats)
+{
+    radix_sort(first, last, counting_key<KeyExtract>(key, stats));
+}
+
+template <typename RandomIt>
+void radix_sort(RandomIt first, RandomIt last)
+{
+    radix_sort(first, last, identity_key());
+}
+
+// flipping the sign bit orders signed ints as unsigned, flipping the other
+// bits as well turns ascending into descending
+static inline unsigned int radix_key(int value)
+{
+    return (unsigned int)value ^ 0x7fffffffU;
+}
+
+// sort list[left..right] in descending order
+void radix_sort(IntList & list, int left, int right);
+void radix_sort(IntList & list, int left, int right, SortStats & stats);
+
+#endif // __RADIX_SORT_H__
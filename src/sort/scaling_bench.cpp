@@ -0,0 +1,62 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+#include "parallel_sort.h"
+#include "bench.h"
+
+// powers of two, and the maximum itself when it is not one
+static unsigned next_threads(unsigned threads, unsigned maxThreads)
+{
+    if (threads < maxThreads && threads * 2 > maxThreads)
+        return maxThreads;
+    return threads * 2;
+}
+
+int main(int argc, char* argv[])
+{
+    int size = bench_size(argc, argv, 10000000);
+    unsigned maxThreads = argc > 2 ? atoi(argv[2]) :
+                          std::thread::hardware_concurrency();
+    if (maxThreads == 0)
+        maxThreads = 1;
+    IntList origin;
+    IntList list;
+    fill_list(origin, size, DIST_RANDOM);
+    printf("%d random ints\n", size);
+    printf("%8s %14s %8s %14s %8s\n", "threads", "quick", "speedup",
+           "radix", "speedup");
+    double quickBase = 0, radixBase = 0;
+    for (unsigned threads = 1; threads <= maxThreads;
+         threads = next_threads(threads, maxThreads)) {
+        list = origin;
+        double start = now_sec();
+        parallel_quick_sort(list, threads);
+        double quick = now_sec() - start;
+        if (!std::is_sorted(list.begin(), list.end(), std::greater<int>())) {
+            printf("ERROR: parallel_quick_sort result is not sorted\n");
+            return 1;
+        }
+
+        list = origin;
+        start = now_sec();
+        parallel_radix_sort(list, threads);
+        double radix = now_sec() - start;
+        if (!std::is_sorted(list.begin(), list.end(), std::greater<int>())) {
+            printf("ERROR: parallel_radix_sort result is not sorted\n");
+            return 1;
+        }
+
+        if (threads == 1) {
+            quickBase = quick;
+            radixBase = radix;
+        }
+        printf("%8u %12.2fms %8.2f %12.2fms %8.2f\n", threads, quick * 1e3,
+               quickBase / quick, radix * 1e3, radixBase / radix);
+    }
+    return 0;
+}
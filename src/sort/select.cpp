@@ -0,0 +1,20 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#include "select.h"
+
+void select_nth(IntList & list, int left, int right, int nth)
+{
+    if (left >= right || nth < left || nth > right)
+        return;
+    select_nth(list.begin() + left, list.begin() + nth,
+               list.begin() + right + 1, std::greater<int>());
+}
+
+void partial_quick_sort(IntList & list, int left, int right, int k)
+{
+    if (left >= right || k <= 0)
+        return;
+    k = std::min(k, right - left + 1);
+    partial_quick_sort(list.begin() + left, list.begin() + left + k,
+                       list.begin() + right + 1, std::greater<int>());
+}
@@ -0,0 +1,119 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#ifndef __SELECT_H__
+#define __SELECT_H__
+
+#include <stddef.h>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+#include "quick_sort.h"
+
+// Introselect: put the element that belongs at nth there, with nothing in
+// [first, nth) after it and nothing in (nth, last) before it. Partitions
+// only the side holding nth, with block_partition(), and falls back to
+// heapsort of what is left past the depth limit, so it stays O(n log n) in
+// the worst case.
+template <typename RandomIt, typename Compare>
+void select_nth(RandomIt first, RandomIt nth, RandomIt last, Compare comp)
+{
+    int depth = sort_detail::depth_limit(last - first);
+    while (last - first > INSERTION_CUTOFF) {
+        if (depth-- == 0) {
+            sort_detail::heap_sort(first, last, comp);
+            return;
+        }
+        RandomIt pivot = sort_detail::block_partition(first, last, comp);
+        if (nth < pivot)
+            last = pivot;
+        else if (nth > pivot)
+            first = pivot + 1;
+        else
+            return;
+    }
+    sort_detail::insertion_sort(first, last, comp);
+}
+
+template <typename RandomIt>
+void select_nth(RandomIt first, RandomIt nth, RandomIt last)
+{
+    typedef typename std::iterator_traits<RandomIt>::value_type T;
+    select_nth(first, nth, last, std::less<T>());
+}
+
+// sort only [first, middle): the middle - first elements that belong first,
+// the rest of the range is left in no particular order
+template <typename RandomIt, typename Compare>
+void partial_quick_sort(RandomIt first, RandomIt middle, RandomIt last,
+                        Compare comp)
+{
+    if (middle == first)
+        return;
+    if (middle < last)
+        select_nth(first, middle, last, comp);
+    quick_sort(first, middle, comp);
+}
+
+template <typename RandomIt>
+void partial_quick_sort(RandomIt first, RandomIt middle, RandomIt last)
+{
+    typedef typename std::iterator_traits<RandomIt>::value_type T;
+    partial_quick_sort(first, middle, last, std::less<T>());
+}
+
+// The k values that come first under comp from a stream of any length, in
+// O(k) memory: a heap whose root is the worst value kept, which each new
+// value only has to beat to get in.
+template <typename T, typename Compare = std::less<T> >
+class TopK
+{
+public:
+    explicit TopK(size_t k, Compare comp = Compare())
+      : m_k(k),
+        m_comp(comp)
+    {
+        m_heap.reserve(k);
+    }
+
+    void push(const T & value)
+    {
+        if (m_heap.size() < m_k) {
+            m_heap.push_back(value);
+            std::push_heap(m_heap.begin(), m_heap.end(), m_comp);
+        } else if (m_k && m_comp(value, m_heap.front())) {
+            std::pop_heap(m_heap.begin(), m_heap.end(), m_comp);
+            m_heap.back() = value;
+            std::push_heap(m_heap.begin(), m_heap.end(), m_comp);
+        }
+    }
+
+    template <typename InputIt>
+    void push(InputIt first, InputIt last)
+    {
+        for (; first != last; ++first)
+            push(*first);
+    }
+
+    size_t size() const { return m_heap.size(); }
+
+    // the values kept so far, best first
+    std::vector<T> sorted() const
+    {
+        std::vector<T> result(m_heap);
+        std::sort_heap(result.begin(), result.end(), m_comp);
+        return result;
+    }
+
+private:
+    size_t m_k;
+    Compare m_comp;
+    std::vector<T> m_heap;
+};
+
+// on list[left..right] in the descending order of quick_sort()
+void select_nth(IntList & list, int left, int right, int nth);
+void partial_quick_sort(IntList & list, int left, int right, int k);
+
+#endif // __SELECT_H__
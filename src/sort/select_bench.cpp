@@ -0,0 +1,68 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <functional>
+
+#include "select.h"
+#include "bench.h"
+
+int main(int argc, char* argv[])
+{
+    int size = bench_size(argc, argv, 10000000);
+    IntList origin;
+    IntList list;
+    fill_list(origin, size, DIST_RANDOM);
+
+    // the answer for every k
+    list = origin;
+    double start = now_sec();
+    quick_sort(list, 0, size - 1);
+    double full = now_sec() - start;
+    IntList sorted = list;
+    printf("%d random ints, full quick_sort %.2fms\n", size, full * 1e3);
+    printf("%8s %14s %14s %14s %14s\n", "k", "select_nth", "partial_sort",
+           "TopK stream", "std::partial");
+
+    for (int k = 10; k <= size / 10; k *= 10) {
+        list = origin;
+        start = now_sec();
+        select_nth(list, 0, size - 1, k - 1);
+        double nth = now_sec() - start;
+        if (list[k - 1] != sorted[k - 1]) {
+            printf("ERROR: select_nth got %d for k %d\n", list[k - 1], k);
+            return 1;
+        }
+
+        list = origin;
+        start = now_sec();
+        partial_quick_sort(list, 0, size - 1, k);
+        double partial = now_sec() - start;
+        if (!std::equal(list.begin(), list.begin() + k, sorted.begin())) {
+            printf("ERROR: partial_quick_sort is wrong for k %d\n", k);
+            return 1;
+        }
+
+        // one value at a time, as if read from a stream
+        start = now_sec();
+        TopK<int, std::greater<int> > top(k);
+        top.push(origin.begin(), origin.end());
+        IntList best = top.sorted();
+        double stream = now_sec() - start;
+        if (!std::equal(best.begin(), best.end(), sorted.begin())) {
+            printf("ERROR: TopK is wrong for k %d\n", k);
+            return 1;
+        }
+
+        list = origin;
+        start = now_sec();
+        std::partial_sort(list.begin(), list.begin() + k, list.end(),
+                          std::greater<int>());
+        double theirs = now_sec() - start;
+
+        printf("%8d %12.2fms %12.2fms %12.2fms %12.2fms\n", k, nth * 1e3,
+               partial * 1e3, stream * 1e3, theirs * 1e3);
+    }
+    return 0;
+}
@@ -0,0 +1,194 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#include <limits.h>
+#include <string.h>
+#include <immintrin.h>
+#include <algorithm>
+
+#include "small_sort.h"
+#include "quick_sort.h"
+
+// Every stage of a bitonic network is a compare-exchange of each lane with
+// the lane whose index differs in one bit: min and max against a permuted
+// copy, then a blend that keeps the max in the lanes marked in the mask.
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+namespace small_avx2 {
+
+struct Vec {
+    typedef __m256i type;
+    enum { W = 8 };
+
+    static type load(const int* p)
+    {
+        return _mm256_loadu_si256((const __m256i*)p);
+    }
+    static void store(int* p, type v)
+    {
+        _mm256_storeu_si256((__m256i*)p, v);
+    }
+
+    template <int Mask>
+    static type exchange(type v, type partner)
+    {
+        type mn = _mm256_min_epi32(v, partner);
+        type mx = _mm256_max_epi32(v, partner);
+        return _mm256_blend_epi32(mn, mx, Mask);
+    }
+    static type xor1(type v) { return _mm256_shuffle_epi32(v, 0xb1); }
+    static type xor2(type v) { return _mm256_shuffle_epi32(v, 0x4e); }
+    static type xor4(type v) { return _mm256_permute4x64_epi64(v, 0x4e); }
+
+    // a bitonic register into ascending order
+    static type clean(type v)
+    {
+        v = exchange<0xf0>(v, xor4(v));
+        v = exchange<0xcc>(v, xor2(v));
+        return exchange<0xaa>(v, xor1(v));
+    }
+    static type sort(type v)
+    {
+        v = exchange<0x66>(v, xor1(v));
+        v = exchange<0x3c>(v, xor2(v));
+        v = exchange<0x5a>(v, xor1(v));
+        return clean(v);
+    }
+    // a reversed against b is bitonic, its min and max halves are too
+    static void merge(type & a, type & b)
+    {
+        type r = _mm256_permutevar8x32_epi32(b,
+            _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+        type mn = _mm256_min_epi32(a, r);
+        type mx = _mm256_max_epi32(a, r);
+        a = clean(mn);
+        b = clean(mx);
+    }
+};
+
+#include "small_sort_kernel.h"
+
+} // namespace small_avx2
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+namespace small_sse4 {
+
+struct Vec {
+    typedef __m128i type;
+    enum { W = 4 };
+
+    static type load(const int* p)
+    {
+        return _mm_loadu_si128((const __m128i*)p);
+    }
+    static void store(int* p, type v)
+    {
+        _mm_storeu_si128((__m128i*)p, v);
+    }
+
+    template <int Mask>
+    static type exchange(type v, type partner)
+    {
+        type mn = _mm_min_epi32(v, partner);
+        type mx = _mm_max_epi32(v, partner);
+        return _mm_castps_si128(_mm_blend_ps(_mm_castsi128_ps(mn),
+                                             _mm_castsi128_ps(mx), Mask));
+    }
+    static type xor1(type v) { return _mm_shuffle_epi32(v, 0xb1); }
+    static type xor2(type v) { return _mm_shuffle_epi32(v, 0x4e); }
+
+    static type clean(type v)
+    {
+        v = exchange<0xc>(v, xor2(v));
+        return exchange<0xa>(v, xor1(v));
+    }
+    static type sort(type v)
+    {
+        v = exchange<0x6>(v, xor1(v));
+        return clean(v);
+    }
+    static void merge(type & a, type & b)
+    {
+        type r = _mm_shuffle_epi32(b, 0x1b);
+        type mn = _mm_min_epi32(a, r);
+        type mx = _mm_max_epi32(a, r);
+        a = clean(mn);
+        b = clean(mx);
+    }
+};
+
+#include "small_sort_kernel.h"
+
+} // namespace small_sse4
+#pragma GCC pop_options
+
+namespace small_scalar {
+
+// comparators of their own, so that quick_sort() finishes with insertion
+// sort rather than calling back into small_sort()
+static void sort(int* data, int n, unsigned int flip)
+{
+    if (flip)
+        quick_sort(data, data + n, [](int a, int b) { return a > b; });
+    else
+        quick_sort(data, data + n, [](int a, int b) { return a < b; });
+}
+
+} // namespace small_scalar
+
+typedef void (*SmallSortFunc)(int* data, int n, unsigned int flip);
+
+struct SmallSortImpl {
+    SmallSortFunc func;
+    const char* isa;
+};
+
+static SmallSortImpl resolve()
+{
+    SmallSortImpl impl;
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        impl.func = small_avx2::sort;
+        impl.isa = "avx2";
+    } else if (__builtin_cpu_supports("sse4.1")) {
+        impl.func = small_sse4::sort;
+        impl.isa = "sse4.1";
+    } else {
+        impl.func = small_scalar::sort;
+        impl.isa = "scalar";
+    }
+    return impl;
+}
+
+static const SmallSortImpl & impl()
+{
+    static SmallSortImpl impl = resolve();
+    return impl;
+}
+
+void small_sort(int* data, int n)
+{
+    if (n > SMALL_SORT_MAX) {
+        quick_sort(data, data + n);
+        return;
+    }
+    if (n > 1)
+        impl().func(data, n, 0);
+}
+
+void small_sort_descending(int* data, int n)
+{
+    if (n > SMALL_SORT_MAX) {
+        quick_sort(data, data + n, std::greater<int>());
+        return;
+    }
+    if (n > 1)
+        impl().func(data, n, ~0U);
+}
+
+const char* small_sort_isa()
+{
+    return impl().isa;
+}
@@ -0,0 +1,17 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#ifndef __SMALL_SORT_H__
+#define __SMALL_SORT_H__
+
+// longest array the sorting networks take, longer ones go to quick_sort()
+#define SMALL_SORT_MAX      256
+
+// sort data[0..n) in ascending order with bitonic sorting networks: AVX2 or
+// SSE4.1, picked at run time, and a scalar fallback
+void small_sort(int* data, int n);
+void small_sort_descending(int* data, int n);
+
+// "avx2", "sse4.1" or "scalar"
+const char* small_sort_isa();
+
+#endif // __SMALL_SORT_H__
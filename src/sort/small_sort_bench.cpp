@@ -0,0 +1,63 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <functional>
+
+#include "small_sort.h"
+#include "quick_sort.h"
+#include "bench.h"
+
+static void insertion_sort(int* data, int n)
+{
+    std::less<int> comp;
+    sort_detail::insertion_sort(data, data + n, comp);
+}
+
+static void std_sort(int* data, int n)
+{
+    std::sort(data, data + n);
+}
+
+typedef void (*SortFunc)(int* data, int n);
+
+static const char* sortName[] = {"small_sort", "insertion", "std::sort"};
+static SortFunc sortFunc[] = {small_sort, insertion_sort, std_sort};
+
+int main(int argc, char* argv[])
+{
+    // elements sorted per size, split into arrays of that size
+    int total = bench_size(argc, argv, 1 << 22);
+    int sizes[] = {4, 5, 8, 12, 16, 24, 32, 48, 64, 100, 128, 200, 256};
+    int count = sizeof(sortFunc) / sizeof(sortFunc[0]);
+    IntList origin;
+    IntList list;
+    fill_list(origin, total, DIST_RANDOM);
+    printf("small_sort uses %s\n", small_sort_isa());
+    printf("%6s", "size");
+    for (int s = 0; s < count; s++)
+        printf(" %14s", sortName[s]);
+    printf("\n");
+    for (size_t z = 0; z < sizeof(sizes) / sizeof(sizes[0]); z++) {
+        int n = sizes[z];
+        int arrays = total / n;
+        printf("%6d", n);
+        for (int s = 0; s < count; s++) {
+            list = origin;
+            double start = now_sec();
+            for (int a = 0; a < arrays; a++)
+                sortFunc[s](&list[a * n], n);
+            double sec = now_sec() - start;
+            for (int a = 0; a < arrays; a++) {
+                if (!std::is_sorted(&list[a * n], &list[a * n] + n)) {
+                    printf("\nERROR: %s is not sorted\n", sortName[s]);
+                    return 1;
+                }
+            }
+            printf(" %8.2f ns/el", sec * 1e9 / (arrays * n));
+        }
+        printf("\n");
+    }
+    return 0;
+}
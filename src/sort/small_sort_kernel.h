@@ -0,0 +1,69 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+//
+// Width independent part of small_sort(), included once per instruction set
+// by small_sort.cpp inside a namespace that defines Vec: W lanes of int with
+// load/store/min/max, sort() of one register and merge() of two sorted
+// registers into the lower and upper halves.
+
+// merge sorted a[0..la) and b[0..lb), both multiples of W long, into out
+static void merge_runs(const int* a, int la, const int* b, int lb, int* out)
+{
+    const int W = Vec::W;
+    Vec::type lo = Vec::load(a);
+    Vec::type hi = Vec::load(b);
+    int ia = W, ib = W;
+    Vec::merge(lo, hi);
+    Vec::store(out, lo);
+    out += W;
+    // hi keeps the upper half of everything seen, the next W come from the
+    // run whose head is smaller
+    while (ia < la || ib < lb) {
+        if (ib >= lb || (ia < la && a[ia] <= b[ib])) {
+            lo = Vec::load(a + ia);
+            ia += W;
+        } else {
+            lo = Vec::load(b + ib);
+            ib += W;
+        }
+        Vec::merge(lo, hi);
+        Vec::store(out, lo);
+        out += W;
+    }
+    Vec::store(out, hi);
+}
+
+// flip is 0 for ascending and ~0 for descending: ~x orders ints backwards
+static void sort(int* data, int n, unsigned int flip)
+{
+    const int W = Vec::W;
+    int buf[2][SMALL_SORT_MAX + 2 * W] __attribute__((aligned(32)));
+    int size = (n + 2 * W - 1) / (2 * W) * (2 * W);
+    int* src = buf[0];
+    int* dst = buf[1];
+    for (int i = 0; i < n; i++)
+        src[i] = data[i] ^ flip;
+    for (int i = n; i < size; i++)
+        src[i] = INT_MAX;
+
+    for (int i = 0; i < size; i += 2 * W) {
+        Vec::type lo = Vec::sort(Vec::load(src + i));
+        Vec::type hi = Vec::sort(Vec::load(src + i + W));
+        Vec::merge(lo, hi);
+        Vec::store(src + i, lo);
+        Vec::store(src + i + W, hi);
+    }
+    for (int run = 2 * W; run < size; run *= 2) {
+        for (int i = 0; i < size; i += 2 * run) {
+            if (i + run >= size) {
+                memcpy(dst + i, src + i, (size - i) * sizeof(int));
+                break;
+            }
+            merge_runs(src + i, run, src + i + run,
+                       std::min(run, size - i - run), dst + i);
+        }
+        std::swap(src, dst);
+    }
+
+    for (int i = 0; i < n; i++)
+        data[i] = src[i] ^ flip;
+}
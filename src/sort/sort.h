@@ -0,0 +1,56 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#ifndef __SORT_H__
+#define __SORT_H__
+
+#include <iterator>
+#include <type_traits>
+
+#include "quick_sort.h"
+#include "radix_sort.h"
+
+// orders elements by the key extracted from them
+template <typename KeyExtract>
+struct key_less
+{
+    explicit key_less(KeyExtract key) : key(key) {}
+
+    template <typename T>
+    bool operator()(const T & a, const T & b) const { return key(a) < key(b); }
+
+    KeyExtract key;
+};
+
+namespace sort_detail {
+
+template <typename RandomIt, typename KeyExtract>
+void key_sort(RandomIt first, RandomIt last, KeyExtract key, std::true_type)
+{
+    radix_sort(first, last, key);
+}
+
+template <typename RandomIt, typename KeyExtract>
+void key_sort(RandomIt first, RandomIt last, KeyExtract key, std::false_type)
+{
+    quick_sort(first, last, key_less<KeyExtract>(key));
+}
+
+} // namespace sort_detail
+
+// sort [first, last) in ascending order of key(element): radix_sort() when
+// the key is integral, quick_sort() on the key otherwise
+template <typename RandomIt, typename KeyExtract>
+void key_sort(RandomIt first, RandomIt last, KeyExtract key)
+{
+    typedef typename std::iterator_traits<RandomIt>::value_type T;
+    typedef typename sort_detail::radix_key_type<KeyExtract, T>::type K;
+    sort_detail::key_sort(first, last, key, std::is_integral<K>());
+}
+
+template <typename RandomIt>
+void key_sort(RandomIt first, RandomIt last)
+{
+    key_sort(first, last, identity_key());
+}
+
+#endif // __SORT_H__
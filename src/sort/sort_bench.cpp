@@ -0,0 +1,105 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <functional>
+
+#include <stdint.h>
+
+#include "sort.h"
+#include "bench.h"
+
+typedef void (*SortFunc)(IntList & list, int left, int right);
+
+static void std_sort(IntList & list, int left, int right)
+{
+    std::sort(list.begin() + left, list.begin() + right + 1,
+              std::greater<int>());
+}
+
+static const char* sortName[] = {"quick_sort", "radix_sort", "std::sort"};
+static SortFunc sortFunc[] = {quick_sort, radix_sort, std_sort};
+
+struct Record {
+    double weight;
+    int id;
+};
+
+struct record_id {
+    int operator()(const Record & r) const { return r.id; }
+};
+
+struct record_weight {
+    double operator()(const Record & r) const { return r.weight; }
+};
+
+// key_sort() against std::sort on the same key
+template <typename T, typename KeyExtract>
+static void bench_key_sort(const char* name, std::vector<T> origin,
+                           KeyExtract key)
+{
+    std::vector<T> list = origin;
+    double start = now_sec();
+    key_sort(list.begin(), list.end(), key);
+    double ours = now_sec() - start;
+    for (size_t i = 1; i < list.size(); i++) {
+        if (key(list[i]) < key(list[i - 1])) {
+            printf("ERROR: %s is not sorted\n", name);
+            exit(1);
+        }
+    }
+    list = origin;
+    start = now_sec();
+    std::sort(list.begin(), list.end(), key_less<KeyExtract>(key));
+    double theirs = now_sec() - start;
+    printf("%-16s %10.2fms %10.2fms\n", name, ours * 1e3, theirs * 1e3);
+}
+
+static void bench_keys(int size)
+{
+    std::vector<int64_t> keys(size);
+    std::vector<double> values(size);
+    std::vector<Record> records(size);
+    for (int i = 0; i < size; i++) {
+        keys[i] = (int64_t)bench_rand() << 32 | bench_rand();
+        values[i] = (int)bench_rand() / 1e3;
+        records[i].weight = values[i];
+        records[i].id = (int)bench_rand();
+    }
+    printf("\n%-16s %12s %12s\n", "key", "key_sort", "std::sort");
+    bench_key_sort("int64_t", keys, identity_key());
+    bench_key_sort("double", values, identity_key());
+    bench_key_sort("Record::id", records, record_id());
+    bench_key_sort("Record::weight", records, record_weight());
+}
+
+int main(int argc, char* argv[])
+{
+    int size = bench_size(argc, argv, 1000000);
+    int count = sizeof(sortFunc) / sizeof(sortFunc[0]);
+    IntList origin;
+    IntList list;
+    printf("%-12s", "input");
+    for (int s = 0; s < count; s++)
+        printf(" %12s", sortName[s]);
+    printf("\n");
+    for (int d = 0; d < DIST_COUNT; d++) {
+        fill_list(origin, size, (Distribution)d);
+        printf("%-12s", dist_name[d]);
+        for (int s = 0; s < count; s++) {
+            list = origin;
+            double start = now_sec();
+            sortFunc[s](list, 0, list.size() - 1);
+            printf(" %10.2fms", (now_sec() - start) * 1e3);
+            if (!std::is_sorted(list.begin(), list.end(),
+                                std::greater<int>())) {
+                printf("\nERROR: %s is not sorted\n", sortName[s]);
+                return 1;
+            }
+        }
+        printf("\n");
+    }
+    bench_keys(size);
+    return 0;
+}
@@ -0,0 +1,190 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#ifndef __SORT_STATS_H__
+#define __SORT_STATS_H__
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#define SORT_STATS_MAX_PASSES   16
+
+// What one instrumented sort did. The sorts are instrumented by passing one
+// of these, which wraps the comparator (or radix key extractor) in a
+// counting_compare (counting_key); the hooks in sort_detail are empty
+// inline functions for every other comparator, so the plain sorts compile
+// to the same code as before.
+struct SortStats {
+    unsigned long long comparisons;
+    unsigned long long swaps;
+    // element writes times element size
+    unsigned long long bytes_moved;
+    // partition levels allowed before heapsort, and the most any range used
+    int depth_limit;
+    int max_depth;
+    int heap_sorts;
+    // ranges finished by insertion sort or small_sort()
+    int base_cases;
+    // radix passes done and skipped, with the time of each one done
+    int passes;
+    int skipped_passes;
+    double pass_time[SORT_STATS_MAX_PASSES];
+
+    SortStats() { reset(); }
+
+    void reset() { memset(this, 0, sizeof(*this)); }
+
+    void print(FILE* fp) const
+    {
+        fprintf(fp, "  comparisons %llu, swaps %llu, moved %.1f MB\n",
+                comparisons, swaps, bytes_moved / 1e6);
+        if (depth_limit)
+            fprintf(fp, "  depth %d of %d, heapsort fallbacks %d, "
+                    "base cases %d\n", max_depth, depth_limit, heap_sorts,
+                    base_cases);
+        if (passes || skipped_passes) {
+            fprintf(fp, "  radix passes %d, skipped %d:", passes,
+                    skipped_passes);
+            for (int i = 0; i < passes && i < SORT_STATS_MAX_PASSES; i++)
+                fprintf(fp, " %.2fms", pass_time[i] * 1e3);
+            fprintf(fp, "\n");
+        }
+    }
+};
+
+template <typename Compare>
+struct counting_compare {
+    counting_compare(Compare comp, SortStats & stats)
+      : comp(comp),
+        stats(&stats)
+    {
+    }
+
+    template <typename T>
+    bool operator()(const T & a, const T & b)
+    {
+        stats->comparisons++;
+        return comp(a, b);
+    }
+
+    Compare comp;
+    SortStats* stats;
+};
+
+template <typename KeyExtract>
+struct counting_key {
+    counting_key(KeyExtract key, SortStats & stats)
+      : key(key),
+        stats(&stats)
+    {
+    }
+
+    template <typename T>
+    auto operator()(const T & value) -> decltype(std::declval<KeyExtract &>()(value))
+    {
+        return key(value);
+    }
+
+    KeyExtract key;
+    SortStats* stats;
+};
+
+namespace sort_detail {
+
+template <typename RandomIt, typename Compare>
+inline void swap_elements(RandomIt a, RandomIt b, Compare &)
+{
+    std::iter_swap(a, b);
+}
+
+template <typename RandomIt, typename Compare>
+inline void swap_elements(RandomIt a, RandomIt b,
+                          counting_compare<Compare> & comp)
+{
+    std::iter_swap(a, b);
+    comp.stats->swaps++;
+    comp.stats->bytes_moved +=
+        2 * sizeof(typename std::iterator_traits<RandomIt>::value_type);
+}
+
+// count element writes other than swaps
+template <typename Policy>
+inline void note_moves(Policy &, size_t) {}
+
+template <typename Compare>
+inline void note_moves(counting_compare<Compare> & comp, size_t bytes)
+{
+    comp.stats->bytes_moved += bytes;
+}
+
+template <typename KeyExtract>
+inline void note_moves(counting_key<KeyExtract> & key, size_t bytes)
+{
+    key.stats->bytes_moved += bytes;
+}
+
+// depth is what is left of the partition level budget
+template <typename Compare>
+inline void note_depth(Compare &, int) {}
+
+template <typename Compare>
+inline void note_depth(counting_compare<Compare> & comp, int depth)
+{
+    SortStats* stats = comp.stats;
+    stats->max_depth = std::max(stats->max_depth, stats->depth_limit - depth);
+}
+
+template <typename Compare>
+inline void note_heap_sort(Compare &) {}
+
+template <typename Compare>
+inline void note_heap_sort(counting_compare<Compare> & comp)
+{
+    comp.stats->heap_sorts++;
+}
+
+template <typename Compare>
+inline void note_base_case(Compare &) {}
+
+template <typename Compare>
+inline void note_base_case(counting_compare<Compare> & comp)
+{
+    comp.stats->base_cases++;
+}
+
+inline double stats_clock()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+template <typename KeyExtract>
+inline double pass_begin(KeyExtract &) { return 0; }
+
+template <typename KeyExtract>
+inline double pass_begin(counting_key<KeyExtract> &) { return stats_clock(); }
+
+template <typename KeyExtract>
+inline void pass_end(KeyExtract &, double, bool) {}
+
+template <typename KeyExtract>
+inline void pass_end(counting_key<KeyExtract> & key, double start, bool done)
+{
+    SortStats* stats = key.stats;
+    if (!done) {
+        stats->skipped_passes++;
+        return;
+    }
+    if (stats->passes < SORT_STATS_MAX_PASSES)
+        stats->pass_time[stats->passes] = stats_clock() - start;
+    stats->passes++;
+}
+
+} // namespace sort_detail
+
+#endif // __SORT_STATS_H__
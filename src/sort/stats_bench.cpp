@@ -0,0 +1,50 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <functional>
+
+#include "quick_sort.h"
+#include "radix_sort.h"
+#include "bench.h"
+
+typedef void (*StatsSortFunc)(IntList & list, int left, int right,
+                              SortStats & stats);
+
+static const char* sortName[] = {"quick_sort", "block_quick_sort",
+                                 "radix_sort"};
+static StatsSortFunc sortFunc[] = {quick_sort, block_quick_sort, radix_sort};
+
+int main(int argc, char* argv[])
+{
+    int size = bench_size(argc, argv, 1000000);
+    int count = sizeof(sortFunc) / sizeof(sortFunc[0]);
+    IntList origin;
+    IntList list;
+    for (int d = 0; d < DIST_COUNT; d++) {
+        fill_list(origin, size, (Distribution)d);
+        printf("%s, %d ints\n", dist_name[d], size);
+        for (int s = 0; s < count; s++) {
+            SortStats stats;
+            list = origin;
+            double start = now_sec();
+            sortFunc[s](list, 0, list.size() - 1, stats);
+            printf(" %s %.2fms\n", sortName[s], (now_sec() - start) * 1e3);
+            stats.print(stdout);
+            if (!std::is_sorted(list.begin(), list.end(),
+                                std::greater<int>())) {
+                printf("ERROR: %s is not sorted\n", sortName[s]);
+                return 1;
+            }
+            // presorted input must not drive the pivots into heapsort
+            if ((d == DIST_SORTED || d == DIST_REVERSE) &&
+                stats.heap_sorts != 0) {
+                printf("ERROR: %s fell back to heapsort %d times\n",
+                       sortName[s], stats.heap_sorts);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
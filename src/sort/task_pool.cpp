@@ -0,0 +1,103 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#include "task_pool.h"
+
+// index of the calling thread in the pool it works for
+static thread_local unsigned worker_index = 0;
+
+TaskPool::TaskPool(unsigned threads)
+  : m_pending(0),
+    m_queued(0),
+    m_stop(false)
+{
+    if (threads == 0)
+        threads = 1;
+    for (unsigned i = 0; i < threads; i++)
+        m_queues.push_back(new Queue);
+    for (unsigned i = 1; i < threads; i++)
+        m_threads.push_back(std::thread(&TaskPool::m_worker, this, i));
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    for (size_t i = 0; i < m_threads.size(); i++)
+        m_threads[i].join();
+    for (size_t i = 0; i < m_queues.size(); i++)
+        delete m_queues[i];
+}
+
+void TaskPool::submit(const Task & task)
+{
+    unsigned self = worker_index < m_queues.size() ? worker_index : 0;
+    Queue* queue = m_queues[self];
+    m_pending++;
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->tasks.push_back(task);
+    }
+    // under m_mutex, so a worker between its check and its sleep cannot
+    // miss the wakeup
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queued++;
+    m_cond.notify_one();
+}
+
+bool TaskPool::m_run_one(unsigned self)
+{
+    Task task;
+    // newest own task first, it is the one whose data is still in cache
+    {
+        Queue* queue = m_queues[self];
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (!queue->tasks.empty()) {
+            task = queue->tasks.back();
+            queue->tasks.pop_back();
+        }
+    }
+    // otherwise steal the oldest, and so usually biggest, task of another
+    for (size_t i = 1; !task && i < m_queues.size(); i++) {
+        Queue* queue = m_queues[(self + i) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (!queue->tasks.empty()) {
+            task = queue->tasks.front();
+            queue->tasks.pop_front();
+        }
+    }
+    if (!task)
+        return false;
+    m_queued--;
+    task();
+    if (--m_pending == 0) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cond.notify_all();
+    }
+    return true;
+}
+
+void TaskPool::m_worker(unsigned self)
+{
+    worker_index = self;
+    while (!m_stop) {
+        if (m_run_one(self))
+            continue;
+        // sleep until there is a task to take, not merely one running
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cond.wait(lock, [this] { return m_stop || m_queued > 0; });
+    }
+}
+
+void TaskPool::wait()
+{
+    worker_index = 0;
+    while (m_pending > 0) {
+        if (m_run_one(0))
+            continue;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cond.wait(lock, [this] { return m_pending == 0 || m_queued > 0; });
+    }
+}
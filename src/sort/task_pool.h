@@ -0,0 +1,51 @@
+// Copyright (C) 2013 ~ 2014 Leslie Zhai <xiangzhai83@gmail.com>
+
+#ifndef __TASK_POOL_H__
+#define __TASK_POOL_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef std::function<void()> Task;
+
+// Work-stealing pool: every thread owns a deque, pushes and pops at its back
+// and, once it runs dry, steals from the front of the others. The thread
+// that calls wait() takes part as worker 0, so a pool of N threads starts
+// N - 1 of its own.
+class TaskPool
+{
+public:
+    explicit TaskPool(unsigned threads);
+    ~TaskPool();
+
+    unsigned size() const { return m_queues.size(); }
+    // may be called from inside a running task
+    void submit(const Task & task);
+    // run tasks until every submitted one, and the ones they submit, is done
+    void wait();
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool m_run_one(unsigned self);
+    void m_worker(unsigned self);
+
+    std::vector<Queue*> m_queues;
+    std::vector<std::thread> m_threads;
+    // tasks submitted and not finished, and of those the ones still queued
+    std::atomic<int> m_pending;
+    std::atomic<int> m_queued;
+    std::atomic<bool> m_stop;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+};
+
+#endif // __TASK_POOL_H__